@@ -0,0 +1,132 @@
+#include <iostream>
+#include <vector>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+/** @brief Bratu problem -u'' = lambda exp(u) on (0,1), u(0)=u(1)=0
+
+    Finite differences with n interior points, the Jacobian is
+    tridiagonal but stored as a dense matrix.
+*/
+template<class N>
+class Bratu
+{
+public:
+  typedef std::size_t size_type;
+  typedef N number_type;
+
+  Bratu (size_type n_, N lambda_=1.0)
+    : n(n_), lambda(lambda_), h2inv(N((n_+1)*(n_+1)))
+  {}
+
+  std::size_t size () const
+  {
+    return n;
+  }
+
+  void F (const Vector<N>& u, Vector<N>& result) const
+  {
+    for (size_type i=0; i<n; i++)
+      {
+        N left = (i>0) ? u[i-1] : N(0.0);
+        N right = (i<n-1) ? u[i+1] : N(0.0);
+        result[i] = h2inv*(N(2.0)*u[i]-left-right) - lambda*exp(u[i]);
+      }
+  }
+
+  void F_x (const Vector<N>& u, DenseMatrix<N>& result) const
+  {
+    result = N(0.0);
+    for (size_type i=0; i<n; i++)
+      {
+        result[i][i] = N(2.0)*h2inv - lambda*exp(u[i]);
+        if (i>0) result[i][i-1] = -h2inv;
+        if (i<n-1) result[i][i+1] = -h2inv;
+      }
+  }
+
+private:
+  size_type n;
+  N lambda, h2inv;
+};
+
+// fill A with reproducible pseudo random numbers, diagonally dominant if requested
+void random_matrix (DenseMatrix<double>& A, bool dominant)
+{
+  unsigned long state = 12345;
+  for (std::size_t i=0; i<A.rowsize(); i++)
+    for (std::size_t j=0; j<A.colsize(); j++)
+      {
+        state = (1103515245*state+12345)%2147483648ul;
+        A[i][j] = double(state)/2147483648.0-0.5;
+      }
+  if (dominant)
+    for (std::size_t i=0; i<A.rowsize(); i++) A[i][i] += A.colsize();
+}
+
+int main (int argc, char** argv)
+{
+  // vector lengths, matrix dimensions and unknowns of the Newton problem are
+  // chosen separately with --vector=..., --matrix=..., --dense=... and --newton=...
+  Benchmark bench(argc,argv,{"vector","matrix","dense","newton"});
+
+  // BLAS level 1
+  std::vector<std::size_t> sizes = bench.sweep("vector",{1000,10000,100000,1000000});
+  for (std::size_t k=0; k<sizes.size(); k++)
+    {
+      std::size_t n = sizes[k];
+      Vector<double> x(n,1.0), y(n,2.0);
+      bench.run("Vector::update",n,[&] () { x.update(1e-8,y); });
+      bench.run("dot",n,[&] () { double d = x*y; do_not_optimize(d); });
+      bench.run("norm",n,[&] () { double d = norm(x); do_not_optimize(d); });
+      bench.run("two_norm",n,[&] () { double d = x.two_norm(); do_not_optimize(d); });
+    }
+
+  // BLAS level 2
+  sizes = bench.sweep("matrix",{100,300,1000});
+  for (std::size_t k=0; k<sizes.size(); k++)
+    {
+      std::size_t n = sizes[k];
+      DenseMatrix<double> A(n,n);
+      random_matrix(A,false);
+      Vector<double> x(n,1.0), y(n);
+      bench.run("mv",n,[&] () { A.mv(y,x); do_not_optimize(y[0]); });
+    }
+
+  // matrix product, LR decompositions and QR by Gram-Schmidt
+  sizes = bench.sweep("dense",{50,100,200,400});
+  for (std::size_t k=0; k<sizes.size(); k++)
+    {
+      std::size_t n = sizes[k];
+      DenseMatrix<double> A0(n,n), A(n,n), D0(n,n);
+      random_matrix(A0,false);
+      random_matrix(D0,true);
+      Vector<std::size_t> p(n), q(n);
+      Vector<double> x(n), b(n,1.0), b0(n,1.0);
+      bench.run("mm",n,[&] () { A.mm(A0,D0); do_not_optimize(A[0][0]); });
+      bench.run("lr",n,[&] () { A = D0; },[&] () { lr(A,p); });
+      bench.run("lr_partialpivot",n,[&] () { A = A0; },[&] () { lr_partialpivot(A,p); });
+      bench.run("lr_fullpivot",n,[&] () { A = A0; },[&] () { lr_fullpivot(A,p,q); });
+      bench.run("linsolve",n,[&] () { A = A0; b = b0; },[&] () { linsolve(A,x,b); });
+      bench.run("linsolve_mixed",n,[&] () { linsolve_mixed(A0,x,b0); do_not_optimize(x[0]); });
+      bench.run("gram_schmidt",n,[&] () { DenseMatrix<double> Q(gram_schmidt(A0)); do_not_optimize(Q[0][0]); });
+      bench.run("modified_gram_schmidt",n,
+                [&] () { DenseMatrix<double> Q(modified_gram_schmidt(A0)); do_not_optimize(Q[0][0]); });
+    }
+
+  // Newton with dense Jacobian
+  sizes = bench.sweep("newton",{50,100,200,400});
+  for (std::size_t k=0; k<sizes.size(); k++)
+    {
+      std::size_t n = sizes[k];
+      Bratu<double> model(n);
+      Newton newton;
+      newton.set_reduction(1e-12);
+      Vector<double> u(n);
+      bench.run("Newton::solve Bratu",n,[&] () { u = 0.0; },[&] () { newton.solve(model,u); });
+    }
+
+  bench.report();
+  return 0;
+}
@@ -0,0 +1,170 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+#include "../num1/modelproblem.hh"
+#include "../num1/vanderpol.hh"
+#include "../num1/lorenz.hh"
+#include "../num1/laplace.hh"
+
+/*
+  For the fixed step integrators the problem size is the number of
+  steps on [0,T], for the adaptive ones the number of digits requested,
+  i.e. TOL=10^-size. For the Laplace problem it is the number of grid
+  points per direction. The construction of the integrator is timed
+  together with the time stepping.
+
+  Each quantity has its own options: --steps=n1,n2,... (default
+  100,1000), --digits=d1,d2,... (default 4,8) and --grid=n1,n2,...
+  (default 11,16,21,31), each with a matching --max-steps, --max-digits
+  and --max-grid. At most 10 digits are accepted, beyond that the
+  error estimates are dominated by rounding errors and RE stops making
+  progress in double precision. The Laplace problem is solved with a
+  dense LR decomposition of order grid^2, so grids beyond about 40
+  take minutes.
+*/
+
+// advance the integrator to time T
+template<class S>
+void advance (S& solver, double T)
+{
+  while (solver.get_time()<T-1e-10) solver.step();
+  do_not_optimize(solver.get_state()[0]);
+}
+
+// integrator S constructed from args with n steps of equal size on [0,T]
+template<class S, class... Args>
+void fixed (Benchmark& bench, const std::string& name, std::size_t n, double T, const Args&... args)
+{
+  bench.run(name,n,[&] () {
+      S solver(args...);
+      solver.set_dt(T/n);
+      advance(solver,T);
+    });
+}
+
+// adaptive integrator S constructed from args with TOL=10^-digits on [0,T]
+template<class S, class... Args>
+void adaptive (Benchmark& bench, const std::string& name, std::size_t digits, double T, const Args&... args)
+{
+  bench.run(name,digits,[&] () {
+      S solver(args...);
+      solver.set_dt(T/100);
+      solver.set_TOL(std::pow(10.0,-double(digits)));
+      advance(solver,T);
+    });
+}
+
+// all integrators of ode.hh on model M
+template<class M>
+void integrators (Benchmark& bench, const std::string& name, const M& model, double T,
+                  const std::vector<std::size_t>& digits)
+{
+  std::vector<std::size_t> steps = bench.sweep("steps",{100,1000});
+  for (std::size_t k=0; k<steps.size(); k++)
+    {
+      std::size_t n = steps[k];
+      fixed<EE<M> >(bench,"EE "+name,n,T,model);
+      fixed<ModifiedEuler<M> >(bench,"ModifiedEuler "+name,n,T,model);
+      fixed<Heun2<M> >(bench,"Heun2 "+name,n,T,model);
+      fixed<Heun3<M> >(bench,"Heun3 "+name,n,T,model);
+      fixed<Kutta3<M> >(bench,"Kutta3 "+name,n,T,model);
+      fixed<RungeKutta4<M> >(bench,"RungeKutta4 "+name,n,T,model);
+      Newton newton;
+      newton.set_reduction(1e-10);
+      fixed<IE<M,Newton> >(bench,"IE "+name,n,T,model,newton);
+      const char* methods[] = {"Implicit Euler","Alexander","Crouzieux","Midpoint Rule","Fractional Step Theta"};
+      for (int m=0; m<5; m++)
+        fixed<DIRK<M,Newton> >(bench,"DIRK "+std::string(methods[m])+" "+name,n,T,model,newton,std::string(methods[m]));
+    }
+
+  for (std::size_t k=0; k<digits.size(); k++)
+    {
+      std::size_t d = digits[k];
+      adaptive<RKF45<M> >(bench,"RKF45 "+name,d,T,model);
+      bench.run("RE RungeKutta4 "+name,d,[&] () {
+          RungeKutta4<M> rk(model);
+          RE<M,RungeKutta4<M> > solver(model,rk);
+          solver.set_dt(T/100);
+          solver.set_TOL(std::pow(10.0,-double(d)));
+          advance(solver,T);
+        });
+    }
+}
+
+//! the unit square
+template<class N>
+class SquareDomain
+{
+public:
+  typedef N number_type;
+
+  bool evaluate (Vector<number_type>& ) const
+  {
+    return true;
+  }
+};
+
+//! Dirichlet values g(x) = x_0 x_1 everywhere on the boundary
+template<class N>
+class BilinearBoundary
+{
+public:
+  typedef N number_type;
+
+  bool isDirichlet (const Vector<number_type>& ) const
+  {
+    return true;
+  }
+
+  number_type getDirichletValue (const number_type , const Vector<number_type>& x) const
+  {
+    return x[0]*x[1];
+  }
+
+  Vector<number_type> getNeumannValue (const number_type , const Vector<number_type>& x) const
+  {
+    return Vector<number_type>(x.size(),0.0);
+  }
+};
+
+int main (int argc, char** argv)
+{
+  Benchmark bench(argc,argv,{"steps","digits","grid"});
+  std::vector<std::size_t> digits = bench.sweep("digits",{4,8});
+  for (std::size_t k=0; k<digits.size(); k++)
+    if (digits[k]<1 || digits[k]>10)
+      HDNUM_ERROR("solvers: --digits needs values from 1 to 10, got " << digits[k]);
+
+  integrators(bench,"modelproblem",ModelProblem<double>(-1.0),1.0,digits);
+  integrators(bench,"vanderpol",VanDerPolProblem<double>(0.1),1.0,digits);
+  // Lorenz has no f_x, the implicit integrators use finite differences
+  Lorenz<double> lorenz;
+  integrators(bench,"lorenz",FiniteDifferenceModel<Lorenz<double> >(lorenz),1.0,digits);
+
+  // Laplace problem on the unit square with the stationary solver
+  typedef SquareDomain<double> DF;
+  typedef BilinearBoundary<double> BF;
+  typedef LaplaceCentralDifferences<double,double,DF,BF,2> Model;
+  DF df;
+  BF bf;
+  std::vector<std::size_t> sizes = bench.sweep("grid",{11,16,21,31});
+  for (std::size_t k=0; k<sizes.size(); k++)
+    {
+      Vector<double> extent(2,1.0);
+      Vector<std::size_t> size(2,sizes[k]);
+      Model model(extent,size,df,bf);
+      bench.run("StationarySolver laplace",sizes[k],[&] () {
+          StationarySolver<Model> solver(model);
+          solver.solve();
+          do_not_optimize(solver.get_state()[0]);
+        });
+    }
+
+  bench.report();
+  return 0;
+}
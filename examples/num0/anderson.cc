@@ -0,0 +1,124 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+// wall clock time since start
+double seconds (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+//! square root of a as in wurzelbanach.cc
+class WurzelProblem
+{
+public:
+  typedef std::size_t size_type;
+  typedef double number_type;
+
+  WurzelProblem (double a_)
+    : a(a_)
+  {}
+
+  std::size_t size () const
+  {
+    return 1;
+  }
+
+  void F (const Vector<double>& x, Vector<double>& result) const
+  {
+    result[0] = x[0]*x[0] - a;
+  }
+
+private:
+  double a;
+};
+
+/** @brief Chandrasekhar H-equation in fixed point form
+
+    F_i(h) = h_i - 1/(1 - c/(2n) sum_j mu_i h_j/(mu_i+mu_j)),
+    mu_i = (i+1/2)/n. The fixed point iteration with sigma=1
+    converges slowly for c close to 1.
+*/
+class HEquation
+{
+public:
+  typedef std::size_t size_type;
+  typedef double number_type;
+
+  HEquation (size_type n_, double c_)
+    : n(n_), c(c_), mu(n_)
+  {
+    for (size_type i=0; i<n; i++) mu[i] = (i+0.5)/n;
+  }
+
+  std::size_t size () const
+  {
+    return n;
+  }
+
+  void F (const Vector<double>& h, Vector<double>& result) const
+  {
+    for (size_type i=0; i<n; i++)
+      {
+        double sum(0.0);
+        for (size_type j=0; j<n; j++) sum += mu[i]*h[j]/(mu[i]+mu[j]);
+        result[i] = h[i] - 1.0/(1.0-c/(2.0*n)*sum);
+      }
+  }
+
+private:
+  size_type n;
+  double c;
+  std::vector<double> mu;
+};
+
+// solve with window size m, report iterations, time and final residual
+template<class M>
+void run (const M& model, const Vector<double>& x0, double sigma, std::size_t m, std::size_t maxit)
+{
+  Banach banach;
+  banach.set_maxit(maxit);
+  banach.set_sigma(sigma);
+  banach.set_reduction(1e-12);
+  banach.set_abslimit(1e-100);
+  banach.set_anderson(m);
+  Vector<double> x(x0);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  banach.solve(model,x);
+  double time = seconds(start);
+  Vector<double> F(model.size());
+  model.F(x,F);
+  std::cout << std::setw(8) << m << std::setw(8) << banach.iterations()
+            << std::setw(12) << (banach.has_converged() ? "yes" : "no")
+            << std::scientific << std::setprecision(2) << std::setw(12) << norm(F)
+            << std::setw(12) << time << std::endl;
+}
+
+int main ()
+{
+  std::size_t windows[] = {0, 1, 3, 5, 10};
+
+  std::cout << "square root of 2, sigma=0.1" << std::endl;
+  std::cout << std::setw(8) << "m" << std::setw(8) << "iter" << std::setw(12) << "converged"
+            << std::setw(12) << "residual" << std::setw(12) << "time [s]" << std::endl;
+  WurzelProblem wurzel(2.0);
+  for (int k=0; k<5; k++) run(wurzel,Vector<double>(1,2.0),0.1,windows[k],10000);
+
+  std::size_t n = 1000;
+  double cs[] = {0.9, 0.999};
+  for (int l=0; l<2; l++)
+    {
+      std::cout << std::endl << "H-equation, n=" << n << ", c=" << std::fixed << std::setprecision(4)
+                << cs[l] << ", sigma=1" << std::endl;
+      std::cout << std::setw(8) << "m" << std::setw(8) << "iter" << std::setw(12) << "converged"
+                << std::setw(12) << "residual" << std::setw(12) << "time [s]" << std::endl;
+      HEquation model(n,cs[l]);
+      for (int k=0; k<5; k++) run(model,Vector<double>(n,1.0),1.0,windows[k],10000);
+    }
+
+  return 0;
+}
@@ -0,0 +1,175 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+// wall clock time since start
+double seconds (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+/** @brief Chandrasekhar H-equation, discretized with the midpoint rule
+
+    F_i(h) = h_i - 1/(1 - c/(2n) sum_j mu_i h_j/(mu_i+mu_j)),
+    mu_i = (i+1/2)/n. The evaluations of F are counted.
+*/
+class HEquation
+{
+public:
+  typedef std::size_t size_type;
+  typedef double number_type;
+
+  HEquation (size_type n_, double c_, size_type& evaluations_)
+    : n(n_), c(c_), mu(n_), evaluations(evaluations_)
+  {
+    for (size_type i=0; i<n; i++) mu[i] = (i+0.5)/n;
+  }
+
+  std::size_t size () const
+  {
+    return n;
+  }
+
+  void F (const Vector<double>& h, Vector<double>& result) const
+  {
+    for (size_type i=0; i<n; i++)
+      {
+        double sum(0.0);
+        for (size_type j=0; j<n; j++) sum += mu[i]*h[j]/(mu[i]+mu[j]);
+        result[i] = h[i] - 1.0/(1.0-c/(2.0*n)*sum);
+      }
+    evaluations++;
+  }
+
+  void F_x (const Vector<double>& h, DenseMatrix<double>& result) const
+  {
+    for (size_type i=0; i<n; i++)
+      {
+        double sum(0.0);
+        for (size_type j=0; j<n; j++) sum += mu[i]*h[j]/(mu[i]+mu[j]);
+        double d = 1.0-c/(2.0*n)*sum;
+        for (size_type j=0; j<n; j++)
+          result[i][j] = ((i==j) ? 1.0 : 0.0) - c/(2.0*n)*mu[i]/(mu[i]+mu[j])/(d*d);
+      }
+  }
+
+private:
+  size_type n;
+  double c;
+  std::vector<double> mu;
+  size_type& evaluations;
+};
+
+// solve R times from x0, report iterations, F evaluations, time and final residual
+template<class S, class M>
+void run (const std::string& name, const S& solver, const M& model,
+          const Vector<double>& x0, std::size_t R, std::size_t& evaluations)
+{
+  Vector<double> x(x0);
+  evaluations = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (std::size_t r=0; r<R; r++)
+    {
+      x = x0;
+      solver.solve(model,x);
+    }
+  double time = seconds(start)/R;
+  std::size_t evals = evaluations/R;
+  Vector<double> F(model.size());
+  model.F(x,F);
+  std::cout << std::setw(24) << name << std::setw(8) << solver.iterations()
+            << std::setw(10) << evals
+            << std::setw(12) << (solver.has_converged() ? "yes" : "no")
+            << std::scientific << std::setprecision(2) << std::setw(12) << norm(F)
+            << std::setw(12) << time << std::endl;
+}
+
+// compare Newton and the Broyden variants on one problem
+template<class M>
+void compare (const M& model, const Vector<double>& x0, std::size_t R, std::size_t& evaluations)
+{
+  std::cout << std::setw(24) << "solver" << std::setw(8) << "iter" << std::setw(10) << "F evals"
+            << std::setw(12) << "converged" << std::setw(12) << "residual"
+            << std::setw(12) << "time [s]" << std::endl;
+  Newton newton;
+  newton.set_maxit(50);
+  newton.set_reduction(1e-10);
+  newton.set_abslimit(1e-100);
+  run("Newton",newton,model,x0,R,evaluations);
+  std::string methods[] = {"good", "bad"};
+  for (int k=0; k<2; k++)
+    {
+      Broyden broyden(methods[k]);
+      broyden.set_maxit(50);
+      broyden.set_reduction(1e-10);
+      broyden.set_abslimit(1e-100);
+      run("Broyden "+methods[k],broyden,model,x0,R,evaluations);
+      broyden.set_memory(5);
+      run("Broyden "+methods[k]+", m=5",broyden,model,x0,R,evaluations);
+    }
+}
+
+// short memory, the updates are dropped several times during a solve
+template<class M>
+void restarts (const M& model, const Vector<double>& x0, std::size_t R, std::size_t& evaluations)
+{
+  std::cout << std::setw(24) << "solver" << std::setw(8) << "iter" << std::setw(10) << "F evals"
+            << std::setw(12) << "converged" << std::setw(12) << "residual"
+            << std::setw(12) << "time [s]" << std::endl;
+  std::string methods[] = {"good", "bad"};
+  for (int k=0; k<2; k++)
+    for (std::size_t m=1; m<=3; m++)
+      {
+        Broyden broyden(methods[k]);
+        broyden.set_maxit(50);
+        broyden.set_reduction(1e-10);
+        broyden.set_abslimit(1e-100);
+        broyden.set_memory(m);
+        run("Broyden "+methods[k]+", m="+std::to_string(m),broyden,model,x0,R,evaluations);
+      }
+}
+
+int main ()
+{
+  // exponential fit of the first weeks of the corona cases in Germany,
+  // normal equations of the least squares problem as in corona.cc
+  double cases[] = {16, 18, 21, 26, 53, 66, 117, 150, 188, 240,
+                    400, 639, 795, 902, 1139, 1296, 1567, 2369,
+                    3062, 3795, 4838, 6012, 7156, 8198, 10999, 13957};
+  Vector<double> N(26), t(26);
+  for (std::size_t i=0; i<N.size(); i++) N[i] = cases[i];
+  fill(t,0.0,1.0);
+  std::size_t evaluations = 0;
+  auto F = [&] (const Vector<double>& p)
+    {
+      Vector<double> r(2,0.0);
+      for (std::size_t i=0; i<N.size(); ++i) {
+        double e = exp(p[1]*t[i]);
+        r[0] += (p[0]*e-N[i])*e;
+        r[1] += (p[0]*e-N[i])*t[i]*e;
+      }
+      evaluations++;
+      return r;
+    };
+  Vector<double> p0(2);
+  p0[0] = 16.0; p0[1] = 0.27;
+  std::cout << "nonlinear fit, n=2" << std::endl;
+  compare(getNonlinearProblem(F,p0),p0,1000,evaluations);
+
+  // a larger dense system with exact Jacobian
+  std::size_t n = 500;
+  HEquation model(n,0.9,evaluations);
+  std::cout << std::endl << "H-equation, n=" << n << ", c=0.9" << std::endl;
+  compare(model,Vector<double>(n,1.0),3,evaluations);
+
+  // close to the critical value c=1 more iterations are needed
+  HEquation critical(200,0.99,evaluations);
+  std::cout << std::endl << "H-equation, n=200, c=0.99" << std::endl;
+  restarts(critical,Vector<double>(200,1.0),3,evaluations);
+
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+// wall clock time since start
+double seconds (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+// relative residual |Ax-b|/|b|
+double residual (const DenseMatrix<double>& A, const Vector<double>& x, const Vector<double>& b)
+{
+  Vector<double> r(b.size());
+  A.mv(r,x);
+  r -= b;
+  return norm(r)/norm(b);
+}
+
+// solve with LR decomposition and full pivoting as in StationarySolver
+void lr_solve (DenseMatrix<double>& A, Vector<double>& x, Vector<double> b)
+{
+  linsolve(A,x,b);
+}
+
+template<class Solver>
+void run (const std::string& name, const DenseMatrix<double>& A, const Vector<double>& b, Solver solver)
+{
+  DenseMatrix<double> B(A);
+  Vector<double> x(b.size());
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  solver(B,x,b);
+  double time = seconds(start);
+  std::cout << std::setw(24) << name << std::scientific << std::setprecision(2)
+            << std::setw(12) << time << std::setw(12) << residual(A,x,b) << std::endl;
+}
+
+int main (int argc, char** argv)
+{
+  std::size_t n = 1000;
+  if (argc>1) n = atoi(argv[1]);
+
+  // dense symmetric positive definite matrix
+  {
+    DenseMatrix<double> A(n,n);
+    spd(A);
+    Vector<double> b(n,1.0);
+    std::cout << "spd matrix, n=" << n << std::endl;
+    std::cout << std::setw(24) << "solver" << std::setw(12) << "time [s]" << std::setw(12) << "residual" << std::endl;
+    run("LR full pivoting",A,b,lr_solve);
+    run("Cholesky, unblocked",A,b,[] (DenseMatrix<double>& B, Vector<double>& x, const Vector<double>& b)
+        { cholesky(B,1); cholesky_solve(B,x,b); });
+    run("Cholesky, blocked",A,b,linsolve_cholesky<double>);
+    run("LDL^T",A,b,linsolve_ldlt<double>);
+  }
+
+  // tridiagonal matrix of the one dimensional Laplacian
+  {
+    std::size_t m = 3*n/2;
+    DenseMatrix<double> A(m,m);
+    for (std::size_t i=0; i<m; i++)
+      {
+        A[i][i] = 2.0;
+        if (i>0) A[i][i-1] = -1.0;
+        if (i+1<m) A[i][i+1] = -1.0;
+      }
+    Vector<double> b(m,1.0/((m+1)*(m+1)));
+    std::cout << std::endl << "tridiagonal matrix, n=" << m << std::endl;
+    std::cout << std::setw(24) << "solver" << std::setw(12) << "time [s]" << std::setw(12) << "residual" << std::endl;
+    run("LR full pivoting",A,b,lr_solve);
+    run("Cholesky, blocked",A,b,linsolve_cholesky<double>);
+    run("Cholesky, skyline",A,b,linsolve_skyline<double>);
+  }
+
+  return 0;
+}
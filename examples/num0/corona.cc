@@ -31,13 +31,9 @@ Vec linear_fit (const Vec& N, const Vec& t)
   Vec logN(N.size());
   for (int i=0; i<N.size(); ++i) logN[i] = log(N[i]);
 
-  // berechne Ausgleichsgerade
-  Mat AT(A.transpose()); // transponieren 
-  Mat ATA(2,2); ATA.mm(AT,A); // A^T*A
-  Vec b(2);
-  AT.mv(b,logN); // b = A^T * logN
+  // berechne Ausgleichsgerade mit Householder QR statt Normalengleichungen
   Vec p(2);
-  linsolve(ATA,p,b);
+  solve_least_squares(A,p,logN);
   return p;
 }
 
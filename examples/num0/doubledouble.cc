@@ -0,0 +1,116 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+/*
+  Throughput of double-double arithmetic compared to double and, when
+  built with GMP support (make doubledouble_gmp), to mpf_class with
+  128 bits, followed by the accuracy of LR solves of Vandermonde
+  systems in double and double-double.
+*/
+
+// best time of three runs in seconds
+template<class F>
+double best_time (F f)
+{
+  double best = 1e100;
+  for (int r=0; r<3; r++)
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      f();
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+      best = std::min(best,elapsed.count());
+    }
+  return best;
+}
+
+// million floating point operations per second of dot, mv and lr_partialpivot in N
+template<class N>
+void throughput (const std::string& name, std::size_t n)
+{
+  DenseMatrix<double> A0(n,n);
+  spd(A0);
+  DenseMatrix<N> A(n,n);
+  Vector<N> x(n), y(n);
+  for (std::size_t i=0; i<n; i++)
+    {
+      x[i] = N(1.0)/N(double(i+1));
+      for (std::size_t j=0; j<n; j++) A[i][j] = N(A0[i][j]);
+    }
+
+  N s(0.0);
+  double tdot = best_time([&] () {
+      for (int k=0; k<100; k++) s += x*x;
+    });
+  double tmv = best_time([&] () {
+      for (int k=0; k<10; k++) A.mv(y,x);
+    });
+  double tlr = best_time([&] () {
+      DenseMatrix<N> LR(A);
+      Vector<std::size_t> p(n);
+      lr_partialpivot(LR,p);
+    });
+
+  double nn = double(n);
+  std::cout << std::setw(12) << name << std::setw(6) << n
+            << std::fixed << std::setprecision(1)
+            << std::setw(10) << 200.0*nn/tdot*1e-6
+            << std::setw(10) << 20.0*nn*nn/tmv*1e-6
+            << std::setw(10) << 2.0/3.0*nn*nn*nn/tlr*1e-6
+            << std::endl;
+}
+
+// maximum error of an LR solve of a Vandermonde system with solution of ones
+template<class N>
+double vandermonde_error (std::size_t n)
+{
+  Vector<N> nodes(n), one(n,N(1.0)), b(n), x(n);
+  fill(nodes,N(1.0),N(1.0)/N(double(n)));
+  DenseMatrix<N> A(n,n);
+  vandermonde(A,nodes);
+  A.mv(b,one);
+  linsolve(A,x,b);
+  N e(0.0);
+  for (std::size_t i=0; i<n; i++)
+    if (abs(x[i]-N(1.0))>e) e = abs(x[i]-N(1.0));
+  return double(e);
+}
+
+int main ()
+{
+#if HDNUM_HAS_GMP
+  mpf_set_default_prec(128);
+#endif
+  std::cout << std::numeric_limits<DoubleDouble>::digits10 << " digits, epsilon="
+            << std::scientific << std::setprecision(3) << std::numeric_limits<DoubleDouble>::epsilon()
+            << std::endl;
+  std::cout << "sqrt(2)=" << std::setprecision(31) << sqrt(DoubleDouble(2.0)) << std::endl;
+  std::cout << "exp(1) =" << exp(DoubleDouble(1.0)) << std::endl;
+  std::cout << "log(10)=" << log(DoubleDouble(10.0)) << std::endl;
+  std::cout << "2^(1/3)=" << pow(DoubleDouble(2.0),DoubleDouble(1.0)/3.0) << std::endl << std::endl;
+
+  std::cout << "Mflop/s" << std::endl;
+  std::cout << std::setw(12) << "type" << std::setw(6) << "n"
+            << std::setw(10) << "dot" << std::setw(10) << "mv" << std::setw(10) << "lr" << std::endl;
+  std::size_t sizes[] = {100, 400};
+  for (int k=0; k<2; k++)
+    {
+      throughput<double>("double",sizes[k]);
+      throughput<DoubleDouble>("DoubleDouble",sizes[k]);
+#if HDNUM_HAS_GMP
+      throughput<mpf_class>("mpf_class",sizes[k]);
+#endif
+    }
+
+  std::cout << std::endl << "Vandermonde solve, maximum error" << std::endl;
+  std::cout << std::setw(6) << "n" << std::setw(12) << "double" << std::setw(14) << "DoubleDouble" << std::endl;
+  for (std::size_t n=4; n<=20; n+=4)
+    std::cout << std::setw(6) << n << std::scientific << std::setprecision(2)
+              << std::setw(12) << vandermonde_error<double>(n)
+              << std::setw(14) << vandermonde_error<DoubleDouble>(n) << std::endl;
+
+  return 0;
+}
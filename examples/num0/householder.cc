@@ -0,0 +1,97 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+// wall clock time since start
+double seconds (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+// tall skinny test matrix
+DenseMatrix<double> testmatrix (std::size_t m, std::size_t n)
+{
+  DenseMatrix<double> A(m,n);
+  for (std::size_t i=0; i<m; i++)
+    for (std::size_t j=0; j<n; j++)
+      A[i][j] = std::sin(1.3*i+0.7*j*j) + ((i==j) ? 1.0 : 0.0);
+  return A;
+}
+
+int main (int argc, char** argv)
+{
+  std::size_t m = 20000;
+  if (argc>1) m = atoi(argv[1]);
+
+  // throughput of the factorizations
+  std::cout << "QR decomposition of " << m << " x n matrices, GFLOP/s with 2mn^2 flops" << std::endl;
+  std::cout << std::setw(8) << "n" << std::setw(16) << "Gram-Schmidt" << std::setw(16) << "modified GS"
+            << std::setw(16) << "Householder" << std::setw(16) << "blocked WY" << std::endl;
+  std::size_t sizes[] = {16, 64, 128};
+  for (int k=0; k<3; k++)
+    {
+      std::size_t n = sizes[k];
+      DenseMatrix<double> A(testmatrix(m,n));
+      double flops = 2.0*m*n*n;
+      std::cout << std::setw(8) << n << std::fixed << std::setprecision(3);
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      DenseMatrix<double> Q1(gram_schmidt(A));
+      std::cout << std::setw(16) << flops/seconds(start)*1e-9;
+
+      start = std::chrono::steady_clock::now();
+      DenseMatrix<double> Q2(modified_gram_schmidt(A));
+      std::cout << std::setw(16) << flops/seconds(start)*1e-9;
+
+      std::size_t nbs[] = {1, 32};
+      for (int l=0; l<2; l++)
+        {
+          DenseMatrix<double> QR(A);
+          Vector<double> tau(n);
+          start = std::chrono::steady_clock::now();
+          qr_householder(QR,tau,nbs[l]);
+          std::cout << std::setw(16) << flops/seconds(start)*1e-9;
+        }
+      std::cout << std::endl;
+    }
+
+  // accuracy of polynomial least squares fits
+  std::cout << std::endl << "polynomial fit of degree n-1 on 1000 points in [0,1]" << std::endl;
+  std::cout << std::setw(8) << "n" << std::setw(20) << "normal equations" << std::setw(20) << "Householder QR" << std::endl;
+  for (std::size_t n=4; n<=16; n+=4)
+    {
+      std::size_t points = 1000;
+      DenseMatrix<double> A(points,n);
+      Vector<double> c(n,1.0), b(points);
+      for (std::size_t i=0; i<points; i++)
+        {
+          double t = double(i)/(points-1);
+          double tj = 1.0;
+          for (std::size_t j=0; j<n; j++, tj*=t) A[i][j] = tj;
+        }
+      A.mv(b,c);
+
+      // normal equations
+      DenseMatrix<double> AT(A.transpose());
+      DenseMatrix<double> ATA(n,n);
+      ATA.mm(AT,A);
+      Vector<double> ATb(n), x1(n);
+      AT.mv(ATb,b);
+      linsolve(ATA,x1,ATb);
+
+      // QR
+      Vector<double> x2(n);
+      solve_least_squares(A,x2,b);
+
+      x1 -= c;
+      x2 -= c;
+      std::cout << std::setw(8) << n << std::scientific << std::setprecision(2)
+                << std::setw(20) << norm(x1) << std::setw(20) << norm(x2) << std::endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+// wall clock time since start
+double seconds (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+// the previous implementation of readMatrixFromFile for comparison
+template<typename REAL>
+void readMatrixFromFile_iostream (const std::string& filename, DenseMatrix<REAL> &A)
+{
+  std::string buffer;
+  std::ifstream fin( filename.c_str() );
+  while( std::getline( fin, buffer ) ){
+    std::istringstream iss(buffer);
+    hdnum::Vector<REAL> rowvector;
+    while( iss ){
+      std::string sub;
+      iss >> sub;
+      if( sub.length()>0 )
+        rowvector.push_back(atof(sub.c_str()));
+    }
+    if( rowvector.size()>0 )
+      A.addNewRow( rowvector );
+  }
+}
+
+template<typename REAL>
+bool equal (const DenseMatrix<REAL>& A, const DenseMatrix<REAL>& B)
+{
+  if (A.rowsize()!=B.rowsize() || A.colsize()!=B.colsize()) return false;
+  for (std::size_t i=0; i<A.rowsize(); i++)
+    for (std::size_t j=0; j<A.colsize(); j++)
+      if (A(i,j)!=B(i,j)) return false;
+  return true;
+}
+
+void print_line (const std::string& method, double time, double reference)
+{
+  std::cout << std::setw(28) << method
+            << std::fixed << std::setprecision(3) << std::setw(10) << time
+            << std::setprecision(1) << std::setw(10) << reference/time
+            << std::endl;
+}
+
+int main (int argc, char** argv)
+{
+  std::size_t n = 2000;
+  if (argc>1) n = atoi(argv[1]);
+
+  DenseMatrix<double> A(n,n);
+  for (std::size_t i=0; i<n; i++)
+    for (std::size_t j=0; j<n; j++)
+      A(i,j) = std::sin(1.0+i+0.5*j)/(1.0+i+j);
+  A.width(24);
+  A.precision(16);
+  gnuplot("matrix.dat",A);
+  writeMatrixToBinaryFile("matrix.bin",A);
+
+  std::cout << "n=" << n << std::endl;
+  std::cout << std::setw(28) << "method" << std::setw(10) << "time [s]"
+            << std::setw(10) << "speedup" << std::endl;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  DenseMatrix<double> B;
+  readMatrixFromFile_iostream("matrix.dat",B);
+  double reference = seconds(start);
+  print_line("getline/istringstream/atof",reference,reference);
+
+  start = std::chrono::steady_clock::now();
+  DenseMatrix<double> C;
+  readMatrixFromFile("matrix.dat",C);
+  print_line("readMatrixFromFile",seconds(start),reference);
+
+  start = std::chrono::steady_clock::now();
+  DenseMatrix<double> D;
+  readMatrixFromBinaryFile("matrix.bin",D);
+  print_line("readMatrixFromBinaryFile",seconds(start),reference);
+
+  std::cout << "results identical: "
+            << (equal(A,B) && equal(A,C) && equal(A,D) ? "yes" : "NO") << std::endl;
+
+  std::remove("matrix.dat");
+  std::remove("matrix.bin");
+
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include "hdnum.hh"
+
+typedef hdnum::oc::OpCounter<double> number;
+
+// wall clock time since start
+double seconds (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+// LR decomposition and solve of a spd matrix, counted in two regions
+void work (std::size_t n)
+{
+  hdnum::DenseMatrix<number> A(n,n);
+  hdnum::spd(A);
+  hdnum::Vector<number> x(n), b(n,number(1.0));
+  hdnum::Vector<std::size_t> p(n);
+  {
+    number::ScopedRegion region("lr");
+    hdnum::lr(A,p);
+  }
+  {
+    number::ScopedRegion region("solve");
+    hdnum::permute_forward(p,b);
+    hdnum::solveL(A,b,b);
+    hdnum::solveR(A,x,b);
+  }
+}
+
+int main (int argc, char** argv)
+{
+  std::size_t n = 200;
+  if (argc>1) n = atoi(argv[1]);
+
+  // reference count in the main thread
+  number::reset();
+  work(n);
+  std::size_t single = number::totalOperationCount();
+  number::reset();
+  std::cout << "operations of one LR solve, n=" << n << ": " << single << std::endl << std::endl;
+
+  std::cout << std::setw(8) << "threads" << std::setw(16) << "operations" << std::setw(12) << "expected"
+            << std::setw(12) << "time [s]" << std::endl;
+  for (std::size_t threads=1; threads<=8; threads*=2)
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      std::vector<std::thread> pool;
+      for (std::size_t t=0; t<threads; t++) pool.push_back(std::thread(work,n));
+      for (std::size_t t=0; t<threads; t++) pool[t].join();
+      double time = seconds(start);
+      std::size_t total = number::totalOperationCount();
+      std::cout << std::setw(8) << threads << std::setw(16) << total << std::setw(12)
+                << ((total==threads*single) ? "yes" : "no")
+                << std::scientific << std::setprecision(2) << std::setw(12) << time << std::endl;
+      if (threads<8) number::reset();
+    }
+
+  // per region output for the last run
+  std::cout << std::endl;
+  number::reportRegions(std::cout);
+  return 0;
+}
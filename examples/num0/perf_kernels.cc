@@ -0,0 +1,55 @@
+// build with -DHDNUM_PROFILING=1 -DHDNUM_PROFILE_PERF=1
+#include <iostream>
+#include <vector>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+int main (int argc, char** argv)
+{
+  std::size_t n = 400;
+  if (argc>1) n = atoi(argv[1]);
+
+  DenseMatrix<double> A(n,n), B(n,n), C(n,n);
+  spd(A);
+  spd(B);
+
+  // counters of one kernel, with floating point events on Intel processors
+  PerfCounters counters;
+  counters.addRawEvent("FP scalar double",0x01c7);
+  counters.addRawEvent("FP 256 bit double",0x10c7);
+  counters.start();
+  C.mm(A,B);
+  std::vector<PerfCounters::count_type> values = counters.stop();
+  std::cout << "matrix product, n=" << n << std::endl;
+  counters.report(std::cout,values);
+  if (!counters.error().empty())
+    std::cout << "not counted: " << counters.error() << std::endl;
+
+  // the same counters per profiler region
+  for (int r=0; r<3; r++)
+    {
+      {
+        HDNUM_PROFILE_REGION("mm");
+        C.mm(A,B);
+      }
+      {
+        HDNUM_PROFILE_REGION("lr_fullpivot");
+        DenseMatrix<double> LR(A);
+        Vector<double> s(n);
+        Vector<std::size_t> p(n), q(n);
+        row_equilibrate(LR,s);
+        lr_fullpivot(LR,p,q);
+      }
+      {
+        HDNUM_PROFILE_REGION("cholesky");
+        DenseMatrix<double> L(A);
+        cholesky(L);
+      }
+    }
+  std::cout << std::endl << "per region" << std::endl;
+  Profiler::reportPerf(std::cout);
+  std::cout << std::endl;
+  Profiler::reportTree(std::cout);
+  return 0;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+/*
+  Mixed precision iterative refinement compared to linsolve in double
+  and to partial pivoting in double, which is what is done in float.
+  The exact solution is the vector of ones. Build with GMP support
+  (make refinement_gmp) to add a column with residuals in mpf_class.
+*/
+
+// maximum error against the solution of ones
+double error (const Vector<double>& x)
+{
+  double e(0.0);
+  for (std::size_t i=0; i<x.size(); i++) e = std::max(e,std::abs(x[i]-1.0));
+  return e;
+}
+
+// best time of three runs in seconds
+template<class F>
+double best_time (F f)
+{
+  double best = 1e100;
+  for (int r=0; r<3; r++)
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      f();
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+      best = std::min(best,elapsed.count());
+    }
+  return best;
+}
+
+void compare (const std::string& name, const DenseMatrix<double>& A)
+{
+  std::size_t n = A.rowsize();
+  Vector<double> one(n,1.0), b(n), x(n);
+  A.mv(b,one);
+
+  // double precision solve with full pivoting
+  double tdouble = best_time([&] () {
+      DenseMatrix<double> LR(A);
+      Vector<double> c(b);
+      linsolve(LR,x,c);
+    });
+  double edouble = error(x);
+
+  // double precision LR with partial pivoting, the same algorithm as in float
+  double tpartial = best_time([&] () {
+      DenseMatrix<double> LR(A);
+      Vector<double> s(n), c(b);
+      Vector<std::size_t> p(n);
+      row_equilibrate(LR,s);
+      lr_partialpivot(LR,p);
+      apply_equilibrate(s,c);
+      permute_forward(p,c);
+      solveL(LR,c,c);
+      solveR(LR,x,c);
+    });
+
+  // float factorization, double residuals
+  IterativeRefinement<float,double> mixed;
+  double tmixed = best_time([&] () {
+      mixed.factorize(A);
+      mixed.solve(x,b);
+    });
+  double emixed = error(x);
+
+  std::cout << std::setw(12) << name << std::setw(6) << n
+            << std::scientific << std::setprecision(2)
+            << std::setw(11) << tdouble << std::setw(11) << edouble << std::setw(11) << tpartial
+            << std::setw(11) << tmixed << std::setw(11) << emixed
+            << std::setw(6) << mixed.iterations()
+            << std::setw(10) << (mixed.used_fallback() ? "double" : "float");
+
+#if HDNUM_HAS_GMP
+  // float factorization, residuals with 256 bits
+  IterativeRefinement<float,double,mpf_class> extended;
+  extended.factorize(A);
+  extended.solve(x,b);
+  std::cout << std::setw(11) << error(x) << std::setw(6) << extended.iterations();
+#endif
+  std::cout << std::endl;
+}
+
+int main ()
+{
+#if HDNUM_HAS_GMP
+  mpf_set_default_prec(256);
+#endif
+  std::cout << std::setw(12) << "matrix" << std::setw(6) << "n"
+            << std::setw(11) << "t double" << std::setw(11) << "err double" << std::setw(11) << "t partial"
+            << std::setw(11) << "t mixed" << std::setw(11) << "err mixed"
+            << std::setw(6) << "its" << std::setw(10) << "factors";
+#if HDNUM_HAS_GMP
+  std::cout << std::setw(11) << "err mpf" << std::setw(6) << "its";
+#endif
+  std::cout << std::endl;
+
+  // well conditioned: refinement converges in a few steps
+  std::size_t sizes[] = {100, 200, 400, 800};
+  for (int k=0; k<4; k++)
+    {
+      DenseMatrix<double> A(sizes[k],sizes[k]);
+      spd(A);
+      compare("spd",A);
+    }
+
+  // ill conditioned: slower convergence, then fallback to double
+  std::size_t vsizes[] = {4, 6, 8, 10, 12};
+  for (int k=0; k<5; k++)
+    {
+      std::size_t n = vsizes[k];
+      Vector<double> nodes(n);
+      fill(nodes,1.0,1.0/n);
+      DenseMatrix<double> A(n,n);
+      vandermonde(A,nodes);
+      compare("vandermonde",A);
+    }
+
+  return 0;
+}
@@ -0,0 +1,81 @@
+// build with -DHDNUM_PROFILING=1
+#include <iostream>
+#include <vector>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+typedef oc::OpCounter<double> CountedDouble;
+
+// the kernels, instantiated for double (timed) and CountedDouble (counted)
+template<class T>
+void kernels (std::size_t n, std::size_t nm, int repetitions)
+{
+  Vector<T> x(n,T(1.0)), y(n,T(2.0));
+  DenseMatrix<T> A(nm,nm), B(nm,nm), C(nm,nm);
+  spd(A);
+  spd(B);
+  Vector<T> u(nm,T(1.0)), v(nm);
+  Vector<std::size_t> p(nm);
+  for (int r=0; r<repetitions; r++)
+    {
+      {
+        HDNUM_PROFILE_REGION("update");
+        CountedDouble::ScopedRegion region("update");
+        x.update(T(1e-8),y);
+      }
+      {
+        HDNUM_PROFILE_REGION("dot");
+        CountedDouble::ScopedRegion region("dot");
+        T d = x*y;
+        do_not_optimize(d);
+      }
+      {
+        HDNUM_PROFILE_REGION("mv");
+        CountedDouble::ScopedRegion region("mv");
+        A.mv(v,u);
+      }
+      {
+        HDNUM_PROFILE_REGION("mm");
+        CountedDouble::ScopedRegion region("mm");
+        C.mm(A,B);
+      }
+      DenseMatrix<T> LR(A);
+      {
+        HDNUM_PROFILE_REGION("lr_partialpivot");
+        CountedDouble::ScopedRegion region("lr_partialpivot");
+        lr_partialpivot(LR,p);
+      }
+    }
+}
+
+int main (int argc, char** argv)
+{
+  std::size_t n = 1<<22;   // vector length, larger than the caches
+  std::size_t nm = 500;    // matrix size
+  if (argc>1) nm = atoi(argv[1]);
+  const int repetitions = 5;
+
+  // operations per call
+  CountedDouble::reset();
+  kernels<CountedDouble>(n,nm,1);
+  const char* names[] = {"update","dot","mv","mm","lr_partialpivot"};
+  std::vector<double> flops(5);
+  for (int k=0; k<5; k++) flops[k] = CountedDouble::regionCounters(names[k]).flopCount();
+
+  // time per call, the counting run above is not profiled
+  Profiler::reset();
+  kernels<double>(n,nm,repetitions);
+
+  Roofline roofline;
+  roofline.measure_peak();
+  roofline.add_region("update",flops[0],traffic_update<double>(n));
+  roofline.add_region("dot",flops[1],traffic_dot<double>(n));
+  roofline.add_region("mv",flops[2],traffic_mv<double>(nm,nm));
+  roofline.add_region("mm",flops[3],traffic_mm<double>(nm,nm,nm));
+  roofline.add_region("lr_partialpivot",flops[4],traffic_lr<double>(nm));
+  std::cout << "vectors of length " << n << ", matrices of size " << nm << std::endl;
+  roofline.report(std::cout);
+
+  return 0;
+}
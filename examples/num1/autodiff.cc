@@ -0,0 +1,148 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+#include "hodgkinhuxley.hh"
+
+// wall clock time since start
+double seconds (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+/** @brief Chandrasekhar H-equation, discretized with the midpoint rule
+
+    F_i(h) = h_i - 1/(1 - c/(2n) sum_j mu_i h_j/(mu_i+mu_j)),
+    mu_i = (i+1/2)/n. The Jacobian gets nearly singular for c -> 1.
+
+    \tparam N a type representing x and F components
+*/
+template<class N>
+class HEquation
+{
+public:
+  typedef std::size_t size_type;
+  typedef N number_type;
+
+  HEquation (size_type n_, double c_)
+    : n(n_), c(c_), mu(n_)
+  {
+    for (size_type i=0; i<n; i++) mu[i] = (i+0.5)/n;
+  }
+
+  std::size_t size () const
+  {
+    return n;
+  }
+
+  void F (const Vector<N>& h, Vector<N>& result) const
+  {
+    for (size_type i=0; i<n; i++)
+      {
+        N sum(0.0);
+        for (size_type j=0; j<n; j++) sum += mu[i]*h[j]/(mu[i]+mu[j]);
+        result[i] = h[i] - 1.0/(1.0-c/(2.0*n)*sum);
+      }
+  }
+
+private:
+  size_type n;
+  double c;
+  std::vector<double> mu;
+};
+
+// solve with Newton R times, report iterations, time and final residual
+template<class M>
+void run (const std::string& name, const M& model, std::size_t R)
+{
+  Newton newton;
+  newton.set_maxit(50);
+  newton.set_reduction(1e-14);
+  Vector<double> x(model.size());
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (std::size_t r=0; r<R; r++)
+    {
+      x = 1.0;
+      newton.solve(model,x);
+    }
+  double time = seconds(start)/R;
+  Vector<double> F(model.size());
+  model.F(x,F);
+  std::cout << std::setw(24) << name << std::setw(8) << newton.iterations()
+            << std::setw(12) << (newton.has_converged() ? "yes" : "no")
+            << std::scientific << std::setprecision(2) << std::setw(12) << norm(F)
+            << std::setw(12) << time << std::endl;
+}
+
+int main ()
+{
+  const std::size_t n = 64;
+  const std::size_t R = 20;
+  typedef ad::Dual<double,8> D;
+
+  std::cout << std::setw(24) << "Jacobian" << std::setw(8) << "iter" << std::setw(12) << "converged"
+            << std::setw(12) << "residual" << std::setw(12) << "time [s]" << std::endl;
+  double cs[] = {0.9, 1.0};
+  for (int k=0; k<2; k++)
+    {
+      std::cout << "H-equation, n=" << n << ", c=" << std::fixed << std::setprecision(4) << cs[k] << std::endl;
+      HEquation<double> model(n,cs[k]);
+      HEquation<D> dmodel(n,cs[k]);
+      auto fd = getNonlinearProblem([&model] (const Vector<double>& h) {
+          Vector<double> r(h.size());
+          model.F(h,r);
+          return r;
+        },Vector<double>(n));
+      auto exact = getAutoDiffProblem(model,dmodel);
+      run("finite differences",fd,R);
+      run("dual numbers",exact,R);
+
+      // accuracy of the finite difference Jacobian at the initial guess
+      Vector<double> x(n,1.0);
+      DenseMatrix<double> A(n,n), B(n,n);
+      fd.F_x(x,A);
+      exact.F_x(x,B);
+      double d(0.0), b(0.0);
+      for (std::size_t i=0; i<n; i++)
+        for (std::size_t j=0; j<n; j++)
+          {
+            d = std::max(d,std::abs(A[i][j]-B[i][j]));
+            b = std::max(b,std::abs(B[i][j]));
+          }
+      std::cout << "relative error of finite difference Jacobian: " << d/b << std::endl;
+    }
+
+  // implicit Euler for the Hodgkin Huxley model, which has no f_x
+  std::cout << std::endl << "Hodgkin Huxley, implicit Euler, dt=0.05, T=100" << std::endl;
+  HodgkinHuxley<double> hh;
+  HodgkinHuxley<double,ad::Dual<double,4> > dhh;
+  FiniteDifferenceModel<HodgkinHuxley<double> > fdmodel(hh);
+  auto admodel = getAutoDiffModel(hh,dhh);
+  Newton newton;
+  newton.set_reduction(1e-10);
+
+  IE<FiniteDifferenceModel<HodgkinHuxley<double> >,Newton> solver1(fdmodel,newton);
+  solver1.set_dt(0.05);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  while (solver1.get_time()<100.0-1e-8) solver1.step();
+  double time1 = seconds(start);
+
+  IE<AutoDiffModel<HodgkinHuxley<double>,HodgkinHuxley<double,ad::Dual<double,4> > >,Newton> solver2(admodel,newton);
+  solver2.set_dt(0.05);
+  start = std::chrono::steady_clock::now();
+  while (solver2.get_time()<100.0-1e-8) solver2.step();
+  double time2 = seconds(start);
+
+  double d(0.0);
+  for (std::size_t i=0; i<4; i++) d = std::max(d,std::abs(solver1.get_state()[i]-solver2.get_state()[i]));
+  std::cout << std::setw(24) << "finite differences" << std::scientific << std::setprecision(2)
+            << std::setw(12) << time1 << std::endl;
+  std::cout << std::setw(24) << "dual numbers" << std::setw(12) << time2 << std::endl;
+  std::cout << "max. difference of final states: " << d << std::endl;
+
+  return 0;
+}
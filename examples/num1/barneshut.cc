@@ -0,0 +1,83 @@
+#include <iostream>
+#include <vector>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+#include "cluster.hh"
+#include "barneshut.hh"
+
+typedef Cluster<double,double,3> Model;
+
+// relative error of the accelerations computed by the tree code
+double force_error (const Vector<double>& exact, const Vector<double>& approx, std::size_t n)
+{
+  double e(0.0), s(0.0);
+  for (std::size_t i=0; i<n; i++)
+    for (std::size_t k=0; k<3; k++)
+      {
+        double a = exact[6*i+3+k], b = approx[6*i+3+k];
+        e += (a-b)*(a-b);
+        s += a*a;
+      }
+  return sqrt(e/s);
+}
+
+int main ()
+{
+  std::cout << std::setw(8) << "n" << std::setw(8) << "theta"
+            << std::setw(12) << "time [s]" << std::setw(12) << "speedup"
+            << std::setw(12) << "rel. error" << std::endl;
+
+  for (std::size_t n=1000; n<=64000; n*=4)
+    {
+      Model model(n);
+      double t;
+      Vector<double> x(model.size()), exact(model.size()), approx(model.size());
+      model.initialize(t,x);
+
+      // direct sum, skipped for the largest problem
+      double tdirect = 0.0;
+      if (n<=16000)
+        {
+          Timer timer;
+          model.f(t,x,exact);
+          tdirect = timer.elapsed();
+          std::cout << std::setw(8) << n << std::setw(8) << "direct"
+                    << std::scientific << std::showpoint << std::setprecision(2)
+                    << std::setw(12) << tdirect << std::endl;
+        }
+
+      for (double theta=0.3; theta<0.8; theta+=0.2)
+        {
+          BarnesHut<Model> tree(model,theta);
+          Timer timer;
+          tree.f(t,x,approx);
+          double time = timer.elapsed();
+          std::cout << std::setw(8) << n << std::setw(8) << std::fixed << std::setprecision(1) << theta
+                    << std::scientific << std::showpoint << std::setprecision(2)
+                    << std::setw(12) << time;
+          if (n<=16000)
+            std::cout << std::setw(12) << tdirect/time
+                      << std::setw(12) << force_error(exact,approx,n);
+          std::cout << std::endl;
+        }
+    }
+
+  // time integration using the incremental tree update
+  {
+    std::size_t n = 4000;
+    BarnesHut<Model> model(Model(n),0.5);
+    RungeKutta4<BarnesHut<Model> > solver(model);
+    solver.set_dt(1e-3);
+    Timer timer;
+    for (int i=0; i<10; i++) solver.step();
+    double time = timer.elapsed();
+    std::cout << std::endl << "RK4 with n=" << n << ": " << model.get_count()
+              << " f evaluations in " << time << " s, "
+              << model.get_rebuilds() << " tree rebuilds, "
+              << model.get_reinserted() << " bodies reinserted" << std::endl;
+  }
+
+  return 0;
+}
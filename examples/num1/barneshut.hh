@@ -0,0 +1,353 @@
+#include <vector>
+#include <algorithm>
+#include "nbody.hh"
+
+/** @brief Barnes-Hut tree code for the forces of an n-body model
+
+    Replaces the O(n^2) direct sum of an NBody model by a tree
+    (quadtree in 2d, octree in 3d) evaluation with O(n log n)
+    complexity. Cells whose size s seen from a body at distance r
+    satisfy s/r < theta are replaced by their center of mass.
+    theta=0 gives the direct sum. The state layout is the same as
+    in NBody, so the class can be used in place of the model.
+
+    Positions are gathered in structure of arrays form. Between
+    evaluations the tree is updated incrementally: bodies that left
+    their leaf are reinserted from the root and the cell moments are
+    recomputed. The tree is rebuilt from scratch only when a body
+    leaves the root cell or the tree has degraded; the rebuild then
+    inserts the bodies in the order of the old tree and reuses the
+    node storage.
+
+    \tparam Model an n-body model derived from NBody
+*/
+template<class Model>
+class BarnesHut : public Model
+{
+public:
+  /** \brief export size_type */
+  typedef typename Model::size_type size_type;
+
+  /** \brief export time_type */
+  typedef typename Model::time_type time_type;
+
+  /** \brief export number_type */
+  typedef typename Model::number_type number_type;
+
+  enum { dim = Model::dim, nchildren = 1<<Model::dim };
+
+  //! make tree code from a model, leafsize is the maximum number of bodies in a leaf
+  BarnesHut (const Model& model, number_type theta_=0.5, size_type leafsize_=8)
+    : Model(model), theta(theta_), leafsize(leafsize_), pos(dim),
+      built(false), rebuilds(0), reinserted(0)
+  {}
+
+  //! set opening angle
+  void set_theta (number_type theta_)
+  {
+    theta = theta_;
+  }
+
+  //! model evaluation
+  void f (const time_type& t, const hdnum::Vector<number_type>& x,
+          hdnum::Vector<number_type>& result) const
+  {
+    update(x);
+    for (size_type i=0; i<this->n; i++)
+      for (size_type k=0; k<dim; k++)
+        result[2*dim*i+k] = x[2*dim*i+dim+k];
+    accelerations(result);
+    this->ctr++;
+  }
+
+  //! derivative of the velocity components, position components are set to zero
+  void f_velocity (const time_type& t, const hdnum::Vector<number_type>& x,
+                   hdnum::Vector<number_type>& result) const
+  {
+    update(x);
+    for (size_type i=0; i<this->n; i++)
+      for (size_type k=0; k<dim; k++)
+        result[2*dim*i+k] = 0.0;
+    accelerations(result);
+    this->ctr++;
+  }
+
+  //! number of complete rebuilds of the tree
+  size_type get_rebuilds () const
+  {
+    return rebuilds;
+  }
+
+  //! number of bodies reinserted in incremental updates
+  size_type get_reinserted () const
+  {
+    return reinserted;
+  }
+
+private:
+  struct Node
+  {
+    number_type center[dim];    // center of the cell
+    number_type half;           // half of the edge length
+    number_type mass;           // total mass in the cell
+    number_type com[dim];       // center of mass
+    int child;                  // index of first child, -1 for a leaf
+    int head;                   // first body of a leaf, -1 if empty
+    size_type count;            // number of bodies in a leaf
+  };
+
+  // gather positions and bring the tree up to date
+  void update (const hdnum::Vector<number_type>& x) const
+  {
+    const size_type n = this->n;
+    for (size_type k=0; k<dim; k++)
+      {
+        pos[k].resize(n);
+        for (size_type i=0; i<n; i++) pos[k][i] = x[2*dim*i+k];
+      }
+
+    bool rebuild = !built;
+    for (size_type i=0; i<n && !rebuild; i++)
+      if (!contains(nodes[0],i)) rebuild = true;
+
+    if (!rebuild)
+      {
+        // remove bodies that left their leaf
+        moved.clear();
+        for (size_type q=0; q<nodes.size(); q++)
+          {
+            if (nodes[q].child>=0) continue;
+            int* link = &nodes[q].head;
+            while (*link>=0)
+              {
+                int i = *link;
+                if (contains(nodes[q],i))
+                  link = &next[i];
+                else
+                  {
+                    *link = next[i];
+                    nodes[q].count--;
+                    moved.push_back(i);
+                  }
+              }
+          }
+        if (4*moved.size()>n)
+          rebuild = true;
+        else
+          {
+            for (size_type l=0; l<moved.size(); l++) insert(moved[l]);
+            reinserted += moved.size();
+            if (nodes.size()>2*built_size) rebuild = true;
+          }
+      }
+
+    if (rebuild) build();
+    moments(0);
+  }
+
+  // build the tree from scratch
+  void build () const
+  {
+    const size_type n = this->n;
+    number_type lo[dim], hi[dim];
+    for (size_type k=0; k<dim; k++)
+      {
+        lo[k] = *std::min_element(pos[k].begin(),pos[k].end());
+        hi[k] = *std::max_element(pos[k].begin(),pos[k].end());
+      }
+    Node root;
+    root.half = 0.0;
+    for (size_type k=0; k<dim; k++)
+      {
+        root.center[k] = 0.5*(lo[k]+hi[k]);
+        root.half = std::max(root.half,number_type(0.5*(hi[k]-lo[k])));
+      }
+    // leave some space so that the bodies stay inside for a while
+    root.half = 1.1*root.half+1e-12;
+    root.child = -1;
+    root.head = -1;
+    root.count = 0;
+    nodes.clear();
+    nodes.push_back(root);
+
+    next.assign(n,-1);
+    if (order.size()!=n)
+      {
+        order.resize(n);
+        for (size_type i=0; i<n; i++) order[i] = i;
+      }
+    for (size_type l=0; l<n; l++) insert(order[l]);
+
+    // depth first order of the bodies, used for the next build and
+    // for the force loop
+    order.clear();
+    collect(0);
+    built = true;
+    built_size = nodes.size();
+    rebuilds++;
+  }
+
+  bool contains (const Node& node, int i) const
+  {
+    for (size_type k=0; k<dim; k++)
+      if (pos[k][i]<node.center[k]-node.half || pos[k][i]>=node.center[k]+node.half)
+        return false;
+    return true;
+  }
+
+  int octant (const Node& node, int i) const
+  {
+    int c = 0;
+    for (size_type k=0; k<dim; k++)
+      if (pos[k][i]>=node.center[k]) c |= 1<<k;
+    return c;
+  }
+
+  void insert (int i) const
+  {
+    int q = 0;
+    while (nodes[q].child>=0) q = nodes[q].child+octant(nodes[q],i);
+    next[i] = nodes[q].head;
+    nodes[q].head = i;
+    nodes[q].count++;
+    if (nodes[q].count>leafsize) split(q);
+  }
+
+  // distribute the bodies of leaf q to 2^d new children
+  void split (int q) const
+  {
+    // coincident bodies can not be separated
+    if (nodes[q].half<1e-10*nodes[0].half) return;
+
+    int first = nodes.size();
+    for (int c=0; c<nchildren; c++)
+      {
+        Node node;
+        node.half = 0.5*nodes[q].half;
+        for (size_type k=0; k<dim; k++)
+          node.center[k] = nodes[q].center[k] + ((c>>k)&1 ? node.half : -node.half);
+        node.child = -1;
+        node.head = -1;
+        node.count = 0;
+        nodes.push_back(node);
+      }
+    int i = nodes[q].head;
+    while (i>=0)
+      {
+        int inext = next[i];
+        Node& node = nodes[first+octant(nodes[q],i)];
+        next[i] = node.head;
+        node.head = i;
+        node.count++;
+        i = inext;
+      }
+    nodes[q].child = first;
+    nodes[q].head = -1;
+    nodes[q].count = 0;
+    for (int c=0; c<nchildren; c++)
+      if (nodes[first+c].count>leafsize) split(first+c);
+  }
+
+  void collect (int q) const
+  {
+    if (nodes[q].child<0)
+      for (int i=nodes[q].head; i>=0; i=next[i]) order.push_back(i);
+    else
+      for (int c=0; c<nchildren; c++) collect(nodes[q].child+c);
+  }
+
+  // compute mass and center of mass of all cells
+  void moments (int q) const
+  {
+    Node& node = nodes[q];
+    node.mass = 0.0;
+    for (size_type k=0; k<dim; k++) node.com[k] = 0.0;
+    if (node.child<0)
+      for (int i=node.head; i>=0; i=next[i])
+        {
+          node.mass += this->m[i];
+          for (size_type k=0; k<dim; k++) node.com[k] += this->m[i]*pos[k][i];
+        }
+    else
+      for (int c=0; c<nchildren; c++)
+        {
+          int qc = nodes[q].child+c;
+          moments(qc);
+          nodes[q].mass += nodes[qc].mass;
+          for (size_type k=0; k<dim; k++) nodes[q].com[k] += nodes[qc].mass*nodes[qc].com[k];
+        }
+    if (nodes[q].mass>0.0)
+      for (size_type k=0; k<dim; k++) nodes[q].com[k] /= nodes[q].mass;
+  }
+
+  // tree walk for all bodies
+  void accelerations (hdnum::Vector<number_type>& result) const
+  {
+    const number_type theta2 = theta*theta;
+    for (size_type l=0; l<order.size(); l++)
+      {
+        int i = order[l];
+        number_type p[dim], a[dim];
+        for (size_type k=0; k<dim; k++)
+          {
+            p[k] = pos[k][i];
+            a[k] = 0.0;
+          }
+        stack.clear();
+        stack.push_back(0);
+        while (!stack.empty())
+          {
+            const Node& node = nodes[stack.back()];
+            stack.pop_back();
+            if (node.mass==0.0) continue;
+            if (node.child<0)
+              {
+                for (int j=node.head; j>=0; j=next[j])
+                  if (j!=i)
+                    interact(p,a,this->m[j],&pos[0],j);
+                continue;
+              }
+            number_type r2(0.0);
+            bool inside = true;
+            for (size_type k=0; k<dim; k++)
+              {
+                number_type dx = node.com[k]-p[k];
+                r2 += dx*dx;
+                if (fabs(p[k]-node.center[k])>node.half) inside = false;
+              }
+            if (!inside && 4.0*node.half*node.half<theta2*r2)
+              {
+                number_type r3(r2*sqrt(r2));
+                for (size_type k=0; k<dim; k++) a[k] += node.mass*(node.com[k]-p[k])/r3;
+              }
+            else
+              for (int c=0; c<nchildren; c++) stack.push_back(node.child+c);
+          }
+        for (size_type k=0; k<dim; k++) result[2*dim*i+dim+k] = this->G*a[k];
+      }
+  }
+
+  void interact (const number_type* p, number_type* a, number_type mj,
+                 const std::vector<number_type>* q, int j) const
+  {
+    number_type dx[dim];
+    number_type r2(0.0);
+    for (size_type k=0; k<dim; k++)
+      {
+        dx[k] = q[k][j]-p[k];
+        r2 += dx[k]*dx[k];
+      }
+    number_type r3(r2*sqrt(r2));
+    for (size_type k=0; k<dim; k++) a[k] += mj*dx[k]/r3;
+  }
+
+  number_type theta;
+  size_type leafsize;
+  mutable std::vector<std::vector<number_type> > pos; // positions, pos[k][i]
+  mutable std::vector<Node> nodes;                     // node pool, nodes[0] is the root
+  mutable std::vector<int> next;                       // linked list of bodies in a leaf
+  mutable std::vector<int> order;                      // bodies in tree order
+  mutable std::vector<int> moved, stack;
+  mutable bool built;
+  mutable size_type built_size, rebuilds, reinserted;
+};
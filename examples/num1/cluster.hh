@@ -0,0 +1,57 @@
+#include <random>
+#include "nbody.hh"
+
+/** @brief cluster of n bodies with random initial positions in the unit ball
+
+    \tparam T a type representing time values
+    \tparam N a type representing states and f-values
+    \tparam d space dimension
+*/
+template<class T, class N=T, int d=3>
+class Cluster : public NBody<T,N,d>
+{
+public:
+  /** \brief export size_type */
+  typedef std::size_t size_type;
+
+  /** \brief export time_type */
+  typedef T time_type;
+
+  /** \brief export number_type */
+  typedef N number_type;
+
+  // make a cluster with n bodies of equal mass and total mass one
+  Cluster (size_type n_, unsigned seed_=1) : NBody<T,N,d>(n_), seed(seed_)
+  {
+    for (size_type i=0; i<n_; i++) this->m[i] = 1.0/n_;
+    this->G = 1.0;
+  }
+
+  //! set initial state including time value
+  void initialize (T& t0, Vector<N>& x0) const
+  {
+    t0 = 0;
+
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> uniform(-1.0,1.0);
+    for (size_type i=0; i<this->n; i++)
+      {
+        size_type I=2*d*i;
+        double r2;
+        do {
+          r2 = 0.0;
+          for (size_type k=0; k<d; k++)
+            {
+              x0[I+k] = uniform(generator);
+              r2 += x0[I+k]*x0[I+k];
+            }
+        } while (r2>1.0);
+        for (size_type k=0; k<d; k++)
+          x0[I+d+k] = 0.1*uniform(generator);
+      }
+    NBody<T,N,d>::normalize(x0);
+  }
+
+private:
+  unsigned seed;
+};
@@ -0,0 +1,143 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+// wall clock time since start
+double seconds (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+/** @brief Semi-discrete reaction diffusion equation without f_x
+
+    u_t = u_xx + u(1-u)(u-a) on (0,1) with homogeneous Dirichlet
+    boundary conditions, central differences on n interior points.
+*/
+template<class T, class N=T>
+class ReactionDiffusion
+{
+public:
+  typedef std::size_t size_type;
+  typedef T time_type;
+  typedef N number_type;
+
+  ReactionDiffusion (size_type n_, N a_=0.3)
+    : n(n_), a(a_), evaluations(0)
+  {}
+
+  std::size_t size () const
+  {
+    return n;
+  }
+
+  void initialize (T& t0, Vector<N>& x0) const
+  {
+    t0 = 0;
+    N h = N(1.0)/N(n+1);
+    for (size_type i=0; i<n; i++) x0[i] = sin(M_PI*(i+1)*h);
+  }
+
+  void f (const T& t, const Vector<N>& x, Vector<N>& result) const
+  {
+    N h2inv = N((n+1)*(n+1));
+    for (size_type i=0; i<n; i++)
+      {
+        N left = (i>0) ? x[i-1] : N(0.0);
+        N right = (i<n-1) ? x[i+1] : N(0.0);
+        result[i] = h2inv*(left-N(2.0)*x[i]+right) + x[i]*(N(1.0)-x[i])*(x[i]-a);
+      }
+    evaluations++;
+  }
+
+  size_type get_evaluations () const
+  {
+    return evaluations;
+  }
+
+private:
+  size_type n;
+  N a;
+  mutable size_type evaluations;
+};
+
+int main (int argc, char** argv)
+{
+  std::size_t n = 1000;
+  if (argc>1) n = atoi(argv[1]);
+
+  // Bratu problem -u'' = lambda exp(u) as nonlinear system
+  std::cout << "Bratu problem, n=" << n << std::endl;
+  std::size_t evaluations = 0;
+  double lambda = 1.0, h2inv = double((n+1)*(n+1));
+  auto bratu = [&evaluations,lambda,h2inv,n] (const Vector<double>& u) {
+    Vector<double> r(n);
+    for (std::size_t i=0; i<n; i++)
+      {
+        double left = (i>0) ? u[i-1] : 0.0;
+        double right = (i<n-1) ? u[i+1] : 0.0;
+        r[i] = h2inv*(-left+2.0*u[i]-right) - lambda*exp(u[i]);
+      }
+    evaluations++;
+    return r;
+  };
+  Vector<double> u(n,0.1);
+  auto dense = getNonlinearProblem(bratu,u);
+  auto colored = getNonlinearProblem(bratu,u,bandedPattern(n,1,1));
+
+  DenseMatrix<double> A(n,n), B(n,n);
+  evaluations = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  dense.F_x(u,A);
+  double tdense = seconds(start);
+  std::size_t edense = evaluations;
+
+  evaluations = 0;
+  start = std::chrono::steady_clock::now();
+  colored.F_x(u,B);
+  double tcolored = seconds(start);
+  std::size_t ecolored = evaluations;
+
+  double d(0.0);
+  for (std::size_t i=0; i<n; i++)
+    for (std::size_t j=0; j<n; j++) d = std::max(d,std::abs(A[i][j]-B[i][j]));
+  std::cout << std::setw(24) << "Jacobian" << std::setw(12) << "F evals" << std::setw(12) << "time [s]" << std::endl;
+  std::cout << std::setw(24) << "column by column" << std::setw(12) << edense
+            << std::scientific << std::setprecision(2) << std::setw(12) << tdense << std::endl;
+  std::cout << std::setw(24) << "colored (3 colors)" << std::setw(12) << ecolored
+            << std::setw(12) << tcolored << std::endl;
+  std::cout << "max. difference: " << d << std::endl;
+
+  // implicit Euler for a model without f_x
+  std::size_t m = n/4;
+  std::cout << std::endl << "reaction diffusion with implicit Euler, n=" << m << std::endl;
+  std::cout << std::setw(24) << "Jacobian" << std::setw(12) << "f evals" << std::setw(12) << "time [s]" << std::endl;
+  ReactionDiffusion<double> model(m);
+  Newton newton;
+  newton.set_reduction(1e-10);
+  Vector<double> result[2];
+  for (int k=0; k<2; k++)
+    {
+      FiniteDifferenceModel<ReactionDiffusion<double> > fdmodel =
+        (k==0) ? FiniteDifferenceModel<ReactionDiffusion<double> >(model)
+               : FiniteDifferenceModel<ReactionDiffusion<double> >(model,bandedPattern(m,1,1));
+      IE<FiniteDifferenceModel<ReactionDiffusion<double> >,Newton> solver(fdmodel,newton);
+      solver.set_dt(1e-3);
+      std::size_t e0 = model.get_evaluations();
+      start = std::chrono::steady_clock::now();
+      for (int i=0; i<20; i++) solver.step();
+      double time = seconds(start);
+      std::cout << std::setw(24) << ((k==0) ? "column by column" : "colored (3 colors)")
+                << std::setw(12) << model.get_evaluations()-e0
+                << std::setw(12) << time << std::endl;
+      result[k] = solver.get_state();
+    }
+  d = 0.0;
+  for (std::size_t i=0; i<m; i++) d = std::max(d,std::abs(result[0][i]-result[1][i]));
+  std::cout << "max. difference: " << d << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+#include "cluster.hh"
+#include "directsum.hh"
+
+// wall clock time of one force evaluation
+template<class Model>
+double evaluate (const Model& model, const Vector<typename Model::number_type>& x,
+                 Vector<typename Model::number_type>& result)
+{
+  typename Model::time_type t(0.0);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  model.f(t,x,result);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+template<class N>
+void benchmark (const std::string& name, std::size_t nmax)
+{
+  typedef Cluster<N,N,3> Model;
+  std::cout << std::setw(8) << "n" << std::setw(8) << "type" << std::setw(10) << "kernel"
+            << std::setw(12) << "time [s]" << std::setw(14) << "interact/s"
+            << std::setw(12) << "rel. error" << std::endl;
+
+  for (std::size_t n=1000; n<=nmax; n = (n<nmax && 4*n>nmax) ? nmax : 4*n)
+    {
+      Model model(n);
+      N t;
+      Vector<N> x(model.size()), exact(model.size()), fast(model.size());
+      model.initialize(t,x);
+      double pairs = double(n)*double(n-1);
+
+      // original loop, only for moderate n
+      if (n<=16000)
+        {
+          double time = evaluate(model,x,exact);
+          std::cout << std::setw(8) << n << std::setw(8) << name << std::setw(10) << "NBody"
+                    << std::scientific << std::showpoint << std::setprecision(2)
+                    << std::setw(12) << time << std::setw(14) << pairs/time << std::endl;
+        }
+
+      DirectSum<Model> tiled(model);
+      double time = evaluate(tiled,x,fast);
+      std::cout << std::setw(8) << n << std::setw(8) << name << std::setw(10) << "tiled"
+                << std::scientific << std::showpoint << std::setprecision(2)
+                << std::setw(12) << time << std::setw(14) << pairs/time;
+      if (n<=16000)
+        {
+          double e(0.0), s(0.0);
+          for (std::size_t i=0; i<x.size(); i++)
+            {
+              e += double(exact[i]-fast[i])*double(exact[i]-fast[i]);
+              s += double(exact[i])*double(exact[i]);
+            }
+          std::cout << std::setw(12) << sqrt(e/s);
+        }
+      std::cout << std::endl;
+      if (n==nmax) break;
+    }
+  std::cout << std::endl;
+}
+
+int main (int argc, char** argv)
+{
+  // largest number of bodies may be given on the command line
+  std::size_t nmax = 100000;
+  if (argc>1) nmax = atoi(argv[1]);
+
+  DirectSum<Cluster<double> > model(Cluster<double>(2));
+  std::cout << "threads: " << model.get_threads() << std::endl << std::endl;
+
+  benchmark<float>("float",nmax);
+  benchmark<double>("double",nmax);
+
+  return 0;
+}
@@ -0,0 +1,155 @@
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include "nbody.hh"
+
+/** @brief tiled and multithreaded direct sum for the forces of an n-body model
+
+    Computes the same all-pairs forces as NBody::f but with a layout
+    that the compiler can vectorize: positions and masses are gathered
+    into structure of arrays form, the inner loop over j has no
+    branches (the self interaction, and any pair of coincident bodies,
+    is masked by a zero weight) and evaluates 1/sqrt(r2) once per pair
+    instead of dividing per component. Note that sqrt is only
+    vectorized when compiled with -fno-math-errno. The loop over j is
+    blocked into tiles that stay in cache while a tile of i values is
+    processed, and the i-tiles are distributed over threads. Each
+    thread accumulates into its own bodies only, so no synchronization
+    is needed.
+
+    \tparam Model an n-body model derived from NBody
+*/
+template<class Model>
+class DirectSum : public Model
+{
+public:
+  /** \brief export size_type */
+  typedef typename Model::size_type size_type;
+
+  /** \brief export time_type */
+  typedef typename Model::time_type time_type;
+
+  /** \brief export number_type */
+  typedef typename Model::number_type number_type;
+
+  enum { dim = Model::dim };
+
+  //! make kernel from a model, nthreads=0 uses all available cores
+  DirectSum (const Model& model, size_type nthreads_=0, size_type tile_=512)
+    : Model(model), nthreads(nthreads_), tile(tile_)
+  {
+    if (nthreads==0) nthreads = std::max(1u,std::thread::hardware_concurrency());
+  }
+
+  //! model evaluation
+  void f (const time_type& t, const hdnum::Vector<number_type>& x,
+          hdnum::Vector<number_type>& result) const
+  {
+    forces(x,result);
+    for (size_type i=0; i<this->n; i++)
+      for (size_type k=0; k<dim; k++)
+        result[2*dim*i+k] = x[2*dim*i+dim+k];
+    this->ctr++;
+  }
+
+  //! derivative of the velocity components, position components are set to zero
+  void f_velocity (const time_type& t, const hdnum::Vector<number_type>& x,
+                   hdnum::Vector<number_type>& result) const
+  {
+    forces(x,result);
+    for (size_type i=0; i<this->n; i++)
+      for (size_type k=0; k<dim; k++)
+        result[2*dim*i+k] = 0.0;
+    this->ctr++;
+  }
+
+  //! number of threads used
+  size_type get_threads () const
+  {
+    return nthreads;
+  }
+
+private:
+  void forces (const hdnum::Vector<number_type>& x, hdnum::Vector<number_type>& result) const
+  {
+    const size_type n = this->n;
+    mass.resize(n);
+    for (size_type i=0; i<n; i++) mass[i] = this->m[i];
+    pos.resize(dim*n);
+    for (size_type k=0; k<dim; k++)
+      for (size_type i=0; i<n; i++) pos[k*n+i] = x[2*dim*i+k];
+    acc.resize(dim*n);
+
+    // static assignment of i-tiles to threads
+    size_type ntiles = (n+tile-1)/tile;
+    size_type p = std::min(nthreads,ntiles);
+    if (p<=1)
+      work(0,ntiles,1);
+    else
+      {
+        std::vector<std::thread> threads;
+        for (size_type r=0; r<p; r++)
+          threads.push_back(std::thread(&DirectSum::work,this,r,ntiles,p));
+        for (size_type r=0; r<p; r++) threads[r].join();
+      }
+
+    for (size_type i=0; i<n; i++)
+      for (size_type k=0; k<dim; k++)
+        result[2*dim*i+dim+k] = this->G*acc[dim*i+k];
+  }
+
+  // process i-tiles r, r+p, r+2p, ...
+  void work (size_type r, size_type ntiles, size_type p) const
+  {
+    const size_type n = this->n;
+    std::vector<number_type> a(dim*tile);
+    for (size_type it=r; it<ntiles; it+=p)
+      {
+        size_type i0 = it*tile, i1 = std::min(n,i0+tile);
+        std::fill(a.begin(),a.end(),number_type(0.0));
+        for (size_type j0=0; j0<n; j0+=tile)
+          {
+            size_type j1 = std::min(n,j0+tile);
+            for (size_type i=i0; i<i1; i++)
+              interact(i,j0,j1,&a[dim*(i-i0)]);
+          }
+        for (size_type i=i0; i<i1; i++)
+          for (size_type k=0; k<dim; k++) acc[dim*i+k] = a[dim*(i-i0)+k];
+      }
+  }
+
+  // accelerations of body i due to bodies j0,...,j1-1
+  void interact (size_type i, size_type j0, size_type j1, number_type* a) const
+  {
+    const size_type n = this->n;
+    const number_type* q = &pos[0];
+    const number_type* mj = &mass[0];
+    number_type p[dim], s[dim];
+    for (size_type k=0; k<dim; k++)
+      {
+        p[k] = q[k*n+i];
+        s[k] = 0.0;
+      }
+    for (size_type j=j0; j<j1; j++)
+      {
+        number_type dx[dim];
+        number_type r2(0.0);
+        for (size_type k=0; k<dim; k++)
+          {
+            dx[k] = q[k*n+j]-p[k];
+            r2 += dx[k]*dx[k];
+          }
+        // mask the self interaction without a branch: r2=1 and zero weight
+        number_type other(r2>number_type(0.0));
+        number_type rinv = number_type(1.0)/sqrt(r2+(number_type(1.0)-other));
+        number_type f = other*mj[j]*rinv*rinv*rinv;
+        for (size_type k=0; k<dim; k++) s[k] += f*dx[k];
+      }
+    for (size_type k=0; k<dim; k++) a[k] += s[k];
+  }
+
+  size_type nthreads, tile;
+  mutable std::vector<number_type> pos;               // positions, pos[k*n+i]
+  mutable std::vector<number_type> mass;
+  mutable std::vector<number_type> acc;               // accelerations, acc[dim*i+k]
+};
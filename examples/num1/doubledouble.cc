@@ -0,0 +1,97 @@
+#include <iostream>
+
+#include "hdnum.hh"
+#include "modelproblem.hh"
+
+/*
+  The model problem u' = -u in double-double arithmetic. In double the
+  error of high order methods stagnates near 1e-16 after a few
+  refinements, in double-double the convergence order stays visible
+  down to errors of about 1e-30.
+*/
+
+// error at time T with fixed time step dt
+template<class Model, class Solver>
+typename Model::number_type error (const Model& model, Solver& solver,
+                                   typename Model::time_type T, typename Model::time_type dt)
+{
+  solver.set_dt(dt);
+  while (solver.get_time()<T-dt/2.0) solver.step();
+  hdnum::Vector<typename Model::number_type> e;
+  model.exact_solution(solver.get_time(),e);
+  e -= solver.get_state();
+  return hdnum::norm(e);
+}
+
+int main ()
+{
+  typedef hdnum::DoubleDouble Number;
+  typedef ModelProblem<Number> Model;
+  Model model(-1.0);
+
+  // Gauss with s=3 is of order 6, coefficients computed in double-double
+  const Number r15(sqrt(Number(15.0)));
+  hdnum::DenseMatrix<Number> A(3,3,0.0);
+  A[0][0] = Number(5.0)/36.0;
+  A[0][1] = (10.0-3.0*r15)/45.0;
+  A[0][2] = (25.0-6.0*r15)/180.0;
+  A[1][0] = (10.0+3.0*r15)/72.0;
+  A[1][1] = Number(2.0)/9.0;
+  A[1][2] = (10.0-3.0*r15)/72.0;
+  A[2][0] = (25.0+6.0*r15)/180.0;
+  A[2][1] = (10.0+3.0*r15)/45.0;
+  A[2][2] = Number(5.0)/36.0;
+
+  hdnum::Vector<Number> B(3,0.0);
+  B[0] = Number(5.0)/18.0;
+  B[1] = Number(4.0)/9.0;
+  B[2] = Number(5.0)/18.0;
+
+  hdnum::Vector<Number> C(3,0.0);
+  C[0] = (5.0-r15)/10.0;
+  C[1] = Number(0.5);
+  C[2] = (5.0+r15)/10.0;
+
+  std::cout << "Gauss, s=3" << std::endl;
+  hdnum::RungeKutta<Model> gauss(model,A,B,C);
+  ordertest(model,gauss,Number(5.0),Number(1.0),10);
+
+  // explicit, adaptive and implicit integrators at fixed steps
+  std::cout << std::endl << std::setw(10) << "dt" << std::setw(14) << "RungeKutta4"
+            << std::setw(14) << "IE" << std::endl;
+  for (int i=0; i<6; i++)
+    {
+      Number dt(1.0/(10.0*(1<<i)));
+      hdnum::RungeKutta4<Model> rk4(model);
+      hdnum::Newton newton;
+      newton.set_reduction(1e-28);
+      newton.set_abslimit(1e-30);
+      hdnum::IE<Model,hdnum::Newton> ie(model,newton);
+      std::cout << std::scientific << std::setprecision(2) << std::setw(10) << dt
+                << std::setw(14) << error(model,rk4,Number(1.0),dt)
+                << std::setw(14) << error(model,ie,Number(1.0),dt) << std::endl;
+    }
+
+  std::cout << std::endl << "RKF45 to time 1" << std::endl;
+  std::cout << std::setw(10) << "TOL" << std::setw(14) << "error" << std::setw(8) << "steps" << std::endl;
+  for (int i=1; i<=5; i++)
+    {
+      Number TOL(pow(Number(10.0),-5*i));
+      hdnum::RKF45<Model> rkf45(model);
+      rkf45.set_TOL(TOL);
+      rkf45.set_dt(1e-2);
+      while (rkf45.get_time()<1.0)
+        {
+          if (rkf45.get_time()+rkf45.get_dt()>1.0) rkf45.set_dt(1.0-rkf45.get_time());
+          rkf45.step();
+        }
+      hdnum::Vector<Number> e;
+      model.exact_solution(rkf45.get_time(),e);
+      e -= rkf45.get_state();
+      std::cout << std::scientific << std::setprecision(2) << std::setw(10) << TOL
+                << std::setw(14) << hdnum::norm(e)
+                << std::setw(8) << rkf45.get_statistics().steps << std::endl;
+    }
+
+  return 0;
+}
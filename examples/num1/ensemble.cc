@@ -0,0 +1,174 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+#include "lorenz.hh"
+#include "vanderpol.hh"
+#include "hodgkinhuxley.hh"
+
+// wall clock time since start
+double seconds (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+// advance a single solver to time T, the last step is shortened to hit T
+template<class S>
+void solve_to (S& solver, double T)
+{
+  while (solver.get_time()<T-1e-12)
+    {
+      if (solver.get_time()+solver.get_dt()>T)
+        solver.set_dt(T-solver.get_time());
+      solver.step();
+    }
+}
+
+void print_line (const std::string& method, double time, double reference)
+{
+  std::cout << std::setw(28) << method
+            << std::scientific << std::showpoint << std::setprecision(2)
+            << std::setw(12) << time
+            << std::fixed << std::setprecision(1) << std::setw(10) << reference/time
+            << std::endl;
+}
+
+// largest difference of member states to the separately computed ones
+template<class S>
+double difference (const S& solver, const std::vector<Vector<double> >& separate)
+{
+  double d(0.0);
+  Vector<double> x;
+  for (std::size_t k=0; k<separate.size(); k++)
+    {
+      solver.get_member(k,x);
+      for (std::size_t i=0; i<x.size(); i++) d = std::max(d,fabs(x[i]-separate[k][i]));
+    }
+  return d;
+}
+
+int main ()
+{
+  std::size_t nthreads = std::max(1u,std::thread::hardware_concurrency());
+  std::cout << "threads: " << nthreads << std::endl;
+  std::cout << std::setw(28) << "method" << std::setw(12) << "time [s]"
+            << std::setw(10) << "speedup" << std::endl;
+
+  // van der Pol with parameter sweep, RKF45
+  {
+    std::size_t K = 4096;
+    double T = 10.0, TOL = 1e-6;
+    Vector<double> eps(K);
+    for (std::size_t k=0; k<K; k++) eps[k] = 0.1+k*(1.0/K);
+    std::cout << std::endl << "van der Pol, K=" << K << ", RKF45" << std::endl;
+
+    std::vector<Vector<double> > separate(K);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (std::size_t k=0; k<K; k++)
+      {
+        VanDerPolProblem<double> model(eps[k]);
+        RKF45<VanDerPolProblem<double> > solver(model);
+        solver.set_TOL(TOL);
+        solve_to(solver,T);
+        separate[k] = solver.get_state();
+      }
+    double reference = seconds(start);
+    print_line("separate RKF45 objects",reference,reference);
+
+    std::vector<VanDerPolProblem<double> > models;
+    for (std::size_t k=0; k<K; k++) models.push_back(VanDerPolProblem<double>(eps[k]));
+    EnsembleAdapter<VanDerPolProblem<double> > adapter(models);
+    EnsembleRKF45<EnsembleAdapter<VanDerPolProblem<double> > > solver1(adapter);
+    solver1.set_TOL(TOL);
+    start = std::chrono::steady_clock::now();
+    solver1.advance(T);
+    print_line("EnsembleAdapter",seconds(start),reference);
+
+    VanDerPolEnsemble<double> ensemble(eps);
+    EnsembleRKF45<VanDerPolEnsemble<double> > solver2(ensemble);
+    solver2.set_TOL(TOL);
+    start = std::chrono::steady_clock::now();
+    solver2.advance(T);
+    print_line("VanDerPolEnsemble",seconds(start),reference);
+
+    EnsembleRKF45<VanDerPolEnsemble<double> > solver3(ensemble,nthreads);
+    solver3.set_TOL(TOL);
+    start = std::chrono::steady_clock::now();
+    solver3.advance(T);
+    print_line("VanDerPolEnsemble, threads",seconds(start),reference);
+
+    std::cout << "max. difference to separate solves: " << std::scientific
+              << difference(solver3,separate) << ", steps: " << solver3.get_steps()
+              << ", rejected: " << solver3.get_rejected() << std::endl;
+  }
+
+  // Lorenz with parameter sweep, RK4 with fixed step size
+  {
+    std::size_t K = 1024;
+    double T = 10.0, dt = 1e-3;
+    std::cout << std::endl << "Lorenz, K=" << K << ", RK4" << std::endl;
+
+    LorenzEnsemble<double> ensemble(K);
+    for (std::size_t k=0; k<K; k++) ensemble.set_parameters(k,10.0,20.0+k*(10.0/K),8.0/3.0);
+
+    std::vector<Vector<double> > separate(K);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (std::size_t k=0; k<K; k++)
+      {
+        Lorenz<double> model(10.0,20.0+k*(10.0/K),8.0/3.0);
+        RungeKutta4<Lorenz<double> > solver(model);
+        solver.set_dt(dt);
+        while (solver.get_time()<T-1e-8) solver.step();
+        separate[k] = solver.get_state();
+      }
+    double reference = seconds(start);
+    print_line("separate RungeKutta4 objects",reference,reference);
+
+    EnsembleRK4<LorenzEnsemble<double> > solver(ensemble,nthreads);
+    solver.set_dt(dt);
+    start = std::chrono::steady_clock::now();
+    while (solver.get_time()[0]<T-1e-8) solver.step();
+    print_line("LorenzEnsemble, threads",seconds(start),reference);
+
+    std::cout << "max. difference to separate solves: " << std::scientific
+              << difference(solver,separate) << std::endl;
+  }
+
+  // Hodgkin Huxley with varying source current, RKF45
+  {
+    std::size_t K = 1024;
+    double T = 50.0, TOL = 1e-4;
+    Vector<double> I(K);
+    for (std::size_t k=0; k<K; k++) I[k] = k*(20.0/K);
+    std::cout << std::endl << "Hodgkin Huxley, K=" << K << ", RKF45" << std::endl;
+
+    std::vector<HodgkinHuxley<double> > models;
+    for (std::size_t k=0; k<K; k++) models.push_back(HodgkinHuxley<double>(I[k]));
+    EnsembleAdapter<HodgkinHuxley<double> > adapter(models);
+    EnsembleRKF45<EnsembleAdapter<HodgkinHuxley<double> > > solver1(adapter);
+    solver1.set_TOL(TOL);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    solver1.advance(T);
+    double reference = seconds(start);
+    print_line("EnsembleAdapter",reference,reference);
+    std::vector<Vector<double> > separate(K);
+    for (std::size_t k=0; k<K; k++) solver1.get_member(k,separate[k]);
+
+    HodgkinHuxleyEnsemble<double> ensemble(I);
+    EnsembleRKF45<HodgkinHuxleyEnsemble<double> > solver2(ensemble,nthreads);
+    solver2.set_TOL(TOL);
+    start = std::chrono::steady_clock::now();
+    solver2.advance(T);
+    print_line("HodgkinHuxleyEnsemble, threads",seconds(start),reference);
+    std::cout << "max. difference to EnsembleAdapter: " << std::scientific
+              << difference(solver2,separate) << ", steps: " << solver2.get_steps()
+              << ", rejected: " << solver2.get_rejected() << std::endl;
+  }
+
+  return 0;
+}
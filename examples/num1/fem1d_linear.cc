@@ -122,22 +122,22 @@ void Poisson::assemble_system()
 /*
  * This functions solves the linear equation system
  * A*y=f 
- * using LU-decomposition
+ * using the Cholesky decomposition. A is symmetric positive definite
+ * and banded: an element of degree p couples grid points at most p
+ * apart. The band is passed as envelope, so only the band is touched
+ * and the solve takes O(n_dofs) operations.
  * 
  */
 void Poisson::solve()
 {
   std::cout << "==================== Solving System =================\n";
-  hdnum::Vector<long unsigned int> p(n_dofs);
-  hdnum::Vector<long unsigned int> q(n_dofs);
-  hdnum::Vector<double> s(n_dofs);
-  hdnum::row_equilibrate(system_matrix,s);
-  hdnum::lr_fullpivot(system_matrix,p,q);
-  hdnum::apply_equilibrate(s,rhs);
-  hdnum::permute_forward(p,rhs);
-  hdnum::solveL(system_matrix,rhs,rhs);
-  hdnum::solveR(system_matrix,solution,rhs);
-  hdnum::permute_backward(q,solution);
+  std::vector<std::size_t> first(n_dofs);
+  for ( int i = 0; i < n_dofs; i++ )
+  {
+    first[i] = std::max(0,i-p);
+  }
+  hdnum::cholesky_skyline(system_matrix,first);
+  hdnum::cholesky_skyline_solve(system_matrix,first,solution,rhs);
   std::cout << "Done." << std::endl;
 }
 /*
@@ -18,10 +18,10 @@ public:
   /** \brief export number_type */
   typedef N number_type;
 
-  //! constructor stores parameter lambda
-  HodgkinHuxley () 
+  //! constructor stores the source current applied up to time 100
+  HodgkinHuxley (const N& I0_=10.0)
   : Cm(1.0),GNa(120.0), GK(36.0), Gm(0.3),
-    ENa(115.0), EK(-12.0),Em(10.613)
+    ENa(115.0), EK(-12.0),Em(10.613), I0(I0_)
   {}
 
   //! return number of componentes for the model
@@ -51,46 +51,123 @@ public:
     result[3] = alphan(V)*(1-n)-betan(V)*n;
   }
 
-private:
-  number_type Cm;
-  number_type GNa, GK, Gm;
-  number_type ENa, EK, Em;
-
-  number_type alphan (number_type V) const
+  //! rate functions of the gating variables
+  static number_type alphan (number_type V)
   {
 	return (10-V)/(100.0*(exp((10-V)/10)-1));
   }
 
-  number_type betan (number_type V) const
+  static number_type betan (number_type V)
   {
 	return 0.125*exp(-V/80);
   }
 
-  number_type alpham (number_type V) const
+  static number_type alpham (number_type V)
   {
 	return (25-V)/(10.0*(exp((25-V)/10)-1));
   }
 
-  number_type betam (number_type V) const
+  static number_type betam (number_type V)
   {
 	return 4*exp(-V/18);
   }
 
-  number_type alphah (number_type V) const
+  static number_type alphah (number_type V)
   {
 	return 0.07*exp(-V/20);
   }
 
-  number_type betah (number_type V) const
+  static number_type betah (number_type V)
   {
 	return 1.0/(exp((30-V)/10)+1);
   }
 
+private:
+  number_type Cm;
+  number_type GNa, GK, Gm;
+  number_type ENa, EK, Em;
+  number_type I0;
+
   number_type Isource (time_type t) const
   {
     if (t<100)
-      return 10.0;
+      return I0;
     else
       return 0.0;
   }
 };
+
+/** @brief ensemble of Hodgkin Huxley models with individual source currents
+
+    Member k is driven by the current I[k] up to time 100.
+    State layout as required by the ensemble solvers: component i of
+    member k is X[i*K+k].
+
+    \tparam T a type representing time values
+    \tparam N a type representing states and f-values
+*/
+template<class T, class N=T>
+class HodgkinHuxleyEnsemble
+{
+public:
+  /** \brief export size_type */
+  typedef std::size_t size_type;
+
+  /** \brief export time_type */
+  typedef T time_type;
+
+  /** \brief export number_type */
+  typedef N number_type;
+
+  //! constructor stores the source currents of all members
+  HodgkinHuxleyEnsemble (const Vector<N>& I_)
+  : Cm(1.0),GNa(120.0), GK(36.0), Gm(0.3),
+    ENa(115.0), EK(-12.0),Em(10.613), I(I_)
+  {}
+
+  //! return number of componentes of one member
+  std::size_t size () const
+  {
+    return 4;
+  }
+
+  //! return number of members
+  std::size_t members () const
+  {
+    return I.size();
+  }
+
+  //! set initial state including time value
+  void initialize (T& t0, Vector<N>& X) const
+  {
+    t0 = 0;
+    for (size_type i=0; i<X.size(); i++) X[i] = 0.0;
+  }
+
+  //! model evaluation for members k0,...,k1-1
+  void f (const Vector<T>& t, const Vector<N>& X, Vector<N>& F,
+          size_type k0, size_type k1) const
+  {
+    typedef HodgkinHuxley<T,N> HH;
+    const size_type K = I.size();
+    for (size_type k=k0; k<k1; k++)
+      {
+        number_type V=X[k];
+        number_type m=X[K+k];
+        number_type h=X[2*K+k];
+        number_type n=X[3*K+k];
+        number_type Isource = (t[k]<100) ? I[k] : number_type(0.0);
+
+        F[k] = (Isource + GNa*m*m*m*h*(ENa-V) + GK*n*n*n*n*(EK-V) + Gm*(Em-V))/Cm;
+        F[K+k] = HH::alpham(V)*(1-m)-HH::betam(V)*m;
+        F[2*K+k] = HH::alphah(V)*(1-h)-HH::betah(V)*h;
+        F[3*K+k] = HH::alphan(V)*(1-n)-HH::betan(V)*n;
+      }
+  }
+
+private:
+  number_type Cm;
+  number_type GNa, GK, Gm;
+  number_type ENa, EK, Em;
+  Vector<N> I;
+};
@@ -63,17 +63,13 @@ public:
 template<class Solver, class Number>
 Number run_scheme (Solver solver, std::string filename, Number T)
 {
-  std::vector<Number> times;           // store time values here
-  std::vector<Vector<Number> > states; // store states here
-  times.push_back(solver.get_time());  // initial time
-  states.push_back(solver.get_state()); // initial state
+  //FileWriter<Number,Number> writer(filename); // output model result
+  //solver.attach(writer);
 
   int steps=0;
   while (solver.get_time()<T-1e-8) // the time loop
     {
       solver.step();                  // advance model by one time step
-      times.push_back(solver.get_time()); // save time
-      states.push_back(solver.get_state()); // and state
       steps++;
     }
 
@@ -83,7 +79,6 @@ Number run_scheme (Solver solver, std::string filename, Number T)
   auto u = solver.get_state();
   Number error = std::sqrt((u0-u[0])*(u0-u[0])+(u1-u[1])*(u1-u[1]));
   //std::cout << "file=" << filename << " steps=" << steps << " error=" << error << std::endl;
-  //gnuplot(filename,times,states); // output model result
   return error;
 }
 
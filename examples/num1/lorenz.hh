@@ -17,7 +17,9 @@ public:
   typedef N number_type;
 
   // make the model 
-  Lorenz () {}
+  Lorenz (N sigma_=10.0, N rho_=28.0, N beta_=N(8.0)/N(3.0))
+    : sigma(sigma_), rho(rho_), beta(beta_)
+  {}
 
   //! return number of componentes for the model
   std::size_t size () const
@@ -37,8 +39,89 @@ public:
   //! model evaluation
   void f (const T& t, const hdnum::Vector<N>& x, hdnum::Vector<N>& result) const
   {
-    result[0] = -10*x[0] + 10*x[1];
-    result[1] = 28*x[0] - x[1] - x[0]*y[2];
-    result[2] = -number_type(8.0)/number_type(3.0)*x[2] + y[0]*y[1];
+    result[0] = -sigma*x[0] + sigma*x[1];
+    result[1] = rho*x[0] - x[1] - x[0]*x[2];
+    result[2] = -beta*x[2] + x[0]*x[1];
   }
+
+private:
+  N sigma, rho, beta;
+};
+
+/** @brief ensemble of Lorenz problems with individual parameters
+
+    State layout as required by the ensemble solvers: component i of
+    member k is X[i*K+k].
+
+    \tparam T a type representing time values
+    \tparam N a type representing states and f-values
+*/
+template<class T, class N=T>
+class LorenzEnsemble
+{
+public:
+  /** \brief export size_type */
+  typedef std::size_t size_type;
+
+  /** \brief export time_type */
+  typedef T time_type;
+
+  /** \brief export number_type */
+  typedef N number_type;
+
+  // make K members with the standard parameters
+  LorenzEnsemble (size_type K_)
+    : K(K_), sigma(K_,10.0), rho(K_,28.0), beta(K_,N(8.0)/N(3.0))
+  {}
+
+  //! set parameters of member k
+  void set_parameters (size_type k, N sigma_, N rho_, N beta_)
+  {
+    sigma[k] = sigma_;
+    rho[k] = rho_;
+    beta[k] = beta_;
+  }
+
+  //! return number of componentes of one member
+  std::size_t size () const
+  {
+    return 3;
+  }
+
+  //! return number of members
+  std::size_t members () const
+  {
+    return K;
+  }
+
+  //! set initial state including time value
+  void initialize (T& t0, Vector<N>& X) const
+  {
+    for (size_type k=0; k<K; k++)
+      {
+        X[k] = 1.5;
+        X[K+k] = 2;
+        X[2*K+k] = 3;
+      }
+    t0 = 0.0;
+  }
+
+  //! model evaluation for members k0,...,k1-1
+  void f (const Vector<T>& t, const Vector<N>& X, Vector<N>& F,
+          size_type k0, size_type k1) const
+  {
+    const N* x = &X[0];
+    const N* y = &X[K];
+    const N* z = &X[2*K];
+    for (size_type k=k0; k<k1; k++)
+      {
+        F[k] = sigma[k]*(y[k]-x[k]);
+        F[K+k] = x[k]*(rho[k]-z[k]) - y[k];
+        F[2*K+k] = x[k]*y[k] - beta[k]*z[k];
+      }
+  }
+
+private:
+  size_type K;
+  Vector<N> sigma, rho, beta;
 };
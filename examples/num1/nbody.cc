@@ -19,20 +19,24 @@ int main ()
   //typedef Restricted3Body<Number> Model; // Model type
   //typedef FigureEight<Number> Model; // Model type
   Model model;                         // instantiate model
+  typedef InstrumentedModel<Model> Counted; // counts and times f
+  Counted counted(model);
 
-  typedef RungeKutta4<Model> SubSolver;         // Solver type
-  SubSolver subsolver(model);                // instantiate solver
-  typedef RE<Model,SubSolver> Solver;         // Solver type
-  Solver solver(model,subsolver);                // instantiate solver
+  typedef RungeKutta4<Counted> SubSolver;         // Solver type
+  SubSolver subsolver(counted);                // instantiate solver
+  typedef RE<Counted,SubSolver> Solver;         // Solver type
+  Solver solver(counted,subsolver);                // instantiate solver
   solver.set_dt(1.0/512.0);             // set initial time step
   solver.set_TOL(1E-10);
 
-  std::vector<Number> times;           // store time values here
-  std::vector<Vector<Number> > states; // store states here
-  std::vector<Number> dts;             // store delta t
-  times.push_back(solver.get_time());  // initial time
-  states.push_back(solver.get_state()); // initial state
-  dts.push_back(solver.get_dt());      // initial dt
+  // stream time, state and dt of every step to a file
+  FileWriter<Number,Number> writer("nbody.dat",true);
+  //FileWriter<Number,Number> writer("twobody.dat");
+  //FileWriter<Number,Number> writer("restricted3BP.dat");
+  //FileWriter<Number,Number> writer("threebody.dat");
+  //FileWriter<Number,Number> writer("figureeight.dat");
+  solver.attach(writer);
+
   Number e_0(model.energy(solver.get_state()));
   std::cout << "initial energy: "  << std::scientific << std::showpoint 
 	    << std::setprecision(12) << e_0 << std::endl;
@@ -41,9 +45,6 @@ int main ()
   while (solver.get_time()<T-1e-8) // the time loop
     {
       solver.step();                  // advance model by one time step
-      times.push_back(solver.get_time()); // save time
-      states.push_back(solver.get_state()); // and state
-      dts.push_back(solver.get_dt());      // used dt
     }
 
   Number e_N(model.energy(solver.get_state()));
@@ -51,12 +52,12 @@ int main ()
 	    << std::setprecision(12) << e_N
 	    << " |e_0-e_N|/|e_0|: " << std::scientific << std::showpoint 
 	    << std::setprecision(12) << fabs(e_0-e_N)/fabs(e_0) << std::endl;
-  std::cout << "number of f evaluations: " << model.get_count() << std::endl;
-  gnuplot("nbody.dat",times,states,dts); // output model result
-  //gnuplot("twobody.dat",times,states); // output model result
-  //gnuplot("restricted3BP.dat",times,states); // output model result
-  //gnuplot("threebody.dat",times,states); // output model result
-  //gnuplot("figureeight.dat",times,states); // output model result
+  std::cout << "number of f evaluations: " << counted.get_statistics().fevals << std::endl;
+#if HDNUM_SOLVER_TIMING
+  // both times are taken with the same wall clock
+  std::cout << "time in f: " << std::fixed << std::setprecision(3) << counted.get_statistics().time_f
+            << " s of " << solver.get_statistics().time_total << " s" << std::endl;
+#endif
 
   return 0;
 }
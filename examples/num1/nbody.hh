@@ -31,6 +31,9 @@ public:
   /** \brief export number_type */
   typedef N number_type;
 
+  /** \brief export space dimension */
+  enum { dim = d };
+
   //! return number of componentes for the model
   std::size_t size () const
   {
@@ -66,6 +69,49 @@ public:
     ctr++;
   }
 
+  //! derivative of the position components, velocity components are set to zero
+  void f_position (const T& t, const hdnum::Vector<N>& x, hdnum::Vector<N>& result) const
+  {
+    for (size_type i=0; i<n; i++)
+      {
+        size_type I=2*d*i;
+        for (size_type k=0; k<d; k++)
+          {
+            result[I+k] = x[I+d+k];
+            result[I+d+k] = 0.0;
+          }
+      }
+  }
+
+  //! derivative of the velocity components, position components are set to zero
+  void f_velocity (const T& t, const hdnum::Vector<N>& x, hdnum::Vector<N>& result) const
+  {
+    for (size_type i=0; i<n; i++)
+      {
+        size_type I=2*d*i;
+        for (size_type k=0; k<d; k++)
+          {
+            result[I+k] = 0.0;
+            result[I+d+k] = 0.0;
+          }
+        for (size_type j=0; j<i; j++)
+          {
+            size_type J=2*d*j;
+            number_type r2(0.0);
+            for (size_type k=0; k<d; k++) r2 += (x[J+k]-x[I+k])*(x[J+k]-x[I+k]);
+            number_type r3(r2*sqrt(r2));
+            for (size_type k=0; k<d; k++)
+              {
+                result[I+d+k] += m[j]*(x[J+k]-x[I+k])/r3;
+                result[J+d+k] += m[i]*(x[I+k]-x[J+k])/r3;
+              }
+          }
+      }
+    for (size_type i=0; i<n; i++)
+      for (size_type k=0; k<d; k++) result[2*d*i+d+k] *= G;
+    ctr++;
+  }
+
   // set center of mass and its velocity to zero
   void normalize (hdnum::Vector<N>& x) const
   {
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <vector>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+#include "twobody.hh"
+#include "figureeight.hh"
+
+// maximum relative energy error over the time interval [0,T]
+template<class Model, class Solver>
+double energy_error (const Model& model, Solver& solver, double T)
+{
+  double e_0(model.energy(solver.get_state()));
+  double error(0.0);
+  while (solver.get_time()<T-1e-8)
+    {
+      if (solver.get_time()+solver.get_dt()>T)
+        solver.set_dt(T-solver.get_time());
+      solver.step();
+      error = std::max(error,fabs(model.energy(solver.get_state())-e_0)/fabs(e_0));
+    }
+  return error;
+}
+
+void print_line (const std::string& method, double parameter, std::size_t fevals, double error)
+{
+  std::cout << std::setw(16) << method
+            << std::scientific << std::showpoint << std::setprecision(2)
+            << std::setw(12) << parameter
+            << std::setw(12) << fevals
+            << std::setw(12) << error << std::endl;
+}
+
+// f evaluations versus energy error of symplectic methods and extrapolated RK4
+template<class Model>
+void compare (double T, double dt0)
+{
+  std::cout << std::setw(16) << "method" << std::setw(12) << "dt/TOL"
+            << std::setw(12) << "f evals" << std::setw(12) << "energy err" << std::endl;
+
+  const char* methods[] = {"Stoermer-Verlet","Forest-Ruth","Yoshida4","Yoshida6"};
+  for (int m=0; m<4; m++)
+    for (double dt=dt0; dt>dt0/20.0; dt*=0.5)
+      {
+        Model model;
+        InstrumentedModel<Model> counted(model);
+        Symplectic<InstrumentedModel<Model> > solver(counted,methods[m]);
+        solver.set_dt(dt);
+        double error = energy_error(model,solver,T);
+        print_line(methods[m],dt,counted.get_statistics().fevals,error);
+      }
+
+  for (double TOL=1e-4; TOL>1e-11; TOL*=0.01)
+    {
+      Model model;
+      typedef InstrumentedModel<Model> Counted;
+      Counted counted(model);
+      RungeKutta4<Counted> subsolver(counted);
+      RE<Counted,RungeKutta4<Counted> > solver(counted,subsolver);
+      solver.set_dt(dt0);
+      solver.set_TOL(TOL);
+      double error = energy_error(model,solver,T);
+      print_line("RE<RK4>",TOL,counted.get_statistics().fevals,error);
+    }
+}
+
+int main ()
+{
+  std::cout << "two body problem, T=100" << std::endl;
+  compare<TwoBody<double> >(100.0,1.0/64.0);
+
+  std::cout << std::endl << "figure eight, T=100" << std::endl;
+  compare<FigureEight<double> >(100.0,1.0/16.0);
+
+  return 0;
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+// wall clock time since start
+double seconds (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+/** @brief Allen-Cahn type reaction diffusion equation in 2D
+
+    u_t = Delta u + k u(1-u)(u-a) on the unit square with homogeneous
+    Dirichlet boundary conditions, five point stencil on a grid with
+    N x N interior points. Only f is provided.
+*/
+template<class T, class N=T>
+class ReactionDiffusion2D
+{
+public:
+  typedef std::size_t size_type;
+  typedef T time_type;
+  typedef N number_type;
+
+  ReactionDiffusion2D (size_type N_, N k_=100.0, N a_=0.25)
+    : n(N_), k(k_), a(a_)
+  {}
+
+  std::size_t size () const
+  {
+    return n*n;
+  }
+
+  void initialize (T& t0, Vector<N>& x0) const
+  {
+    t0 = 0;
+    N h = N(1.0)/N(n+1);
+    for (size_type j=0; j<n; j++)
+      for (size_type i=0; i<n; i++)
+        {
+          N x = (i+1)*h-0.5, y = (j+1)*h-0.5;
+          x0[j*n+i] = exp(-20.0*(x*x+y*y));
+        }
+  }
+
+  void f (const T& t, const Vector<N>& u, Vector<N>& result) const
+  {
+    N h2inv = N((n+1)*(n+1));
+    for (size_type j=0; j<n; j++)
+      for (size_type i=0; i<n; i++)
+        {
+          size_type l = j*n+i;
+          N left = (i>0) ? u[l-1] : N(0.0);
+          N right = (i<n-1) ? u[l+1] : N(0.0);
+          N down = (j>0) ? u[l-n] : N(0.0);
+          N up = (j<n-1) ? u[l+n] : N(0.0);
+          result[l] = h2inv*(left+right+down+up-N(4.0)*u[l]) + k*u[l]*(N(1.0)-u[l])*(u[l]-a);
+        }
+  }
+
+private:
+  size_type n;
+  N k, a;
+};
+
+// advance solver to time T with step dt and report the time needed
+template<class S>
+double run (S& solver, double dt, double T)
+{
+  solver.set_dt(dt);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  while (solver.get_time()<T-1e-10) solver.step();
+  return seconds(start);
+}
+
+int main ()
+{
+  double dt = 1e-3, T = 2e-2;
+  std::cout << "implicit Euler, dt=" << dt << ", T=" << T << std::endl;
+  std::cout << std::setw(8) << "n" << std::setw(32) << "solver" << std::setw(12) << "time [s]" << std::endl;
+
+  // small grid: compare with Newton and a banded finite difference Jacobian
+  {
+    std::size_t N = 16;
+    typedef ReactionDiffusion2D<double> Model;
+    Model model(N);
+    FiniteDifferenceModel<Model> fdmodel(model,bandedPattern(N*N,N,N));
+    Newton newton;
+    newton.set_reduction(1e-10);
+    IE<FiniteDifferenceModel<Model>,Newton> solver1(fdmodel,newton);
+    double time1 = run(solver1,dt,T);
+
+    NewtonKrylov nk;
+    nk.set_reduction(1e-10);
+    IE<Model,NewtonKrylov> solver2(model,nk);
+    double time2 = run(solver2,dt,T);
+
+    Vector<double> d(solver1.get_state());
+    d -= solver2.get_state();
+    std::cout << std::setw(8) << N*N << std::setw(32) << "Newton, dense Jacobian"
+              << std::scientific << std::setprecision(2) << std::setw(12) << time1 << std::endl;
+    std::cout << std::setw(8) << N*N << std::setw(32) << "NewtonKrylov"
+              << std::setw(12) << time2 << std::endl;
+    std::cout << "rms difference: " << d.two_norm()/std::sqrt(double(N*N)) << std::endl;
+  }
+
+  // large grids with the Jacobian-free solver only
+  std::size_t sizes[] = {100, 200};
+  for (int s=0; s<2; s++)
+    {
+      std::size_t N = sizes[s];
+      typedef ReactionDiffusion2D<double> Model;
+      Model model(N);
+      NewtonKrylov nk;
+      nk.set_reduction(1e-10);
+      IE<Model,NewtonKrylov> solver(model,nk);
+      double time = run(solver,dt,T);
+      std::cout << std::setw(8) << N*N << std::setw(32) << "NewtonKrylov"
+                << std::setw(12) << time << std::endl;
+
+      DIRK<Model,NewtonKrylov> dirk(model,nk,"Alexander");
+      time = run(dirk,dt,T);
+      std::cout << std::setw(8) << N*N << std::setw(32) << "NewtonKrylov, DIRK Alexander"
+                << std::setw(12) << time << std::endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,98 @@
+// build with -DHDNUM_PROFILING=1, otherwise the regions compile to nothing
+#include <iostream>
+#include <vector>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+/** @brief Semi-discrete reaction diffusion equation
+
+    u_t = u_xx + u(1-u)(u-a) on (0,1) with homogeneous Dirichlet
+    boundary conditions, central differences on n interior points.
+*/
+template<class T, class N=T>
+class ReactionDiffusion
+{
+public:
+  typedef std::size_t size_type;
+  typedef T time_type;
+  typedef N number_type;
+
+  ReactionDiffusion (size_type n_, N a_=0.3)
+    : n(n_), a(a_)
+  {}
+
+  std::size_t size () const
+  {
+    return n;
+  }
+
+  void initialize (T& t0, Vector<N>& x0) const
+  {
+    t0 = 0;
+    N h = N(1.0)/N(n+1);
+    for (size_type i=0; i<n; i++) x0[i] = sin(M_PI*(i+1)*h);
+  }
+
+  void f (const T& t, const Vector<N>& x, Vector<N>& result) const
+  {
+    HDNUM_PROFILE_REGION("model f");
+    N h2inv = N((n+1)*(n+1));
+    for (size_type i=0; i<n; i++)
+      {
+        N left = (i>0) ? x[i-1] : N(0.0);
+        N right = (i<n-1) ? x[i+1] : N(0.0);
+        result[i] = h2inv*(left-N(2.0)*x[i]+right) + x[i]*(N(1.0)-x[i])*(x[i]-a);
+      }
+  }
+
+  void f_x (const T& t, const Vector<N>& x, DenseMatrix<N>& result) const
+  {
+    HDNUM_PROFILE_REGION("model f_x");
+    N h2inv = N((n+1)*(n+1));
+    zero(result);
+    for (size_type i=0; i<n; i++)
+      {
+        if (i>0) result[i][i-1] = h2inv;
+        if (i<n-1) result[i][i+1] = h2inv;
+        result[i][i] = -N(2.0)*h2inv - N(3.0)*x[i]*x[i] + N(2.0)*(N(1.0)+a)*x[i] - a;
+      }
+  }
+
+private:
+  size_type n;
+  N a;
+};
+
+int main ()
+{
+  typedef ReactionDiffusion<double> Model;
+  Model model(200);
+  Newton newton;
+  newton.set_reduction(1e-10);
+
+  {
+    HDNUM_PROFILE_REGION("implicit Euler");
+    IE<Model,Newton> solver(model,newton);
+    solver.set_dt(1e-3);
+    for (int i=0; i<50; i++) solver.step();
+  }
+  {
+    HDNUM_PROFILE_REGION("DIRK Alexander");
+    DIRK<Model,Newton> solver(model,newton,"Alexander");
+    solver.set_dt(1e-3);
+    for (int i=0; i<50; i++) solver.step();
+  }
+  {
+    HDNUM_PROFILE_REGION("RKF45");
+    RKF45<Model> solver(model);
+    solver.set_TOL(1e-6);
+    while (solver.get_time()<1e-2) solver.step();
+  }
+
+  std::cout << "tree report" << std::endl;
+  Profiler::reportTree(std::cout);
+  std::cout << std::endl << "flat report" << std::endl;
+  Profiler::reportFlat(std::cout);
+  return 0;
+}
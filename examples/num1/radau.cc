@@ -0,0 +1,121 @@
+#include <iostream>
+#include <vector>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+#include "vanderpol.hh"
+#include "stiffproblem.hh"
+
+// Butcher tableau of the 3-stage Radau IIA method
+void radau_tableau (DenseMatrix<double>& A, Vector<double>& b, Vector<double>& c)
+{
+  const double sq6 = sqrt(6.0);
+  A[0][0] = (88.0-7.0*sq6)/360.0;
+  A[0][1] = (296.0-169.0*sq6)/1800.0;
+  A[0][2] = (-2.0+3.0*sq6)/225.0;
+  A[1][0] = (296.0+169.0*sq6)/1800.0;
+  A[1][1] = (88.0+7.0*sq6)/360.0;
+  A[1][2] = (-2.0-3.0*sq6)/225.0;
+  A[2][0] = (16.0-sq6)/36.0;
+  A[2][1] = (16.0+sq6)/36.0;
+  A[2][2] = 1.0/9.0;
+  for (int i=0; i<3; i++) b[i] = A[2][i];
+  c[0] = (4.0-sq6)/10.0;
+  c[1] = (4.0+sq6)/10.0;
+  c[2] = 1.0;
+}
+
+// advance solver to time T, the last step is shortened to hit T
+template<class S>
+void solve_to (S& solver, double T)
+{
+  while (solver.get_time()<T-1e-12)
+    {
+      if (solver.get_time()+solver.get_dt()>T)
+        solver.set_dt(T-solver.get_time());
+      solver.step();
+    }
+}
+
+void print_line (const std::string& method, double parameter, std::size_t fevals,
+                 double error, double time)
+{
+  std::cout << std::setw(10) << method
+            << std::scientific << std::showpoint << std::setprecision(2)
+            << std::setw(12) << parameter
+            << std::setw(12) << fevals
+            << std::setw(12) << error
+            << std::setw(12) << time << std::endl;
+}
+
+// compare adaptive RadauIIA with the generic RungeKutta class using the same tableau
+template<class Model>
+void compare (const Model& proto, double T, const Vector<double>& reference)
+{
+  std::cout << std::setw(10) << "method" << std::setw(12) << "TOL/dt"
+            << std::setw(12) << "f evals" << std::setw(12) << "error"
+            << std::setw(12) << "time [s]" << std::endl;
+
+  for (double TOL=1e-3; TOL>1e-9; TOL*=0.1)
+    {
+      Model model(proto);
+      std::size_t count = model.get_count();
+      RadauIIA<Model> solver(model);
+      solver.set_dt(1e-4);
+      solver.set_TOL(TOL);
+      Timer timer;
+      solve_to(solver,T);
+      double time = timer.elapsed();
+      Vector<double> e(solver.get_state());
+      e -= reference;
+      print_line("RadauIIA",TOL,model.get_count()-count,norm(e),time);
+    }
+
+  DenseMatrix<double> A(3,3);
+  Vector<double> b(3), c(3);
+  radau_tableau(A,b,c);
+  for (double dt=1e-2; dt>1e-4; dt*=0.5)
+    {
+      Model model(proto);
+      std::size_t count = model.get_count();
+      RungeKutta<Model> solver(model,A,b,c);
+      solver.set_dt(dt);
+      Timer timer;
+      solve_to(solver,T);
+      double time = timer.elapsed();
+      Vector<double> e(solver.get_state());
+      e -= reference;
+      print_line("RungeKutta",dt,model.get_count()-count,norm(e),time);
+    }
+}
+
+int main ()
+{
+  // linear stiff problem with eigenvalues -1 and -1000
+  {
+    typedef StiffProblem<double> Model;
+    Model model;
+    double T = 1.0;
+    Vector<double> reference;
+    model.exact_solution(T,reference);
+    std::cout << "stiff problem, T=" << T << std::endl;
+    compare(model,T,reference);
+  }
+
+  // van der Pol oscillator, reference solution with tight tolerance
+  {
+    typedef VanDerPolProblem<double> Model;
+    Model model(1e-3);
+    double T = 2.0;
+    RadauIIA<Model> solver(model);
+    solver.set_dt(1e-6);
+    solver.set_TOL(1e-12);
+    solve_to(solver,T);
+    Vector<double> reference(solver.get_state());
+    std::cout << std::endl << "van der Pol, eps=1e-3, T=" << T << std::endl;
+    compare(model,T,reference);
+  }
+
+  return 0;
+}
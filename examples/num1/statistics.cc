@@ -0,0 +1,64 @@
+// build with -DHDNUM_SOLVER_TIMING=1 to get the times per phase
+#include <iostream>
+#include <string>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+#include "vanderpol.hh"
+
+// integrate to T and print the statistics of the solver
+template<class S>
+void run (const std::string& name, S& solver, double T)
+{
+  while (solver.get_time()<T-1e-12)
+    {
+      if (solver.get_time()+solver.get_dt()>T) solver.set_dt(T-solver.get_time());
+      solver.step();
+    }
+  std::cout << std::setw(14) << std::left << name << std::right << " ";
+  solver.get_statistics().report(std::cout);
+}
+
+int main ()
+{
+  typedef VanDerPolProblem<double> Model;
+  Model model(0.1);
+  const double T = 2.0;
+
+  RungeKutta4<Model> rk4(model);
+  rk4.set_dt(1e-3);
+  run("RungeKutta4",rk4,T);
+
+  RKF45<Model> rkf45(model);
+  rkf45.set_TOL(1e-6);
+  rkf45.set_dt(1e-3);
+  run("RKF45",rkf45,T);
+
+  RungeKutta4<Model> rk4inner(model);
+  RE<Model,RungeKutta4<Model> > re(model,rk4inner);
+  re.set_TOL(1e-6);
+  re.set_dt(1e-3);
+  run("RE",re,T);
+
+  Newton newton;
+  newton.set_reduction(1e-10);
+  IE<Model,Newton> ie(model,newton);
+  ie.set_dt(1e-2);
+  run("IE",ie,T);
+
+  DIRK<Model,Newton> dirk(model,newton,"Alexander");
+  dirk.set_dt(1e-2);
+  run("DIRK",dirk,T);
+
+  RadauIIA<Model> radau(model);
+  radau.set_TOL(1e-6);
+  radau.set_dt(1e-3);
+  run("RadauIIA",radau,T);
+
+  // the Newton solver shared by IE and DIRK saw the work of both
+  std::cout << std::setw(14) << std::left << "Newton" << std::right << " ";
+  newton.get_statistics().report(std::cout);
+
+  return 0;
+}
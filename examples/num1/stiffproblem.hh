@@ -1,3 +1,8 @@
+/** @brief Linear stiff problem with eigenvalues -1 and -1000
+
+    \tparam T a type representing time values
+    \tparam N a type representing states and f-values
+*/
 template<class T, class N=T>
 class StiffProblem
 {
@@ -39,12 +44,20 @@ public:
   }
 
   //! model evaluation
-  void f_x (const T& t, const Vector<N>& x, Matrix<N>& result) const
+  void f_x (const T& t, const Vector<N>& x, DenseMatrix<N>& result) const
   {
     result[0][0] = 998.0;      result[0][1] = 1998.0;
     result[1][0] = -999.0;  result[1][1] = -1999.0;
   }
 
+  //! exact solution, eigenvalues are -1 and -1000
+  void exact_solution (const T& t, Vector<N>& result) const
+  {
+    result.resize(size());
+    result[0] = 6.0*exp(-t) - 5.0*exp(-1000.0*t);
+    result[1] = -3.0*exp(-t) + 5.0*exp(-1000.0*t);
+  }
+
   size_type get_count () const
   {
     return ctr;
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+// wall clock time since start
+double seconds (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+// the previous implementation of gnuplot() for comparison
+template<class T, class N>
+void gnuplot_iostream (const std::string& fname, const std::vector<T>& t, const std::vector<Vector<N> >& u)
+{
+  std::fstream f(fname.c_str(),std::ios::out);
+  for (typename std::vector<T>::size_type n=0; n<t.size(); n++)
+    {
+      f << std::scientific << std::showpoint
+        << std::setprecision(16) << t[n];
+      for (typename Vector<N>::size_type i=0; i<u[n].size(); i++)
+        f << " " << std::scientific << std::showpoint
+          << std::setprecision(u[n].precision()) << u[n][i];
+      f << std::endl;
+    }
+  f.close();
+}
+
+std::size_t filesize (const std::string& fname)
+{
+  MappedFile file(fname);
+  return file.size();
+}
+
+bool same_contents (const std::string& a, const std::string& b)
+{
+  MappedFile fa(a), fb(b);
+  return fa.size()==fb.size() && std::memcmp(fa.data(),fb.data(),fa.size())==0;
+}
+
+void print_line (const std::string& method, std::size_t bytes, double time)
+{
+  std::cout << std::setw(30) << method
+            << std::setw(12) << bytes
+            << std::fixed << std::setprecision(3) << std::setw(10) << time
+            << std::setprecision(1) << std::setw(10) << bytes/time*1e-6
+            << std::endl;
+}
+
+int main (int argc, char** argv)
+{
+  // number of steps and dimension of the trajectory
+  std::size_t steps = 1000000, d = 4;
+  if (argc>1) steps = atoi(argv[1]);
+
+  // a synthetic trajectory of a linear oscillator
+  std::vector<double> times(steps), dts(steps,1e-3);
+  std::vector<Vector<double> > states(steps,Vector<double>(d));
+  for (std::size_t n=0; n<steps; n++)
+    {
+      times[n] = n*1e-3;
+      for (std::size_t i=0; i<d; i++) states[n][i] = cos((i+1)*times[n])/(i+1);
+    }
+
+  std::cout << "steps: " << steps << ", dimension: " << d << std::endl;
+  std::cout << std::setw(30) << "method" << std::setw(12) << "bytes"
+            << std::setw(10) << "time [s]" << std::setw(10) << "MB/s" << std::endl;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  gnuplot_iostream("trajectory_old.dat",times,states);
+  double time = seconds(start);
+  print_line("iostream with endl",filesize("trajectory_old.dat"),time);
+
+  start = std::chrono::steady_clock::now();
+  gnuplot("trajectory.dat",times,states);
+  time = seconds(start);
+  print_line("gnuplot()",filesize("trajectory.dat"),time);
+  std::cout << "output identical: "
+            << (same_contents("trajectory_old.dat","trajectory.dat") ? "yes" : "NO") << std::endl;
+
+  start = std::chrono::steady_clock::now();
+  {
+    FileWriter<double,double> writer("trajectory_dt.dat",true);
+    for (std::size_t n=0; n<steps; n++) writer.observe(times[n],states[n],dts[n]);
+  }
+  time = seconds(start);
+  print_line("FileWriter with dt",filesize("trajectory_dt.dat"),time);
+
+  start = std::chrono::steady_clock::now();
+  writeTrajectory("trajectory.bin",times,states,dts);
+  time = seconds(start);
+  std::size_t bytes = filesize("trajectory.bin");
+  print_line("binary write",bytes,time);
+
+  start = std::chrono::steady_clock::now();
+  double sum(0.0);
+  {
+    TrajectoryReader<double,double> reader("trajectory.bin");
+    Vector<double> u;
+    for (std::size_t n=0; n<reader.size(); n++)
+      {
+        reader.state(n,u);
+        sum += reader.time(n)+u[0]+reader.dt(n);
+      }
+  }
+  time = seconds(start);
+  print_line("binary read (mmap)",bytes,time);
+
+  std::vector<double> t2;
+  std::vector<Vector<double> > u2;
+  readTrajectory("trajectory.bin",t2,u2);
+  bool equal = (t2==times);
+  for (std::size_t n=0; n<steps && equal; n++)
+    for (std::size_t i=0; i<d; i++) equal = equal && (u2[n][i]==states[n][i]);
+  std::cout << "binary round trip exact: " << (equal ? "yes" : "NO")
+            << " (checksum " << std::scientific << sum << ")" << std::endl;
+
+  std::remove("trajectory_old.dat");
+  std::remove("trajectory.dat");
+  std::remove("trajectory_dt.dat");
+  std::remove("trajectory.bin");
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+/** @brief Van der Pol oscillator in Lienard form
+
+    Stiff for small values of the parameter eps.
+
+    \tparam T a type representing time values
+    \tparam N a type representing states and f-values
+*/
+template<class T, class N=T>
+class VanDerPolProblem
+{
+public:
+  /** \brief export size_type */
+  typedef std::size_t size_type;
+
+  /** \brief export time_type */
+  typedef T time_type;
+
+  /** \brief export number_type */
+  typedef N number_type;
+
+  //! constructor stores parameter lambda
+  VanDerPolProblem () : eps(1.0E-3), ctr(0)
+  {
+  }
+
+  VanDerPolProblem (N eps_) : eps(eps_), ctr(0)
+  {
+  }
+
+  //! return number of componentes for the model
+  std::size_t size () const
+  {
+    return 2;
+  }
+
+  //! set initial state including time value
+  void initialize (T& t0, Vector<N>& x0) const
+  {
+    t0 = 0;
+    x0[0] = 1.0;
+    x0[1] = 2.0;
+  }
+
+  //! model evaluation
+  void f (const T& t, const Vector<N>& x, Vector<N>& result) const
+  {
+    result[0] = -x[1];
+    result[1] = (x[0]-x[1]*x[1]*x[1]/N(3.0)+x[1])/eps;
+    ctr++;
+  }
+
+  //! model evaluation
+  void f_x (const T& t, const Vector<N>& x, DenseMatrix<N>& result) const
+  {
+    result[0][0] = 0.0;      result[0][1] = -1.0;
+    result[1][0] = 1.0/eps;  result[1][1] = (1.0-x[1]*x[1])/eps;
+  }
+
+  size_type get_count () const
+  {
+    return ctr;
+  }
+
+private:
+  N eps;
+  mutable size_type ctr;
+};
+
+/** @brief ensemble of van der Pol oscillators with individual parameters eps
+
+    State layout as required by the ensemble solvers: component i of
+    member k is X[i*K+k].
+
+    \tparam T a type representing time values
+    \tparam N a type representing states and f-values
+*/
+template<class T, class N=T>
+class VanDerPolEnsemble
+{
+public:
+  /** \brief export size_type */
+  typedef std::size_t size_type;
+
+  /** \brief export time_type */
+  typedef T time_type;
+
+  /** \brief export number_type */
+  typedef N number_type;
+
+  //! constructor stores the parameters of all members
+  VanDerPolEnsemble (const Vector<N>& eps_) : eps(eps_)
+  {
+  }
+
+  //! return number of componentes of one member
+  std::size_t size () const
+  {
+    return 2;
+  }
+
+  //! return number of members
+  std::size_t members () const
+  {
+    return eps.size();
+  }
+
+  //! set initial state including time value
+  void initialize (T& t0, Vector<N>& X) const
+  {
+    const size_type K = eps.size();
+    t0 = 0;
+    for (size_type k=0; k<K; k++)
+      {
+        X[k] = 1.0;
+        X[K+k] = 2.0;
+      }
+  }
+
+  //! model evaluation for members k0,...,k1-1
+  void f (const Vector<T>& t, const Vector<N>& X, Vector<N>& F,
+          size_type k0, size_type k1) const
+  {
+    const size_type K = eps.size();
+    const N* x0 = &X[0];
+    const N* x1 = &X[K];
+    for (size_type k=k0; k<k1; k++)
+      {
+        F[k] = -x1[k];
+        F[K+k] = (x0[k]-x1[k]*x1[k]*x1[k]/N(3.0)+x1[k])/eps[k];
+      }
+  }
+
+private:
+  Vector<N> eps;
+};
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <vector>
+#include "hdnum.hh"
+
+using namespace hdnum;
+
+#include "vanderpol.hh"
+
+/*
+  Work-precision data of the integrators for the Van der Pol
+  oscillator. Plot e.g. with gnuplot:
+
+  set logscale xy
+  plot for [i=0:14] "workprecision.dat" index i using 3:5 with linespoints
+
+  plots the f evaluations against the error, using 3:4 the time.
+*/
+
+int main ()
+{
+  typedef VanDerPolProblem<double> Model;
+  Model model(0.1);
+  const double T = 2.0;
+
+  // reference solution with a tight tolerance
+  RadauIIA<Model> radau(model);
+  radau.set_TOL(1e-13);
+  radau.set_dt(1e-4);
+  while (radau.get_time()<T-1e-12)
+    {
+      if (radau.get_time()+radau.get_dt()>T) radau.set_dt(T-radau.get_time());
+      radau.step();
+    }
+  Vector<double> reference(radau.get_state());
+
+  WorkPrecision<Model> wp(model,T,reference);
+  wp.set_repetitions(3);
+  typedef WorkPrecision<Model>::model_type CM;
+
+  // explicit one-step methods with fixed time step
+  std::vector<double> dts;
+  for (double dt=2e-2; dt>2e-5; dt/=2.0) dts.push_back(dt);
+  EE<CM> ee(wp.model());
+  wp.sweep_dt("EE",ee,dts);
+  ModifiedEuler<CM> me(wp.model());
+  wp.sweep_dt("ModifiedEuler",me,dts);
+  Heun2<CM> heun2(wp.model());
+  wp.sweep_dt("Heun2",heun2,dts);
+  Heun3<CM> heun3(wp.model());
+  wp.sweep_dt("Heun3",heun3,dts);
+  Kutta3<CM> kutta3(wp.model());
+  wp.sweep_dt("Kutta3",kutta3,dts);
+  RungeKutta4<CM> rk4(wp.model());
+  wp.sweep_dt("RungeKutta4",rk4,dts);
+
+  // adaptive methods
+  std::vector<double> tols;
+  for (double tol=1e-2; tol>1e-11; tol/=10.0) tols.push_back(tol);
+  RKF45<CM> rkf45(wp.model());
+  wp.sweep_tol("RKF45",rkf45,tols);
+  RungeKutta4<CM> rk4inner(wp.model());
+  RE<CM,RungeKutta4<CM> > re(wp.model(),rk4inner);
+  wp.sweep_tol("RE RungeKutta4",re,tols);
+  RadauIIA<CM> radauIIA(wp.model());
+  wp.sweep_tol("RadauIIA",radauIIA,tols);
+
+  // implicit methods with fixed time step
+  std::vector<double> idts;
+  for (double dt=2e-2; dt>1e-4; dt/=2.0) idts.push_back(dt);
+  Newton newton;
+  newton.set_reduction(1e-12);
+  IE<CM,Newton> ie(wp.model(),newton);
+  wp.sweep_dt("IE",ie,idts);
+  const char* methods[] = {"Alexander","Crouzieux","Midpoint Rule","Fractional Step Theta"};
+  for (int m=0; m<4; m++)
+    {
+      DIRK<CM,Newton> dirk(wp.model(),newton,methods[m]);
+      wp.sweep_dt(std::string("DIRK ")+methods[m],dirk,idts);
+    }
+
+  // implicit Runge-Kutta method given by its tableau: 2 stage Gauss
+  DenseMatrix<double> A(2,2);
+  Vector<double> b(2), c(2);
+  A[0][0] = 0.25; A[0][1] = 0.25-sqrt(3.0)/6.0;
+  A[1][0] = 0.25+sqrt(3.0)/6.0; A[1][1] = 0.25;
+  b[0] = b[1] = 0.5;
+  c[0] = 0.5-sqrt(3.0)/6.0; c[1] = 0.5+sqrt(3.0)/6.0;
+  RungeKutta<CM> gauss(wp.model(),A,b,c);
+  wp.sweep_dt("RungeKutta Gauss 2",gauss,idts);
+
+  wp.write("workprecision.dat");
+  wp.write("workprecision.csv");
+
+  // cheapest method in f evaluations and in time for some accuracies
+  const std::vector<WorkPrecisionPoint>& points = wp.get_points();
+  double targets[] = {1e-3, 1e-6, 1e-9};
+  for (int k=0; k<3; k++)
+    {
+      int fbest = -1, tbest = -1;
+      for (std::size_t i=0; i<points.size(); i++)
+        if (points[i].error<=targets[k])
+          {
+            if (fbest<0 || points[i].fevals<points[fbest].fevals) fbest = i;
+            if (tbest<0 || points[i].seconds<points[tbest].seconds) tbest = i;
+          }
+      std::cout << "error <= " << std::scientific << std::setprecision(0) << targets[k] << ": ";
+      if (fbest<0)
+        std::cout << "not reached" << std::endl;
+      else
+        std::cout << "fewest f evaluations " << points[fbest].method << " (" << points[fbest].fevals
+                  << "), fastest " << points[tbest].method << " (" << std::setprecision(2)
+                  << points[tbest].seconds << " s)" << std::endl;
+    }
+
+  return 0;
+}
@@ -13,22 +13,39 @@
 #endif
 
 // general utilities
+#include "src/benchmark.hh"
 #include "src/densematrix.hh"
+#include "src/doubledouble.hh"
+#include "src/dual.hh"
 #include "src/exceptions.hh"
+#include "src/fileio.hh"
+#include "src/instrumentedmodel.hh"
 #include "src/opcounter.hh"
+#include "src/perfcounters.hh"
 #include "src/precision.hh"
+#include "src/profiler.hh"
+#include "src/roofline.hh"
+#include "src/sparsity.hh"
+#include "src/statistics.hh"
 #include "src/timer.hh"
 #include "src/vector.hh"
 
 // Num0
+#include "src/cholesky.hh"
 #include "src/lr.hh"
 #include "src/newton.hh"
 #include "src/qr.hh"
+#include "src/refinement.hh"
 
 // Num1
+#include "src/ensemble.hh"
+#include "src/observer.hh"
 #include "src/ode.hh"
 #include "src/pde.hh"
 #include "src/rungekutta.hh"
 #include "src/sgrid.hh"
+#include "src/symplectic.hh"
+#include "src/trajectory.hh"
+#include "src/workprecision.hh"
 
 #endif
@@ -0,0 +1,474 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_BENCHMARK_HH
+#define HDNUM_BENCHMARK_HH
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include "exceptions.hh"
+
+/** @file
+ *  @brief benchmark harness with warmup, repetitions and robust statistics
+ *
+ *  A Benchmark object runs named kernels for a sweep of problem sizes.
+ *  Each kernel is first run for a number of warmup samples, then for a
+ *  number of timed samples. Short kernels are repeated within a sample
+ *  until the sample lasts at least a minimum time, so the resolution
+ *  of the clock does not matter. The time per call is summarized by
+ *  median and median absolute deviation (MAD), which are insensitive
+ *  to the outliers caused by other processes. Results are written as
+ *  a table, as CSV or as JSON, so runs of different versions can be
+ *  compared by scripts.
+ */
+
+namespace hdnum {
+
+  //! keep the compiler from removing the computation of value
+  template<class T>
+  inline void do_not_optimize (const T& value)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+  }
+
+  //! statistics of one benchmark case, times are seconds per call
+  struct BenchmarkResult
+  {
+    std::string name;                 //!< name of the kernel
+    std::size_t size;                 //!< problem size
+    std::size_t samples;              //!< number of timed samples
+    std::size_t calls;                //!< calls of the kernel per sample
+    double median;                    //!< median time
+    double mad;                       //!< median absolute deviation
+    double min;                       //!< fastest sample
+    double mean;                      //!< arithmetic mean
+    double max;                       //!< slowest sample
+  };
+
+  /** @brief Runs and reports benchmark cases
+
+      \code
+      Benchmark bench(argc,argv);
+      std::vector<std::size_t> sizes = bench.sweep({100,1000,10000});
+      for (std::size_t k=0; k<sizes.size(); k++)
+        {
+          Vector<double> x(sizes[k],1.0), y(sizes[k],2.0);
+          bench.run("update",sizes[k],[&] () { x.update(0.5,y); });
+        }
+      bench.report();
+      \endcode
+
+      Command line options (all optional):
+      --warmup=N, --repetitions=N, --min-time=seconds,
+      --filter=substring, --sizes=n1,n2,..., --max-size=n,
+      --format=text|csv|json and --output=file.
+
+      Programs whose cases measure different quantities, e.g. vector
+      lengths and matrix dimensions, name a sweep family for each of
+      them. Every family gets its own options --family=n1,n2,... and
+      --max-family=n, and --sizes and --max-size are rejected, so a
+      size meant for one family never reaches another:
+
+      \code
+      Benchmark bench(argc,argv,{"vector","matrix"});
+      std::vector<std::size_t> n = bench.sweep("vector",{1000,100000});
+      std::vector<std::size_t> m = bench.sweep("matrix",{100,300});
+      \endcode
+  */
+  class Benchmark
+  {
+  public:
+    typedef std::size_t size_type;
+
+    //! default settings: 2 warmup samples, 11 timed samples of at least 1 ms
+    Benchmark ()
+      : warmup(2), repetitions(11), min_time(1e-3), max_size(0), format("text"), verbosity(1)
+    {}
+
+    //! settings given on the command line, with the sweep families used by the program
+    Benchmark (int argc, char** argv, const std::vector<std::string>& families_=std::vector<std::string>())
+      : warmup(2), repetitions(11), min_time(1e-3), max_size(0), format("text"), verbosity(1),
+        families(families_)
+    {
+      for (int i=1; i<argc; i++)
+        {
+          std::string arg(argv[i]);
+          std::string::size_type eq = arg.find('=');
+          std::string key = arg.substr(0,eq);
+          std::string value = (eq==std::string::npos) ? "" : arg.substr(eq+1);
+          if (!families.empty() && (key=="--sizes" || key=="--max-size"))
+            HDNUM_ERROR("Benchmark: " << key << " is ambiguous, use the option of a sweep family:"
+                        << family_options());
+          if (key.compare(0,6,"--max-")==0 && has_family(key.substr(6)))
+            family_max[key.substr(6)] = std::atoi(value.c_str());
+          else if (key.compare(0,2,"--")==0 && has_family(key.substr(2)))
+            family_sizes[key.substr(2)] = parse_sizes(value);
+          else if (key=="--warmup")
+            set_warmup(std::atoi(value.c_str()));
+          else if (key=="--repetitions")
+            set_repetitions(std::atoi(value.c_str()));
+          else if (key=="--min-time")
+            set_min_time(std::atof(value.c_str()));
+          else if (key=="--filter")
+            set_filter(value);
+          else if (key=="--max-size")
+            set_max_size(std::atoi(value.c_str()));
+          else if (key=="--format")
+            set_format(value);
+          else if (key=="--output")
+            set_output(value);
+          else if (key=="--sizes")
+            sizes = parse_sizes(value);
+          else if (key=="--quiet")
+            verbosity = 0;
+          else if (key=="--help")
+            {
+              std::cout << "options: --warmup=N --repetitions=N --min-time=seconds --filter=substring"
+                        << std::endl << "        ";
+              if (families.empty())
+                std::cout << " --sizes=n1,n2,... --max-size=n";
+              else
+                std::cout << family_options() << std::endl << "        ";
+              std::cout << " --format=text|csv|json --output=file --quiet" << std::endl;
+              std::exit(0);
+            }
+          else
+            HDNUM_ERROR("Benchmark: unknown option " << arg);
+        }
+    }
+
+    //! number of untimed samples before the measurement
+    void set_warmup (size_type n)
+    {
+      warmup = n;
+    }
+
+    //! number of timed samples
+    void set_repetitions (size_type n)
+    {
+      if (n==0) HDNUM_ERROR("Benchmark: need at least one repetition");
+      repetitions = n;
+    }
+
+    //! minimum duration of a sample in seconds
+    void set_min_time (double t)
+    {
+      min_time = t;
+    }
+
+    //! run only cases whose name contains the given string
+    void set_filter (const std::string& f)
+    {
+      filter = f;
+    }
+
+    //! skip problem sizes larger than n (0 means no limit)
+    void set_max_size (size_type n)
+    {
+      max_size = n;
+    }
+
+    //! output format: "text", "csv" or "json"
+    void set_format (const std::string& f)
+    {
+      if (f!="text" && f!="csv" && f!="json")
+        HDNUM_ERROR("Benchmark: unknown format " << f);
+      format = f;
+    }
+
+    //! write the report to a file instead of std::cout
+    void set_output (const std::string& filename)
+    {
+      output = filename;
+    }
+
+    //! 0: silent, 1: progress of each case on std::cerr
+    void set_verbosity (size_type v)
+    {
+      verbosity = v;
+    }
+
+    //! the problem sizes to run: the ones given by --sizes or the defaults, limited by --max-size
+    std::vector<size_type> sweep (const std::vector<size_type>& defaults) const
+    {
+      const std::vector<size_type>& all = sizes.empty() ? defaults : sizes;
+      std::vector<size_type> s;
+      for (size_type k=0; k<all.size(); k++)
+        if (max_size==0 || all[k]<=max_size) s.push_back(all[k]);
+      return s;
+    }
+
+    //! the problem sizes of a sweep family: the ones given by --family or the defaults, limited by --max-family
+    std::vector<size_type> sweep (const std::string& family, const std::vector<size_type>& defaults) const
+    {
+      if (!has_family(family))
+        HDNUM_ERROR("Benchmark: sweep family " << family << " was not passed to the constructor");
+      std::map<std::string,std::vector<size_type> >::const_iterator given = family_sizes.find(family);
+      const std::vector<size_type>& all = (given==family_sizes.end()) ? defaults : given->second;
+      std::map<std::string,size_type>::const_iterator limit = family_max.find(family);
+      std::vector<size_type> s;
+      for (size_type k=0; k<all.size(); k++)
+        if (limit==family_max.end() || limit->second==0 || all[k]<=limit->second) s.push_back(all[k]);
+      return s;
+    }
+
+    //! true if the case passes the filter
+    bool selected (const std::string& name) const
+    {
+      return filter.empty() || name.find(filter)!=std::string::npos;
+    }
+
+    /** @brief measure the time of kernel()
+
+        The kernel must produce the same amount of work in every call.
+        Use do_not_optimize on its results if they are not used
+        otherwise.
+    */
+    template<class K>
+    void run (const std::string& name, size_type n, K kernel)
+    {
+      if (!selected(name)) return;
+      // calibrate the number of calls per sample during the warmup
+      size_type calls = 1;
+      for (size_type w=0; w<std::max(warmup,size_type(1)); w++)
+        {
+          double t = time(kernel,calls);
+          while (t<min_time && calls<(size_type(1)<<30))
+            {
+              double factor = (t>0.0) ? std::min(10.0,1.2*min_time/t) : 10.0;
+              calls = std::max(calls+1,size_type(calls*factor));
+              t = time(kernel,calls);
+            }
+        }
+      std::vector<double> samples(repetitions);
+      for (size_type r=0; r<repetitions; r++) samples[r] = time(kernel,calls)/calls;
+      store(name,n,calls,samples);
+    }
+
+    /** @brief measure the time of kernel(), calling setup() untimed before each call
+
+        Used for kernels that overwrite their input, e.g. LR
+        decompositions. Every sample consists of one call.
+    */
+    template<class S, class K>
+    void run (const std::string& name, size_type n, S setup, K kernel)
+    {
+      if (!selected(name)) return;
+      for (size_type w=0; w<warmup; w++)
+        {
+          setup();
+          time(kernel,1);
+        }
+      std::vector<double> samples(repetitions);
+      for (size_type r=0; r<repetitions; r++)
+        {
+          setup();
+          samples[r] = time(kernel,1);
+        }
+      store(name,n,1,samples);
+    }
+
+    //! results of all cases run so far
+    const std::vector<BenchmarkResult>& results () const
+    {
+      return data;
+    }
+
+    //! write the results in the selected format to the selected output
+    void report () const
+    {
+      if (output.empty())
+        report(std::cout);
+      else
+        {
+          std::ofstream os(output.c_str());
+          if (!os) HDNUM_ERROR("Benchmark: could not open " << output);
+          report(os);
+        }
+    }
+
+    //! write the results in the selected format to a stream
+    template<typename Stream>
+    void report (Stream& os) const
+    {
+      if (format=="csv")
+        reportCSV(os);
+      else if (format=="json")
+        reportJSON(os);
+      else
+        reportText(os);
+    }
+
+    //! table for the terminal
+    template<typename Stream>
+    void reportText (Stream& os) const
+    {
+      os << std::setw(40) << std::left << "case" << std::right << std::setw(10) << "size"
+         << std::setw(10) << "calls" << std::setw(12) << "median [s]" << std::setw(10) << "MAD [%]"
+         << std::setw(12) << "min [s]" << std::setw(12) << "mean [s]" << std::endl;
+      for (size_type i=0; i<data.size(); i++)
+        {
+          const BenchmarkResult& r = data[i];
+          os << std::setw(40) << std::left << r.name << std::right << std::setw(10) << r.size
+             << std::setw(10) << r.calls
+             << std::scientific << std::setprecision(3) << std::setw(12) << r.median
+             << std::fixed << std::setprecision(1) << std::setw(10) << 100.0*r.mad/r.median
+             << std::scientific << std::setprecision(3) << std::setw(12) << r.min
+             << std::setw(12) << r.mean << std::endl;
+        }
+    }
+
+    //! one line per case, times in seconds
+    template<typename Stream>
+    void reportCSV (Stream& os) const
+    {
+      os << "name,size,samples,calls,median,mad,min,mean,max" << std::endl;
+      for (size_type i=0; i<data.size(); i++)
+        {
+          const BenchmarkResult& r = data[i];
+          os << "\"" << r.name << "\"," << r.size << "," << r.samples << "," << r.calls
+             << std::scientific << std::setprecision(6)
+             << "," << r.median << "," << r.mad << "," << r.min << "," << r.mean << "," << r.max << std::endl;
+        }
+    }
+
+    //! settings and results, times in seconds
+    template<typename Stream>
+    void reportJSON (Stream& os) const
+    {
+      char date[32];
+      std::time_t now = std::time(0);
+      std::strftime(date,sizeof(date),"%Y-%m-%dT%H:%M:%SZ",std::gmtime(&now));
+      os << "{" << std::endl
+         << "  \"date\": \"" << date << "\"," << std::endl
+         << "  \"compiler\": \"" << escape(compiler()) << "\"," << std::endl
+         << "  \"warmup\": " << warmup << "," << std::endl
+         << "  \"repetitions\": " << repetitions << "," << std::endl
+         << "  \"min_time\": " << min_time << "," << std::endl
+         << "  \"results\": [";
+      for (size_type i=0; i<data.size(); i++)
+        {
+          const BenchmarkResult& r = data[i];
+          os << (i>0 ? "," : "") << std::endl
+             << "    {\"name\": \"" << escape(r.name) << "\", \"size\": " << r.size
+             << ", \"samples\": " << r.samples << ", \"calls\": " << r.calls
+             << std::scientific << std::setprecision(6)
+             << ", \"median\": " << r.median << ", \"mad\": " << r.mad << ", \"min\": " << r.min
+             << ", \"mean\": " << r.mean << ", \"max\": " << r.max << "}";
+        }
+      os << std::endl << "  ]" << std::endl << "}" << std::endl;
+    }
+
+  private:
+    // time of calls calls of the kernel in seconds
+    template<class K>
+    static double time (K& kernel, size_type calls)
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for (size_type c=0; c<calls; c++) kernel();
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+      return elapsed.count();
+    }
+
+    static std::vector<size_type> parse_sizes (const std::string& value)
+    {
+      std::vector<size_type> s;
+      std::istringstream is(value);
+      std::string item;
+      while (std::getline(is,item,','))
+        if (!item.empty()) s.push_back(std::atoi(item.c_str()));
+      return s;
+    }
+
+    bool has_family (const std::string& family) const
+    {
+      return std::find(families.begin(),families.end(),family)!=families.end();
+    }
+
+    std::string family_options () const
+    {
+      std::string o;
+      for (size_type k=0; k<families.size(); k++)
+        o += " --"+families[k]+"=n1,... --max-"+families[k]+"=n";
+      return o;
+    }
+
+    static double median (std::vector<double> v)
+    {
+      std::sort(v.begin(),v.end());
+      size_type m = v.size()/2;
+      return (v.size()%2==1) ? v[m] : 0.5*(v[m-1]+v[m]);
+    }
+
+    void store (const std::string& name, size_type n, size_type calls, const std::vector<double>& samples)
+    {
+      BenchmarkResult r;
+      r.name = name;
+      r.size = n;
+      r.samples = samples.size();
+      r.calls = calls;
+      r.median = median(samples);
+      std::vector<double> deviation(samples.size());
+      for (size_type i=0; i<samples.size(); i++) deviation[i] = std::abs(samples[i]-r.median);
+      r.mad = median(deviation);
+      r.min = *std::min_element(samples.begin(),samples.end());
+      r.max = *std::max_element(samples.begin(),samples.end());
+      r.mean = 0.0;
+      for (size_type i=0; i<samples.size(); i++) r.mean += samples[i];
+      r.mean /= samples.size();
+      data.push_back(r);
+      if (verbosity>0)
+        std::cerr << name << " n=" << n << ": " << std::scientific << std::setprecision(3)
+                  << r.median << " s" << std::endl;
+    }
+
+    static std::string compiler ()
+    {
+#if defined(__clang__)
+      return std::string("clang ")+__clang_version__;
+#elif defined(__GNUC__)
+      return std::string("gcc ")+__VERSION__;
+#else
+      return "unknown";
+#endif
+    }
+
+    static std::string escape (const std::string& s)
+    {
+      std::string e;
+      for (size_type i=0; i<s.size(); i++)
+        {
+          if (s[i]=='"' || s[i]=='\\') e += '\\';
+          e += s[i];
+        }
+      return e;
+    }
+
+    size_type warmup, repetitions;
+    double min_time;
+    size_type max_size;
+    std::string filter, format, output;
+    std::vector<size_type> sizes;
+    size_type verbosity;
+    std::vector<std::string> families;
+    std::map<std::string,std::vector<size_type> > family_sizes;
+    std::map<std::string,size_type> family_max;
+    std::vector<BenchmarkResult> data;
+  };
+
+} // namespace hdnum
+
+#endif
@@ -0,0 +1,287 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_CHOLESKY_HH
+#define HDNUM_CHOLESKY_HH
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "vector.hh"
+#include "densematrix.hh"
+#include "exceptions.hh"
+#include "lr.hh"
+
+/** @file
+ *  @brief Cholesky and LDL^T decompositions of symmetric matrices
+ *
+ *  Only the lower triangle of the matrix is read and overwritten, the
+ *  upper triangle is left unchanged. Compared to lr_fullpivot half of
+ *  the operations are needed and no pivot search is done.
+ */
+
+namespace hdnum {
+
+  /** @brief Blocked Cholesky decomposition A = L L^T
+
+      A must be symmetric positive definite. L is stored in the lower
+      triangle of A. The columns are processed in blocks of nb, the
+      trailing matrix is updated with dot products of row segments of
+      length nb, which fits the row-major storage.
+
+      \param[in,out] A  the matrix, afterwards L in the lower triangle
+      \param[in]     nb block size
+  */
+  template<class T>
+  void cholesky (DenseMatrix<T>& A, std::size_t nb=64)
+  {
+    if (A.rowsize()!=A.colsize() || A.rowsize()==0)
+      HDNUM_ERROR("need square and nonempty matrix");
+    using std::sqrt;
+    if (nb==0) nb = 1;
+    std::size_t n = A.rowsize();
+    for (std::size_t k0=0; k0<n; k0+=nb)
+      {
+        std::size_t k1 = std::min(n,k0+nb);
+
+        // diagonal block
+        for (std::size_t i=k0; i<k1; i++)
+          for (std::size_t j=k0; j<=i; j++)
+            {
+              T s(A[i][j]);
+              for (std::size_t l=k0; l<j; l++) s -= A[i][l]*A[j][l];
+              if (j<i)
+                A[i][j] = s/A[j][j];
+              else
+                {
+                  if (!(s>T(0.0))) HDNUM_ERROR("matrix is not positive definite");
+                  A[i][i] = sqrt(s);
+                }
+            }
+
+        // panel below the diagonal block
+        for (std::size_t i=k1; i<n; i++)
+          for (std::size_t j=k0; j<k1; j++)
+            {
+              T s(A[i][j]);
+              for (std::size_t l=k0; l<j; l++) s -= A[i][l]*A[j][l];
+              A[i][j] = s/A[j][j];
+            }
+
+        // trailing matrix
+        for (std::size_t i=k1; i<n; i++)
+          for (std::size_t j=k1; j<=i; j++)
+            {
+              T s(0.0);
+              for (std::size_t l=k0; l<k1; l++) s += A[i][l]*A[j][l];
+              A[i][j] -= s;
+            }
+      }
+  }
+
+  //! solve A x = b with L from cholesky
+  template<class T>
+  void cholesky_solve (const DenseMatrix<T>& L, Vector<T>& x, const Vector<T>& b)
+  {
+    if (L.rowsize()!=b.size())
+      HDNUM_ERROR("right hand side incompatible with matrix");
+    std::size_t n = L.rowsize();
+    x = b;
+    for (std::size_t i=0; i<n; i++)                     // L y = b
+      {
+        T rhs(x[i]);
+        for (std::size_t j=0; j<i; j++) rhs -= L[i][j]*x[j];
+        x[i] = rhs/L[i][i];
+      }
+    for (std::size_t i=n; i-->0; )                      // L^T x = y, column by column
+      {
+        x[i] /= L[i][i];
+        for (std::size_t j=0; j<i; j++) x[j] -= L[i][j]*x[i];
+      }
+  }
+
+  /** @brief LDL^T decomposition with symmetric pivoting, P A P^T = L D L^T
+
+      In step k the largest remaining diagonal element (in absolute
+      value) is chosen as pivot and rows and columns k and p[k] are
+      exchanged. L has unit diagonal and is stored in the strict lower
+      triangle, D on the diagonal. Positive definite matrices are
+      handled like in Cholesky without square roots, indefinite ones
+      as long as no zero pivot remains (there are no 2x2 pivots).
+
+      \param[in,out] A the matrix, afterwards L and D
+      \param[out]    p the symmetric permutations, applied by permute_forward
+  */
+  template<class T>
+  void ldlt (DenseMatrix<T>& A, Vector<std::size_t>& p)
+  {
+    if (A.rowsize()!=A.colsize() || A.rowsize()==0)
+      HDNUM_ERROR("need square and nonempty matrix");
+    if (A.rowsize()!=p.size())
+      HDNUM_ERROR("permutation vector incompatible with matrix");
+    std::size_t n = A.rowsize();
+    std::vector<T> c(n);
+    for (std::size_t k=0; k<n; k++)
+      {
+        // pivot search on the diagonal
+        std::size_t r = k;
+        for (std::size_t i=k+1; i<n; i++)
+          if (abs(A[i][i])>abs(A[r][r])) r = i;
+        p[k] = r;
+
+        // exchange rows and columns k and r in the lower triangle
+        if (r>k)
+          {
+            for (std::size_t j=0; j<k; j++) std::swap(A[k][j],A[r][j]);
+            std::swap(A[k][k],A[r][r]);
+            for (std::size_t j=k+1; j<r; j++) std::swap(A[j][k],A[r][j]);
+            for (std::size_t i=r+1; i<n; i++) std::swap(A[i][k],A[i][r]);
+          }
+        if (A[k][k]==T(0.0)) HDNUM_ERROR("matrix is singular");
+
+        // eliminate column k
+        T dinv = T(1.0)/A[k][k];
+        for (std::size_t i=k+1; i<n; i++)
+          {
+            c[i] = A[i][k];
+            A[i][k] *= dinv;
+          }
+        for (std::size_t i=k+1; i<n; i++)
+          {
+            T lik(A[i][k]);
+            for (std::size_t j=k+1; j<=i; j++) A[i][j] -= lik*c[j];
+          }
+      }
+  }
+
+  //! solve A x = b with L, D and p from ldlt
+  template<class T>
+  void ldlt_solve (const DenseMatrix<T>& A, const Vector<std::size_t>& p, Vector<T>& x, const Vector<T>& b)
+  {
+    if (A.rowsize()!=b.size())
+      HDNUM_ERROR("right hand side incompatible with matrix");
+    std::size_t n = A.rowsize();
+    x = b;
+    permute_forward(p,x);
+    for (std::size_t i=0; i<n; i++)                     // L y = P b
+      for (std::size_t j=0; j<i; j++) x[i] -= A[i][j]*x[j];
+    for (std::size_t i=0; i<n; i++) x[i] /= A[i][i];    // D z = y
+    for (std::size_t i=n; i-->0; )                      // L^T w = z
+      for (std::size_t j=0; j<i; j++) x[j] -= A[i][j]*x[i];
+    permute_backward(p,x);                              // x = P^T w
+  }
+
+  /** @brief Envelope of the lower triangle of a symmetric matrix
+
+      first[i] is the column of the first nonzero entry in row i (at
+      most i). The Cholesky factor has no fill-in outside of this
+      envelope (skyline), for band matrices it is the band. The scan
+      of the dense storage takes O(n^2) operations, also for band
+      matrices.
+  */
+  template<class T>
+  void envelope (const DenseMatrix<T>& A, std::vector<std::size_t>& first)
+  {
+    std::size_t n = A.rowsize();
+    first.resize(n);
+    for (std::size_t i=0; i<n; i++)
+      {
+        first[i] = i;
+        for (std::size_t j=0; j<i; j++)
+          if (A[i][j]!=T(0.0))
+            {
+              first[i] = j;
+              break;
+            }
+      }
+  }
+
+  /** @brief Cholesky decomposition within the envelope of A
+
+      Only entries inside the envelope are read and written, so the
+      decomposition of a matrix with bandwidth w takes O(n w^2)
+      operations and the solve O(n w). Tridiagonal FEM matrices are
+      factorized in O(n), the envelope is given and not computed here.
+
+      \param[in,out] A     the matrix, afterwards L in the envelope
+      \param[in]     first the envelope computed by envelope()
+  */
+  template<class T>
+  void cholesky_skyline (DenseMatrix<T>& A, const std::vector<std::size_t>& first)
+  {
+    if (A.rowsize()!=A.colsize() || A.rowsize()==0)
+      HDNUM_ERROR("need square and nonempty matrix");
+    if (A.rowsize()!=first.size())
+      HDNUM_ERROR("envelope incompatible with matrix");
+    using std::sqrt;
+    std::size_t n = A.rowsize();
+    for (std::size_t i=0; i<n; i++)
+      for (std::size_t j=first[i]; j<=i; j++)
+        {
+          T s(A[i][j]);
+          for (std::size_t l=std::max(first[i],first[j]); l<j; l++) s -= A[i][l]*A[j][l];
+          if (j<i)
+            A[i][j] = s/A[j][j];
+          else
+            {
+              if (!(s>T(0.0))) HDNUM_ERROR("matrix is not positive definite");
+              A[i][i] = sqrt(s);
+            }
+        }
+  }
+
+  //! solve A x = b with L from cholesky_skyline
+  template<class T>
+  void cholesky_skyline_solve (const DenseMatrix<T>& L, const std::vector<std::size_t>& first,
+                               Vector<T>& x, const Vector<T>& b)
+  {
+    if (L.rowsize()!=b.size())
+      HDNUM_ERROR("right hand side incompatible with matrix");
+    std::size_t n = L.rowsize();
+    x = b;
+    for (std::size_t i=0; i<n; i++)
+      {
+        T rhs(x[i]);
+        for (std::size_t j=first[i]; j<i; j++) rhs -= L[i][j]*x[j];
+        x[i] = rhs/L[i][i];
+      }
+    for (std::size_t i=n; i-->0; )
+      {
+        x[i] /= L[i][i];
+        for (std::size_t j=first[i]; j<i; j++) x[j] -= L[i][j]*x[i];
+      }
+  }
+
+  //! a complete solver for symmetric positive definite A; Note A is modified!
+  template<class T>
+  void linsolve_cholesky (DenseMatrix<T>& A, Vector<T>& x, const Vector<T>& b)
+  {
+    cholesky(A);
+    cholesky_solve(A,x,b);
+  }
+
+  //! a complete solver for symmetric A; Note A is modified!
+  template<class T>
+  void linsolve_ldlt (DenseMatrix<T>& A, Vector<T>& x, const Vector<T>& b)
+  {
+    Vector<std::size_t> p(A.rowsize());
+    ldlt(A,p);
+    ldlt_solve(A,p,x,b);
+  }
+
+  /** @brief a complete solver for symmetric positive definite band or skyline A; Note A is modified!
+
+      The cost is O(n^2) for envelope() on the dense storage plus
+      O(n w^2) for the factorization with bandwidth w, so for small w
+      the scan dominates. To avoid it, compute the envelope once and
+      call cholesky_skyline and cholesky_skyline_solve directly.
+  */
+  template<class T>
+  void linsolve_skyline (DenseMatrix<T>& A, Vector<T>& x, const Vector<T>& b)
+  {
+    std::vector<std::size_t> first;
+    envelope(A,first);
+    cholesky_skyline(A,first);
+    cholesky_skyline_solve(A,first,x,b);
+  }
+
+}
+#endif
@@ -104,6 +104,19 @@ namespace hdnum {
         }
     }
     
+    /*!
+      \brief change the size of the matrix
+
+      The entries keep their position in the row-wise storage, so
+      adding rows keeps the existing rows, new entries are set to
+      def_val.
+    */
+    void resize( const std::size_t _rows, const std::size_t _cols, const REAL def_val=0 ){
+      m_data.resize( _rows*_cols, def_val );
+      m_rows = _rows;
+      m_cols = _cols;
+    }
+
     void addNewRow( const hdnum::Vector<REAL> & rowvector ){
       m_rows++;
       m_cols = rowvector.size();
@@ -605,7 +618,7 @@ namespace hdnum {
         HDNUM_ERROR("mv: size of A and x do not match");
       for (std::size_t i=0; i<rowsize(); ++i)
         {
-          y[i] = 0;
+          y[i] = V(0);
 		  for (std::size_t j=0; j<colsize(); ++j)
             y[i] += (*this)(i,j)*x[j];
         }
@@ -797,7 +810,7 @@ namespace hdnum {
       for (std::size_t i=0; i<rowsize(); i++)
         for (std::size_t j=0; j<colsize(); j++)
           {
-            (*this)(i,j) = 0;
+            (*this)(i,j) = REAL(0);
             for (std::size_t k=0; k<A.colsize(); k++)
               (*this)(i,j) += A(i,k)*B(k,j);
           }
@@ -1517,70 +1530,6 @@ namespace hdnum {
 
 
 
-  /*!
-    \relates DenseMatrix
-    \brief Read matrix from a text file
-
-    \param[in] filename name of the text file
-    \param[in,out] A reference to a DenseMatrix
-
-	\b Example:
-	\code
-    hdnum::DenseMatrix<number> L;
-    readMatrixFromFile("matrixL.dat", L );
-    std::cout << "L=" << L << std::endl;
-	\endcode
-
-	\b Output:
-	\verbatim
-    Contents of "matrixL.dat":
-    1.000e+00  0.000e+00  0.000e+00
-    2.000e+00  1.000e+00  0.000e+00
-    3.000e+00  2.000e+00  1.000e+00
-
-    would give:
-    L=
-    0          1          2
-    0   1.000e+00  0.000e+00  0.000e+00
-    1   2.000e+00  1.000e+00  0.000e+00
-    2   3.000e+00  2.000e+00  1.000e+00
-	\endverbatim
-  */
-  template<typename REAL>
-  inline void readMatrixFromFile (const std::string& filename, DenseMatrix<REAL> &A)
-  {
-    std::string buffer;
-    std::ifstream fin( filename.c_str() );
-    std::size_t i=0;
-    std::size_t j=0;
-    if( fin.is_open() ){
-      while( std::getline( fin, buffer ) ){
-        std::istringstream iss(buffer);
-        hdnum::Vector<REAL> rowvector;
-        while( iss ){
-          std::string sub;
-          iss >> sub;
-          //std::cout << " sub = " << sub.c_str() << ": ";
-          if( sub.length()>0 ){
-            REAL a = atof(sub.c_str());
-            //std::cout << std::fixed << std::setw(10) << std::setprecision(5) << a;
-            rowvector.push_back(a);
-          }
-          j++;
-        }
-        if( rowvector.size()>0 ){
-          A.addNewRow( rowvector );
-          i++;
-          //std::cout << std::endl;
-        }
-      }
-      fin.close();
-    }
-    else{
-      HDNUM_ERROR("Could not open file!");
-    }
-  }
-
 }  // namespace hdnum
 
 #endif  // DENSEMATRIX_HH
@@ -0,0 +1,608 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_DOUBLEDOUBLE_HH
+#define HDNUM_DOUBLEDOUBLE_HH
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <iostream>
+
+/** @file
+ *  @brief double-double arithmetic with about 32 significant digits
+ *
+ *  A number is represented as the unevaluated sum hi + lo of two
+ *  doubles with |lo| <= ulp(hi)/2, which gives 106 bits of mantissa
+ *  but only the exponent range of double. The operations are built
+ *  from error-free transformations of double arithmetic, so they run
+ *  in registers without memory allocation and are typically 10 to 20
+ *  times slower than double, much faster than mpf_class. Compile
+ *  without -ffast-math, which breaks the error-free transformations;
+ *  with -mfma the products use fused multiply-add.
+ */
+
+namespace hdnum {
+  namespace dd {
+
+    namespace detail {
+
+      // s + err = a + b exactly, assumes |a| >= |b|
+      inline double quick_two_sum (double a, double b, double& err)
+      {
+        double s = a+b;
+        err = b-(s-a);
+        return s;
+      }
+
+      // s + err = a + b exactly
+      inline double two_sum (double a, double b, double& err)
+      {
+        double s = a+b;
+        double bb = s-a;
+        err = (a-(s-bb))+(b-bb);
+        return s;
+      }
+
+      // p + err = a * b exactly
+      inline double two_prod (double a, double b, double& err)
+      {
+        double p = a*b;
+#ifdef FP_FAST_FMA
+        err = std::fma(a,b,-p);
+#else
+        // Dekker's product with Veltkamp's splitting into 26 bit halves
+        const double splitter = 134217729.0;  // 2^27+1
+        double t = splitter*a;
+        double ahi = t-(t-a), alo = a-ahi;
+        t = splitter*b;
+        double bhi = t-(t-b), blo = b-bhi;
+        err = ((ahi*bhi-p)+ahi*blo+alo*bhi)+alo*blo;
+#endif
+        return p;
+      }
+
+    } // namespace detail
+
+    //! double-double number hi + lo
+    class DoubleDouble
+    {
+    public:
+      //! zero
+      constexpr DoubleDouble ()
+        : _hi(0.0), _lo(0.0)
+      {}
+
+      //! conversion from double, exact
+      constexpr DoubleDouble (double hi)
+        : _hi(hi), _lo(0.0)
+      {}
+
+      //! from a normalized pair with |lo| <= ulp(hi)/2
+      constexpr DoubleDouble (double hi, double lo)
+        : _hi(hi), _lo(lo)
+      {}
+
+      //! leading part, the double closest to the number
+      constexpr double hi () const
+      {
+        return _hi;
+      }
+
+      //! trailing part
+      constexpr double lo () const
+      {
+        return _lo;
+      }
+
+      explicit constexpr operator double () const
+      {
+        return _hi;
+      }
+
+      DoubleDouble operator- () const
+      {
+        return DoubleDouble(-_hi,-_lo);
+      }
+
+      DoubleDouble operator+ () const
+      {
+        return *this;
+      }
+
+      DoubleDouble& operator+= (const DoubleDouble& b)
+      {
+        double s2, t2;
+        double s1 = detail::two_sum(_hi,b._hi,s2);
+        double t1 = detail::two_sum(_lo,b._lo,t2);
+        s2 += t1;
+        s1 = detail::quick_two_sum(s1,s2,s2);
+        s2 += t2;
+        _hi = detail::quick_two_sum(s1,s2,_lo);
+        return *this;
+      }
+
+      DoubleDouble& operator+= (double b)
+      {
+        double s2;
+        double s1 = detail::two_sum(_hi,b,s2);
+        s2 += _lo;
+        _hi = detail::quick_two_sum(s1,s2,_lo);
+        return *this;
+      }
+
+      DoubleDouble& operator-= (const DoubleDouble& b)
+      {
+        return *this += -b;
+      }
+
+      DoubleDouble& operator-= (double b)
+      {
+        return *this += -b;
+      }
+
+      DoubleDouble& operator*= (const DoubleDouble& b)
+      {
+        double p2;
+        double p1 = detail::two_prod(_hi,b._hi,p2);
+        p2 += _hi*b._lo+_lo*b._hi;
+        _hi = detail::quick_two_sum(p1,p2,_lo);
+        return *this;
+      }
+
+      DoubleDouble& operator*= (double b)
+      {
+        double p2;
+        double p1 = detail::two_prod(_hi,b,p2);
+        p2 += _lo*b;
+        _hi = detail::quick_two_sum(p1,p2,_lo);
+        return *this;
+      }
+
+      //! long division with three partial quotients
+      DoubleDouble& operator/= (const DoubleDouble& b)
+      {
+        double q1 = _hi/b._hi;
+        DoubleDouble r(*this);
+        r -= b*q1;
+        double q2 = r._hi/b._hi;
+        r -= b*q2;
+        double q3 = r._hi/b._hi;
+        double e;
+        q1 = detail::quick_two_sum(q1,q2,e);
+        *this = DoubleDouble(q1,e);
+        return *this += q3;
+      }
+
+      DoubleDouble& operator/= (double b)
+      {
+        double q1 = _hi/b;
+        double p2;
+        double p1 = detail::two_prod(q1,b,p2);
+        double s2;
+        double s1 = detail::two_sum(_hi,-p1,s2);
+        s2 -= p2;
+        s2 += _lo;
+        double q2 = (s1+s2)/b;
+        _hi = detail::quick_two_sum(q1,q2,_lo);
+        return *this;
+      }
+
+      friend DoubleDouble operator* (DoubleDouble a, double b)
+      {
+        return a *= b;
+      }
+
+    private:
+      double _hi, _lo;
+    };
+
+    // ********************************************************************************
+    // arithmetic, mixed with double in both orders
+    // ********************************************************************************
+
+#define HDNUM_DD_ARITHMETIC(OP)                                         \
+    inline DoubleDouble operator OP (DoubleDouble a, const DoubleDouble& b) \
+    {                                                                   \
+      return a OP##= b;                                                 \
+    }                                                                   \
+                                                                        \
+    inline DoubleDouble operator OP (double a, const DoubleDouble& b)   \
+    {                                                                   \
+      return DoubleDouble(a) OP##= b;                                   \
+    }
+
+    HDNUM_DD_ARITHMETIC(+)
+    HDNUM_DD_ARITHMETIC(-)
+    HDNUM_DD_ARITHMETIC(*)
+    HDNUM_DD_ARITHMETIC(/)
+
+#undef HDNUM_DD_ARITHMETIC
+
+    inline DoubleDouble operator+ (DoubleDouble a, double b)
+    {
+      return a += b;
+    }
+
+    inline DoubleDouble operator- (DoubleDouble a, double b)
+    {
+      return a -= b;
+    }
+
+    inline DoubleDouble operator/ (DoubleDouble a, double b)
+    {
+      return a /= b;
+    }
+
+    // ********************************************************************************
+    // comparisons
+    // ********************************************************************************
+
+    inline bool operator< (const DoubleDouble& a, const DoubleDouble& b)
+    {
+      return a.hi()<b.hi() || (a.hi()==b.hi() && a.lo()<b.lo());
+    }
+
+    inline bool operator== (const DoubleDouble& a, const DoubleDouble& b)
+    {
+      return a.hi()==b.hi() && a.lo()==b.lo();
+    }
+
+#define HDNUM_DD_COMPARISON(OP,EXPR)                                    \
+    inline bool operator OP (const DoubleDouble& a, const DoubleDouble& b) \
+    {                                                                   \
+      return EXPR;                                                      \
+    }                                                                   \
+                                                                        \
+    inline bool operator OP (const DoubleDouble& a, double b)           \
+    {                                                                   \
+      return a OP DoubleDouble(b);                                      \
+    }                                                                   \
+                                                                        \
+    inline bool operator OP (double a, const DoubleDouble& b)           \
+    {                                                                   \
+      return DoubleDouble(a) OP b;                                      \
+    }
+
+    HDNUM_DD_COMPARISON(>,b<a)
+    HDNUM_DD_COMPARISON(<=,!(b<a))
+    HDNUM_DD_COMPARISON(>=,!(a<b))
+    HDNUM_DD_COMPARISON(!=,!(a==b))
+
+#undef HDNUM_DD_COMPARISON
+
+    inline bool operator< (const DoubleDouble& a, double b)
+    {
+      return a<DoubleDouble(b);
+    }
+
+    inline bool operator< (double a, const DoubleDouble& b)
+    {
+      return DoubleDouble(a)<b;
+    }
+
+    inline bool operator== (const DoubleDouble& a, double b)
+    {
+      return a==DoubleDouble(b);
+    }
+
+    inline bool operator== (double a, const DoubleDouble& b)
+    {
+      return DoubleDouble(a)==b;
+    }
+
+    // ********************************************************************************
+    // functions
+    // ********************************************************************************
+
+    inline DoubleDouble abs (const DoubleDouble& a)
+    {
+      return (a.hi()<0.0) ? -a : a;
+    }
+
+    inline DoubleDouble fabs (const DoubleDouble& a)
+    {
+      return abs(a);
+    }
+
+    inline bool isnan (const DoubleDouble& a)
+    {
+      return std::isnan(a.hi());
+    }
+
+    inline bool isinf (const DoubleDouble& a)
+    {
+      return std::isinf(a.hi());
+    }
+
+    inline DoubleDouble floor (const DoubleDouble& a)
+    {
+      double hi = std::floor(a.hi());
+      if (hi!=a.hi()) return DoubleDouble(hi);
+      double lo = std::floor(a.lo());
+      hi = detail::quick_two_sum(hi,lo,lo);
+      return DoubleDouble(hi,lo);
+    }
+
+    //! a * 2^e, exact
+    inline DoubleDouble ldexp (const DoubleDouble& a, int e)
+    {
+      return DoubleDouble(std::ldexp(a.hi(),e),std::ldexp(a.lo(),e));
+    }
+
+    //! one Newton step from the double square root
+    inline DoubleDouble sqrt (const DoubleDouble& a)
+    {
+      if (a.hi()<=0.0)
+        return (a.hi()==0.0) ? DoubleDouble(0.0) : DoubleDouble(std::numeric_limits<double>::quiet_NaN());
+      double r = std::sqrt(a.hi());
+      double e;
+      double rr = detail::two_prod(r,r,e);
+      DoubleDouble d(a);
+      d -= DoubleDouble(rr,e);
+      return DoubleDouble(r) + d.hi()*(0.5/r);
+    }
+
+    //! integer power by repeated squaring
+    inline DoubleDouble pow (const DoubleDouble& a, int n)
+    {
+      if (n==0) return DoubleDouble(1.0);
+      DoubleDouble r(1.0), s(a);
+      // magnitude in unsigned arithmetic, -n overflows for INT_MIN
+      unsigned int m = (n<0) ? 0u-static_cast<unsigned int>(n) : static_cast<unsigned int>(n);
+      while (m>0)
+        {
+          if (m&1) r *= s;
+          m >>= 1;
+          if (m>0) s *= s;
+        }
+      return (n<0) ? DoubleDouble(1.0)/r : r;
+    }
+
+    /** @brief exponential function
+
+        exp(a) = 2^m exp(r)^512 with a = m log 2 + 512 r, the Taylor
+        series of exp(r)-1 converges after about ten terms.
+    */
+    inline DoubleDouble exp (const DoubleDouble& a)
+    {
+      const DoubleDouble log2(6.931471805599452862e-01,2.319046813846299558e-17);
+      if (a.hi()>709.79) return DoubleDouble(std::numeric_limits<double>::infinity());
+      if (a.hi()<-745.2) return DoubleDouble(0.0);
+      if (a.hi()==0.0) return DoubleDouble(1.0);
+      double m = std::floor(a.hi()/log2.hi()+0.5);
+      DoubleDouble r = ldexp(a-log2*m,-9);
+      DoubleDouble s(r), t(r);
+      for (int i=2; i<20; i++)
+        {
+          t *= r;
+          t /= double(i);
+          s += t;
+          if (std::abs(t.hi())<=1e-34) break;
+        }
+      for (int i=0; i<9; i++)  // (1+s)^2 - 1 = 2s + s^2
+        s = ldexp(s,1) + s*s;
+      s += 1.0;
+      return ldexp(s,int(m));
+    }
+
+    //! natural logarithm, one Newton step for exp(x) = a from the double logarithm
+    inline DoubleDouble log (const DoubleDouble& a)
+    {
+      if (a.hi()<=0.0)
+        return DoubleDouble((a.hi()==0.0) ? -std::numeric_limits<double>::infinity()
+                            : std::numeric_limits<double>::quiet_NaN());
+      DoubleDouble x(std::log(a.hi()));
+      return x + a*exp(-x) - 1.0;
+    }
+
+    //! general power for a > 0, integer exponents use pow(a,int)
+    inline DoubleDouble pow (const DoubleDouble& a, const DoubleDouble& b)
+    {
+      if (b.lo()==0.0 && b.hi()==std::floor(b.hi()) && std::abs(b.hi())<1e9)
+        return pow(a,int(b.hi()));
+      return exp(b*log(a));
+    }
+
+    inline DoubleDouble pow (const DoubleDouble& a, double b)
+    {
+      return pow(a,DoubleDouble(b));
+    }
+
+    inline DoubleDouble pow (double a, const DoubleDouble& b)
+    {
+      return pow(DoubleDouble(a),b);
+    }
+
+    /** @brief decimal representation in scientific notation
+
+        \param digits number of digits after the decimal point
+    */
+    inline std::string to_string (const DoubleDouble& a, int digits)
+    {
+      if (isnan(a)) return "nan";
+      if (isinf(a)) return (a.hi()<0.0) ? "-inf" : "inf";
+      if (digits<0) digits = 0;
+      std::string s((a.hi()<0.0) ? "-" : "");
+      std::string d(digits+1,'0');
+      int e = 0;
+      if (a.hi()!=0.0)
+        {
+          // scale to [1,10) and extract one more digit for rounding
+          DoubleDouble r = abs(a);
+          e = int(std::floor(std::log10(r.hi())));
+          r = (e>=0) ? r/pow(DoubleDouble(10.0),e) : r*pow(DoubleDouble(10.0),-e);
+          if (r>=10.0) { r /= 10.0; e++; }
+          if (r<1.0) { r *= 10.0; e--; }
+          std::string raw;
+          for (int i=0; i<=digits+1; i++)
+            {
+              int k = int(std::floor(r.hi()));
+              if (k<0) k = 0;
+              if (k>9) k = 9;
+              raw += char('0'+k);
+              r = (r-double(k))*10.0;
+            }
+          // round half up and propagate the carry
+          bool carry = raw[digits+1]>='5';
+          for (int i=digits; i>=0; i--)
+            {
+              if (carry)
+                {
+                  if (raw[i]=='9') raw[i] = '0';
+                  else { raw[i]++; carry = false; }
+                }
+              d[i] = raw[i];
+            }
+          if (carry)
+            {
+              d = "1" + d.substr(0,digits);
+              e++;
+            }
+        }
+      s += d[0];
+      if (digits>0) s += "." + d.substr(1);
+      s += (e<0) ? "e-" : "e+";
+      int ae = (e<0) ? -e : e;
+      if (ae<10) s += "0";
+      s += std::to_string(ae);
+      return s;
+    }
+
+    /** @brief output in scientific notation
+
+        With std::scientific or std::fixed the stream precision is the
+        number of digits after the decimal point, otherwise the number
+        of significant digits. The field width is respected.
+    */
+    inline std::ostream& operator<< (std::ostream& os, const DoubleDouble& a)
+    {
+      int p = int(os.precision());
+      std::ios_base::fmtflags field = os.flags() & std::ios_base::floatfield;
+      if (field!=std::ios_base::scientific && field!=std::ios_base::fixed) p = (p>0) ? p-1 : 0;
+      return os << to_string(a,p);
+    }
+
+  } // namespace dd
+
+  using dd::DoubleDouble;
+
+} // namespace hdnum
+
+namespace hdnum {
+  namespace dd {
+    namespace detail {
+
+      // members of std::numeric_limits<DoubleDouble>, a template such
+      // that the definitions below may appear in every translation unit
+      template<class Dummy=void>
+      struct DoubleDoubleLimits
+      {
+        static constexpr bool is_specialized = true;
+        static constexpr bool is_signed = true;
+        static constexpr bool is_integer = false;
+        static constexpr bool is_exact = false;
+        static constexpr bool has_infinity = true;
+        static constexpr bool has_quiet_NaN = true;
+        static constexpr bool has_signaling_NaN = std::numeric_limits<double>::has_signaling_NaN;
+        static constexpr std::float_denorm_style has_denorm = std::denorm_absent;
+        static constexpr bool has_denorm_loss = false;
+        static constexpr std::float_round_style round_style = std::round_indeterminate;
+        static constexpr bool is_iec559 = false;
+        static constexpr bool is_bounded = true;
+        static constexpr bool is_modulo = false;
+        static constexpr int digits = 106;
+        static constexpr int digits10 = 31;
+        static constexpr int max_digits10 = 33;
+        static constexpr int radix = 2;
+        static constexpr int min_exponent = std::numeric_limits<double>::min_exponent+53;
+        static constexpr int min_exponent10 = -291;
+        static constexpr int max_exponent = std::numeric_limits<double>::max_exponent;
+        static constexpr int max_exponent10 = std::numeric_limits<double>::max_exponent10;
+        static constexpr bool traps = false;
+        static constexpr bool tinyness_before = false;
+
+        static constexpr DoubleDouble min ()
+        {
+          return DoubleDouble(2.0041683600089728e-292);    // 2^-969, lo stays normalized
+        }
+
+        static constexpr DoubleDouble max ()
+        {
+          return DoubleDouble(1.79769313486231570815e+308,9.97920154767359795037e+291);
+        }
+
+        static constexpr DoubleDouble lowest ()
+        {
+          return DoubleDouble(-1.79769313486231570815e+308,-9.97920154767359795037e+291);
+        }
+
+        static constexpr DoubleDouble epsilon ()
+        {
+          return DoubleDouble(4.9303806576313238e-32);     // 2^-104
+        }
+
+        static constexpr DoubleDouble round_error ()
+        {
+          return DoubleDouble(0.5);
+        }
+
+        static constexpr DoubleDouble infinity ()
+        {
+          return DoubleDouble(std::numeric_limits<double>::infinity());
+        }
+
+        static constexpr DoubleDouble quiet_NaN ()
+        {
+          return DoubleDouble(std::numeric_limits<double>::quiet_NaN());
+        }
+
+        static constexpr DoubleDouble signaling_NaN ()
+        {
+          return DoubleDouble(std::numeric_limits<double>::signaling_NaN());
+        }
+
+        //! no denormalized numbers, the smallest positive value is min()
+        static constexpr DoubleDouble denorm_min ()
+        {
+          return min();
+        }
+      };
+
+      template<class D> constexpr bool DoubleDoubleLimits<D>::is_specialized;
+      template<class D> constexpr bool DoubleDoubleLimits<D>::is_signed;
+      template<class D> constexpr bool DoubleDoubleLimits<D>::is_integer;
+      template<class D> constexpr bool DoubleDoubleLimits<D>::is_exact;
+      template<class D> constexpr bool DoubleDoubleLimits<D>::has_infinity;
+      template<class D> constexpr bool DoubleDoubleLimits<D>::has_quiet_NaN;
+      template<class D> constexpr bool DoubleDoubleLimits<D>::has_signaling_NaN;
+      template<class D> constexpr std::float_denorm_style DoubleDoubleLimits<D>::has_denorm;
+      template<class D> constexpr bool DoubleDoubleLimits<D>::has_denorm_loss;
+      template<class D> constexpr std::float_round_style DoubleDoubleLimits<D>::round_style;
+      template<class D> constexpr bool DoubleDoubleLimits<D>::is_iec559;
+      template<class D> constexpr bool DoubleDoubleLimits<D>::is_bounded;
+      template<class D> constexpr bool DoubleDoubleLimits<D>::is_modulo;
+      template<class D> constexpr int DoubleDoubleLimits<D>::digits;
+      template<class D> constexpr int DoubleDoubleLimits<D>::digits10;
+      template<class D> constexpr int DoubleDoubleLimits<D>::max_digits10;
+      template<class D> constexpr int DoubleDoubleLimits<D>::radix;
+      template<class D> constexpr int DoubleDoubleLimits<D>::min_exponent;
+      template<class D> constexpr int DoubleDoubleLimits<D>::min_exponent10;
+      template<class D> constexpr int DoubleDoubleLimits<D>::max_exponent;
+      template<class D> constexpr int DoubleDoubleLimits<D>::max_exponent10;
+      template<class D> constexpr bool DoubleDoubleLimits<D>::traps;
+      template<class D> constexpr bool DoubleDoubleLimits<D>::tinyness_before;
+
+    } // namespace detail
+  } // namespace dd
+} // namespace hdnum
+
+namespace std {
+
+  //! limits of the double-double type, precision 2^-104, range of double
+  template<>
+  class numeric_limits<hdnum::DoubleDouble>
+    : public hdnum::dd::detail::DoubleDoubleLimits<>
+  {};
+
+} // namespace std
+
+#endif
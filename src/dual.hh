@@ -0,0 +1,570 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_DUAL_HH
+#define HDNUM_DUAL_HH
+
+#include <type_traits>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include "vector.hh"
+#include "densematrix.hh"
+
+/** @file
+ *  @brief forward mode automatic differentiation with dual numbers
+ */
+
+namespace hdnum {
+  namespace ad {
+
+    /** Dual number with n derivative components
+     *
+     * Stores a value and its derivatives with respect to n independent
+     * variables. All operations apply the chain rule, so evaluating a
+     * function templated on the number type with seeded inputs yields n
+     * columns of its Jacobian in one pass (vector mode).
+     *
+     * \tparam F a builtin floating point type
+     * \tparam n number of derivative components
+     */
+    template<typename F, int n>
+    class Dual
+    {
+
+    public:
+
+      using size_type = std::size_t;
+
+      using value_type = F;
+
+      //! number of derivative components
+      enum { size = n };
+
+      Dual()
+        : _v()
+      {
+        for (int i=0; i<n; i++) _d[i] = F(0);
+      }
+
+      //! constant, all derivatives are zero
+      Dual(const F& f)
+        : _v(f)
+      {
+        for (int i=0; i<n; i++) _d[i] = F(0);
+      }
+
+      template<typename T>
+      Dual(const T& t, typename std::enable_if<std::is_arithmetic<T>::value and !std::is_same<T,F>::value>::type* = nullptr)
+        : _v(t)
+      {
+        for (int i=0; i<n; i++) _d[i] = F(0);
+      }
+
+      //! independent variable with derivative component k set to one
+      Dual(const F& f, int k)
+        : _v(f)
+      {
+        for (int i=0; i<n; i++) _d[i] = F(0);
+        _d[k] = F(1);
+      }
+
+      explicit operator F() const
+      {
+        return _v;
+      }
+
+      //! value
+      const F& value() const
+      {
+        return _v;
+      }
+
+      //! derivative component k
+      const F& derivative(int k) const
+      {
+        return _d[k];
+      }
+
+      F& derivative(int k)
+      {
+        return _d[k];
+      }
+
+      friend std::ostream& operator<<(std::ostream& os, const Dual& a)
+      {
+        os << a._v;
+        return os;
+      }
+
+      F _v;
+      F _d[n];
+    };
+
+
+    // ********************************************************************************
+    // negation
+    // ********************************************************************************
+
+    template<typename F, int n>
+    Dual<F,n> operator-(const Dual<F,n>& a)
+    {
+      Dual<F,n> r(-a._v);
+      for (int i=0; i<n; i++) r._d[i] = -a._d[i];
+      return r;
+    }
+
+    template<typename F, int n>
+    Dual<F,n> operator+(const Dual<F,n>& a)
+    {
+      return a;
+    }
+
+
+    // ********************************************************************************
+    // addition
+    // ********************************************************************************
+
+    template<typename F, int n>
+    Dual<F,n>& operator+=(Dual<F,n>& a, const Dual<F,n>& b)
+    {
+      a._v += b._v;
+      for (int i=0; i<n; i++) a._d[i] += b._d[i];
+      return a;
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n>&>::type
+    operator+=(Dual<F,n>& a, const T& b)
+    {
+      a._v += b;
+      return a;
+    }
+
+    template<typename F, int n>
+    Dual<F,n> operator+(Dual<F,n> a, const Dual<F,n>& b)
+    {
+      return a += b;
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n> >::type
+    operator+(Dual<F,n> a, const T& b)
+    {
+      return a += b;
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n> >::type
+    operator+(const T& a, Dual<F,n> b)
+    {
+      return b += a;
+    }
+
+
+    // ********************************************************************************
+    // subtraction
+    // ********************************************************************************
+
+    template<typename F, int n>
+    Dual<F,n>& operator-=(Dual<F,n>& a, const Dual<F,n>& b)
+    {
+      a._v -= b._v;
+      for (int i=0; i<n; i++) a._d[i] -= b._d[i];
+      return a;
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n>&>::type
+    operator-=(Dual<F,n>& a, const T& b)
+    {
+      a._v -= b;
+      return a;
+    }
+
+    template<typename F, int n>
+    Dual<F,n> operator-(Dual<F,n> a, const Dual<F,n>& b)
+    {
+      return a -= b;
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n> >::type
+    operator-(Dual<F,n> a, const T& b)
+    {
+      return a -= b;
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n> >::type
+    operator-(const T& a, const Dual<F,n>& b)
+    {
+      Dual<F,n> r(a-b._v);
+      for (int i=0; i<n; i++) r._d[i] = -b._d[i];
+      return r;
+    }
+
+
+    // ********************************************************************************
+    // multiplication
+    // ********************************************************************************
+
+    template<typename F, int n>
+    Dual<F,n>& operator*=(Dual<F,n>& a, const Dual<F,n>& b)
+    {
+      for (int i=0; i<n; i++) a._d[i] = a._d[i]*b._v + a._v*b._d[i];
+      a._v *= b._v;
+      return a;
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n>&>::type
+    operator*=(Dual<F,n>& a, const T& b)
+    {
+      a._v *= b;
+      for (int i=0; i<n; i++) a._d[i] *= b;
+      return a;
+    }
+
+    template<typename F, int n>
+    Dual<F,n> operator*(Dual<F,n> a, const Dual<F,n>& b)
+    {
+      return a *= b;
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n> >::type
+    operator*(Dual<F,n> a, const T& b)
+    {
+      return a *= b;
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n> >::type
+    operator*(const T& a, Dual<F,n> b)
+    {
+      return b *= a;
+    }
+
+
+    // ********************************************************************************
+    // division
+    // ********************************************************************************
+
+    template<typename F, int n>
+    Dual<F,n>& operator/=(Dual<F,n>& a, const Dual<F,n>& b)
+    {
+      a._v /= b._v;
+      for (int i=0; i<n; i++) a._d[i] = (a._d[i] - a._v*b._d[i])/b._v;
+      return a;
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n>&>::type
+    operator/=(Dual<F,n>& a, const T& b)
+    {
+      a._v /= b;
+      for (int i=0; i<n; i++) a._d[i] /= b;
+      return a;
+    }
+
+    template<typename F, int n>
+    Dual<F,n> operator/(Dual<F,n> a, const Dual<F,n>& b)
+    {
+      return a /= b;
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n> >::type
+    operator/(Dual<F,n> a, const T& b)
+    {
+      return a /= b;
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n> >::type
+    operator/(const T& a, const Dual<F,n>& b)
+    {
+      Dual<F,n> r(F(a)/b._v);
+      for (int i=0; i<n; i++) r._d[i] = -r._v*b._d[i]/b._v;
+      return r;
+    }
+
+
+    // ********************************************************************************
+    // comparisons, only the values are compared
+    // ********************************************************************************
+
+#define HDNUM_DUAL_COMPARISON(OP)                                       \
+    template<typename F, int n>                                         \
+    bool operator OP (const Dual<F,n>& a, const Dual<F,n>& b)           \
+    {                                                                   \
+      return a._v OP b._v;                                              \
+    }                                                                   \
+                                                                        \
+    template<typename F, int n, typename T>                             \
+    typename std::enable_if<std::is_arithmetic<T>::value,bool>::type    \
+    operator OP (const Dual<F,n>& a, const T& b)                        \
+    {                                                                   \
+      return a._v OP b;                                                 \
+    }                                                                   \
+                                                                        \
+    template<typename F, int n, typename T>                             \
+    typename std::enable_if<std::is_arithmetic<T>::value,bool>::type    \
+    operator OP (const T& a, const Dual<F,n>& b)                        \
+    {                                                                   \
+      return a OP b._v;                                                 \
+    }
+
+    HDNUM_DUAL_COMPARISON(<)
+    HDNUM_DUAL_COMPARISON(<=)
+    HDNUM_DUAL_COMPARISON(>)
+    HDNUM_DUAL_COMPARISON(>=)
+    HDNUM_DUAL_COMPARISON(==)
+    HDNUM_DUAL_COMPARISON(!=)
+
+#undef HDNUM_DUAL_COMPARISON
+
+
+    // ********************************************************************************
+    // functions
+    // ********************************************************************************
+
+    //! apply the chain rule for a function with value fa and derivative dfa
+    template<typename F, int n>
+    Dual<F,n> chain(const Dual<F,n>& a, const F& fa, const F& dfa)
+    {
+      Dual<F,n> r(fa);
+      for (int i=0; i<n; i++) r._d[i] = dfa*a._d[i];
+      return r;
+    }
+
+    template<typename F, int n>
+    Dual<F,n> exp(const Dual<F,n>& a)
+    {
+      F e = std::exp(a._v);
+      return chain(a,e,e);
+    }
+
+    template<typename F, int n>
+    Dual<F,n> log(const Dual<F,n>& a)
+    {
+      return chain(a,F(std::log(a._v)),F(1)/a._v);
+    }
+
+    template<typename F, int n>
+    Dual<F,n> sqrt(const Dual<F,n>& a)
+    {
+      F s = std::sqrt(a._v);
+      return chain(a,s,F(0.5)/s);
+    }
+
+    template<typename F, int n>
+    Dual<F,n> sin(const Dual<F,n>& a)
+    {
+      return chain(a,F(std::sin(a._v)),F(std::cos(a._v)));
+    }
+
+    template<typename F, int n>
+    Dual<F,n> cos(const Dual<F,n>& a)
+    {
+      return chain(a,F(std::cos(a._v)),F(-std::sin(a._v)));
+    }
+
+    template<typename F, int n>
+    Dual<F,n> tan(const Dual<F,n>& a)
+    {
+      F t = std::tan(a._v);
+      return chain(a,t,F(1)+t*t);
+    }
+
+    template<typename F, int n>
+    Dual<F,n> atan(const Dual<F,n>& a)
+    {
+      return chain(a,F(std::atan(a._v)),F(1)/(F(1)+a._v*a._v));
+    }
+
+    template<typename F, int n>
+    Dual<F,n> tanh(const Dual<F,n>& a)
+    {
+      F t = std::tanh(a._v);
+      return chain(a,t,F(1)-t*t);
+    }
+
+    template<typename F, int n>
+    Dual<F,n> abs(const Dual<F,n>& a)
+    {
+      return (a._v<F(0)) ? -a : a;
+    }
+
+    template<typename F, int n>
+    Dual<F,n> fabs(const Dual<F,n>& a)
+    {
+      return abs(a);
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n> >::type
+    pow(const Dual<F,n>& a, const T& b)
+    {
+      return chain(a,F(std::pow(a._v,F(b))),F(b)*F(std::pow(a._v,F(b)-F(1))));
+    }
+
+    template<typename F, int n, typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value,Dual<F,n> >::type
+    pow(const T& a, const Dual<F,n>& b)
+    {
+      F p = std::pow(F(a),b._v);
+      return chain(b,p,p*F(std::log(F(a))));
+    }
+
+    template<typename F, int n>
+    Dual<F,n> pow(const Dual<F,n>& a, const Dual<F,n>& b)
+    {
+      return exp(b*log(a));
+    }
+
+  } // namespace ad
+
+
+  /** @brief Adds an exact Jacobian f_x to an ODE model by automatic differentiation
+
+      The model has to be available twice: for the number type N and
+      for a dual number type ad::Dual<N,c>, e.g. VanDerPolProblem<double>
+      and VanDerPolProblem<double,ad::Dual<double,2> >. The Jacobian
+      is computed c columns at a time with the second one.
+
+      \tparam M the model type
+      \tparam MD the same model with dual numbers as number type
+  */
+  template<class M, class MD>
+  class AutoDiffModel
+  {
+    typedef typename MD::number_type D;
+
+  public:
+    /** \brief export size_type */
+    typedef typename M::size_type size_type;
+
+    /** \brief export time_type */
+    typedef typename M::time_type time_type;
+
+    /** \brief export number_type */
+    typedef typename M::number_type number_type;
+
+    //! constructor stores references to both models
+    AutoDiffModel (const M& model_, const MD& dmodel_)
+      : model(model_), dmodel(dmodel_), xd(model_.size()), fd(model_.size())
+    {}
+
+    //! return number of componentes for the model
+    std::size_t size () const
+    {
+      return model.size();
+    }
+
+    //! set initial state including time value
+    void initialize (time_type& t0, Vector<number_type>& x0) const
+    {
+      model.initialize(t0,x0);
+    }
+
+    //! model evaluation
+    void f (const time_type& t, const Vector<number_type>& x, Vector<number_type>& result) const
+    {
+      model.f(t,x,result);
+    }
+
+    //! jacobian evaluation needed for implicit solvers
+    void f_x (const time_type& t, const Vector<number_type>& x, DenseMatrix<number_type>& result) const
+    {
+      typename MD::time_type td(t);
+      for (size_type first=0; first<x.size(); first+=D::size)
+        {
+          for (size_type i=0; i<x.size(); i++)
+            xd[i] = (i>=first && i<first+D::size) ? D(x[i],int(i-first)) : D(x[i]);
+          dmodel.f(td,xd,fd);
+          for (size_type i=0; i<fd.size(); i++)
+            for (size_type k=0; k<size_type(D::size) && first+k<result.colsize(); k++)
+              result[i][first+k] = fd[i].derivative(k);
+        }
+    }
+
+  private:
+    const M& model;
+    const MD& dmodel;
+    mutable Vector<D> xd, fd;
+  };
+
+  //! return AutoDiffModel for the model and its dual number version
+  template<class M, class MD>
+  AutoDiffModel<M,MD> getAutoDiffModel (const M& model, const MD& dmodel)
+  {
+    return AutoDiffModel<M,MD>(model,dmodel);
+  }
+
+
+  /** @brief Adds an exact Jacobian F_x to a nonlinear problem F(x)=0
+
+      Like AutoDiffModel for models with methods F and F_x.
+
+      \tparam M the problem type
+      \tparam MD the same problem with dual numbers as number type
+  */
+  template<class M, class MD>
+  class AutoDiffProblem
+  {
+    typedef typename MD::number_type D;
+
+  public:
+    /** \brief export size_type */
+    typedef typename M::size_type size_type;
+
+    /** \brief export number_type */
+    typedef typename M::number_type number_type;
+
+    //! constructor stores references to both problems
+    AutoDiffProblem (const M& model_, const MD& dmodel_)
+      : model(model_), dmodel(dmodel_), xd(model_.size()), Fd(model_.size())
+    {}
+
+    //! return number of componentes for the model
+    std::size_t size () const
+    {
+      return model.size();
+    }
+
+    //! model evaluation
+    void F (const Vector<number_type>& x, Vector<number_type>& result) const
+    {
+      model.F(x,result);
+    }
+
+    //! jacobian evaluation needed for implicit solvers
+    void F_x (const Vector<number_type>& x, DenseMatrix<number_type>& result) const
+    {
+      for (size_type first=0; first<x.size(); first+=D::size)
+        {
+          for (size_type i=0; i<x.size(); i++)
+            xd[i] = (i>=first && i<first+D::size) ? D(x[i],int(i-first)) : D(x[i]);
+          dmodel.F(xd,Fd);
+          for (size_type i=0; i<Fd.size(); i++)
+            for (size_type k=0; k<size_type(D::size) && first+k<result.colsize(); k++)
+              result[i][first+k] = Fd[i].derivative(k);
+        }
+    }
+
+  private:
+    const M& model;
+    const MD& dmodel;
+    mutable Vector<D> xd, Fd;
+  };
+
+  //! return AutoDiffProblem for the problem and its dual number version
+  template<class M, class MD>
+  AutoDiffProblem<M,MD> getAutoDiffProblem (const M& model, const MD& dmodel)
+  {
+    return AutoDiffProblem<M,MD>(model,dmodel);
+  }
+
+} // namespace hdnum
+
+#endif
@@ -0,0 +1,636 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_ENSEMBLE_HH
+#define HDNUM_ENSEMBLE_HH
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <algorithm>
+#include "vector.hh"
+#include "exceptions.hh"
+
+/** @file
+ *  @brief integration of ensembles of independent copies of an ODE model
+ *
+ *  An ensemble consists of K members with n components each. The state
+ *  of the ensemble is stored in structure of arrays form: component i
+ *  of member k is X[i*K+k]. An ensemble model provides
+ *
+ *  - size() the number n of components of one member
+ *  - members() the number K of members
+ *  - initialize(t0,X) the initial state of all members
+ *  - f(t,X,F,k0,k1) evaluation of the right hand side for the members
+ *    k0,...,k1-1 at the member times t[k], other members of F are left
+ *    unchanged
+ *
+ *  Loops over the members in f are contiguous in memory and can be
+ *  vectorized by the compiler. Different member ranges may be evaluated
+ *  concurrently, so f must not modify shared data.
+ */
+
+namespace hdnum {
+
+  /** @brief Run an ordinary model as ensemble model
+
+      Each member has its own copy of the model, e.g. with different
+      parameters. The states are gathered and scattered member by
+      member, so this adapter works for every model but is not
+      vectorized.
+
+      \tparam M the model type
+  */
+  template<class M>
+  class EnsembleAdapter
+  {
+  public:
+    /** \brief export size_type */
+    typedef typename M::size_type size_type;
+
+    /** \brief export time_type */
+    typedef typename M::time_type time_type;
+
+    /** \brief export number_type */
+    typedef typename M::number_type number_type;
+
+    //! constructor stores a copy of the member models
+    EnsembleAdapter (const std::vector<M>& models_)
+      : models(models_)
+    {
+      if (models.size()==0)
+        HDNUM_ERROR("EnsembleAdapter needs at least one member");
+    }
+
+    //! return number of components of one member
+    size_type size () const
+    {
+      return models[0].size();
+    }
+
+    //! return number of members
+    size_type members () const
+    {
+      return models.size();
+    }
+
+    //! set initial state including time value
+    void initialize (time_type& t0, Vector<number_type>& X) const
+    {
+      const size_type n = size(), K = members();
+      Vector<number_type> x(n);
+      for (size_type k=0; k<K; k++)
+        {
+          models[k].initialize(t0,x);
+          for (size_type i=0; i<n; i++) X[i*K+k] = x[i];
+        }
+    }
+
+    //! model evaluation for members k0,...,k1-1
+    void f (const Vector<time_type>& t, const Vector<number_type>& X,
+            Vector<number_type>& F, size_type k0, size_type k1) const
+    {
+      const size_type n = size(), K = members();
+      Vector<number_type> x(n), r(n);
+      for (size_type k=k0; k<k1; k++)
+        {
+          for (size_type i=0; i<n; i++) x[i] = X[i*K+k];
+          models[k].f(t[k],x,r);
+          for (size_type i=0; i<n; i++) F[i*K+k] = r[i];
+        }
+    }
+
+  private:
+    std::vector<M> models;
+  };
+
+
+  namespace ensemble {
+
+    /** @brief Persistent worker threads of an ensemble integrator
+
+        run() calls (obj->*work)(k0,k1) on contiguous ranges of [0,K),
+        the first range on the calling thread, and returns when all
+        ranges are done. The workers are started by the first run()
+        that needs them and wait for the next step in between, so a
+        step costs a wakeup instead of starting and joining threads.
+        Ranges are multiples of 64 members: the vector loops stay
+        intact, EnsembleRKF45 sees whole blocks when it skips finished
+        members, and small ensembles are run on the calling thread
+        alone. An exception thrown by work is rethrown by run().
+    */
+    template<class C>
+    class WorkerPool
+    {
+    public:
+      typedef void (C::*Work)(std::size_t, std::size_t) const;
+
+      WorkerPool ()
+        : obj(0), work(0), K(0), chunk(0), ranges(0), generation(0), busy(0), stop(false)
+      {}
+
+      //! a copy starts its own workers
+      WorkerPool (const WorkerPool&)
+        : WorkerPool()
+      {}
+
+      WorkerPool& operator= (const WorkerPool&) = delete;
+
+      ~WorkerPool ()
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          stop = true;
+        }
+        wake.notify_all();
+        for (std::size_t r=0; r<threads.size(); r++) threads[r].join();
+      }
+
+      //! call (obj->*work)(k0,k1) on at most nthreads contiguous ranges of [0,K)
+      void run (const C* obj_, Work work_, std::size_t K_, std::size_t nthreads)
+      {
+        if (nthreads==0) nthreads = 1;
+        std::size_t c = std::max(std::size_t(64),((K_+nthreads-1)/nthreads+63)/64*64);
+        if (c>=K_)
+          {
+            (obj_->*work_)(0,K_);
+            return;
+          }
+        std::size_t n = (K_+c-1)/c;
+        while (threads.size()+1<n)
+          threads.push_back(std::thread(&WorkerPool::loop,this,threads.size()+1,generation));
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          obj = obj_;
+          work = work_;
+          K = K_;
+          chunk = c;
+          ranges = n;
+          busy = n-1;
+          error = std::exception_ptr();
+          generation++;
+        }
+        wake.notify_all();
+        std::exception_ptr first;
+        try
+          {
+            (obj_->*work_)(0,c);
+          }
+        catch (...)
+          {
+            first = std::current_exception();
+          }
+        // the workers use obj, so wait for them also if the first range failed
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock,[this] () { return busy==0; });
+        if (!first) first = error;
+        if (first) std::rethrow_exception(first);
+      }
+
+    private:
+      void loop (std::size_t id, std::size_t seen)
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;)
+          {
+            wake.wait(lock,[this,seen] () { return stop || generation!=seen; });
+            if (stop) return;
+            seen = generation;
+            if (id>=ranges) continue;
+            std::size_t k0 = id*chunk, k1 = std::min(K,k0+chunk);
+            const C* o = obj;
+            Work w = work;
+            lock.unlock();
+            std::exception_ptr e;
+            try
+              {
+                (o->*w)(k0,k1);
+              }
+            catch (...)
+              {
+                e = std::current_exception();
+              }
+            lock.lock();
+            if (e && !error) error = e;
+            if (--busy==0) done.notify_one();
+          }
+      }
+
+      const C* obj;
+      Work work;
+      std::size_t K, chunk, ranges, generation, busy;
+      bool stop;
+      std::exception_ptr error;
+      std::mutex mutex;
+      std::condition_variable wake, done;
+      std::vector<std::thread> threads;
+    };
+
+    // X[i*K+k] = Y[i*K+k] + h[k]*sum_j a_j*Z_j[i*K+k] for members k0,...,k1-1
+    template<class N, class T>
+    void combine (std::size_t n, std::size_t K, std::size_t k0, std::size_t k1,
+                  Vector<N>& X, const Vector<N>& Y, const Vector<T>& h,
+                  std::size_t s, const T* a, const Vector<N>* const* Z)
+    {
+      for (std::size_t i=0; i<n; i++)
+        {
+          N* x = &X[i*K];
+          const N* y = &Y[i*K];
+          for (std::size_t k=k0; k<k1; k++) x[k] = y[k];
+          for (std::size_t j=0; j<s; j++)
+            {
+              if (a[j]==T(0.0)) continue;
+              const N* z = &(*Z[j])[i*K];
+              for (std::size_t k=k0; k<k1; k++) x[k] += h[k]*a[j]*z[k];
+            }
+        }
+    }
+
+  } // namespace ensemble
+
+
+  /** @brief Classical Runge-Kutta method of order 4 for ensembles
+
+      All members are advanced in lockstep with the same time step.
+      The member range is split over nthreads threads of a
+      WorkerPool; each thread performs all stages for its members, so
+      no synchronization between the stages is needed.
+
+      \tparam M the ensemble model type
+  */
+  template<class M>
+  class EnsembleRK4
+  {
+  public:
+    /** \brief export size_type */
+    typedef typename M::size_type size_type;
+
+    /** \brief export time_type */
+    typedef typename M::time_type time_type;
+
+    /** \brief export number_type */
+    typedef typename M::number_type number_type;
+
+    //! constructor stores reference to the model
+    EnsembleRK4 (const M& model_, size_type nthreads_=1)
+      : model(model_), n(model.size()), K(model.members()), nthreads(nthreads_),
+        u(n*K), w(n*K), k1(n*K), k2(n*K), k3(n*K), k4(n*K),
+        t(K), tw(K), h(K)
+    {
+      time_type t0;
+      model.initialize(t0,u);
+      t = t0;
+      dt = 0.1;
+    }
+
+    //! set time step for subsequent steps
+    void set_dt (time_type dt_)
+    {
+      dt = dt_;
+    }
+
+    //! set number of threads
+    void set_threads (size_type nthreads_)
+    {
+      nthreads = nthreads_;
+    }
+
+    //! do one step for all members
+    void step ()
+    {
+      pool.run(this,&EnsembleRK4::step_range,K,nthreads);
+    }
+
+    //! set state of member k
+    void set_member (size_type k, const Vector<number_type>& x)
+    {
+      for (size_type i=0; i<n; i++) u[i*K+k] = x[i];
+    }
+
+    //! get state of member k
+    void get_member (size_type k, Vector<number_type>& x) const
+    {
+      x.resize(n);
+      for (size_type i=0; i<n; i++) x[i] = u[i*K+k];
+    }
+
+    //! get current state of the ensemble
+    const Vector<number_type>& get_state () const
+    {
+      return u;
+    }
+
+    //! get current time of all members
+    const Vector<time_type>& get_time () const
+    {
+      return t;
+    }
+
+    //! get dt used in last step (i.e. to compute current state)
+    time_type get_dt () const
+    {
+      return dt;
+    }
+
+    //! return consistency order of the method
+    size_type get_order () const
+    {
+      return 4;
+    }
+
+  private:
+    void step_range (size_type first, size_type last) const
+    {
+      const time_type half(0.5), one(1.0), sixth(time_type(1.0)/time_type(6.0)),
+        third(time_type(1.0)/time_type(3.0));
+      const Vector<number_type>* Z[4] = {&k1,&k2,&k3,&k4};
+      for (size_type k=first; k<last; k++) h[k] = dt;
+
+      model.f(t,u,k1,first,last);
+
+      for (size_type k=first; k<last; k++) tw[k] = t[k]+half*dt;
+      ensemble::combine(n,K,first,last,w,u,h,1,&half,Z);
+      model.f(tw,w,k2,first,last);
+
+      ensemble::combine(n,K,first,last,w,u,h,1,&half,Z+1);
+      model.f(tw,w,k3,first,last);
+
+      for (size_type k=first; k<last; k++) tw[k] = t[k]+dt;
+      ensemble::combine(n,K,first,last,w,u,h,1,&one,Z+2);
+      model.f(tw,w,k4,first,last);
+
+      const time_type b[4] = {sixth,third,third,sixth};
+      ensemble::combine(n,K,first,last,u,u,h,4,b,Z);
+      for (size_type k=first; k<last; k++) t[k] += dt;
+    }
+
+    const M& model;
+    size_type n, K, nthreads;
+    time_type dt;
+    mutable Vector<number_type> u, w, k1, k2, k3, k4;
+    mutable Vector<time_type> t, tw, h;
+    ensemble::WorkerPool<EnsembleRK4> pool;
+  };
+
+
+  /** @brief Adaptive Runge-Kutta-Fehlberg method for ensembles
+
+      Every member has its own time and time step. A call to step()
+      makes one step attempt for every active member; members that
+      reached the final time are masked by a zero step size, blocks of
+      members that are all finished are skipped. The error estimate and step size control are the same as in RKF45,
+      applied member by member.
+
+      \tparam M the ensemble model type
+  */
+  template<class M>
+  class EnsembleRKF45
+  {
+  public:
+    /** \brief export size_type */
+    typedef typename M::size_type size_type;
+
+    /** \brief export time_type */
+    typedef typename M::time_type time_type;
+
+    /** \brief export number_type */
+    typedef typename M::number_type number_type;
+
+    //! constructor stores reference to the model
+    EnsembleRKF45 (const M& model_, size_type nthreads_=1)
+      : model(model_), n(model.size()), K(model.members()), nthreads(nthreads_),
+        u(n*K), w(n*K), ww(n*K), k1(n*K), k2(n*K), k3(n*K), k4(n*K), k5(n*K), k6(n*K),
+        t(K), tw(K), dt(K), h(K), steps(K,0), rejected(K,0)
+    {
+      TOL = time_type(0.0001);
+      rho = time_type(0.8);
+      alpha = time_type(0.25);
+      beta = time_type(4.0);
+      dt_min = 1E-12;
+      T = std::numeric_limits<time_type>::max();
+
+      c[0] = time_type(0.0);
+      c[1] = time_type(1.0)/time_type(4.0);
+      c[2] = time_type(3.0)/time_type(8.0);
+      c[3] = time_type(12.0)/time_type(13.0);
+      c[4] = time_type(1.0);
+      c[5] = time_type(1.0)/time_type(2.0);
+
+      for (int i=0; i<6; i++)
+        for (int j=0; j<6; j++) a[i][j] = time_type(0.0);
+      a[1][0] = time_type(1.0)/time_type(4.0);
+      a[2][0] = time_type(3.0)/time_type(32.0);
+      a[2][1] = time_type(9.0)/time_type(32.0);
+      a[3][0] = time_type(1932.0)/time_type(2197.0);
+      a[3][1] = time_type(-7200.0)/time_type(2197.0);
+      a[3][2] = time_type(7296.0)/time_type(2197.0);
+      a[4][0] = time_type(439.0)/time_type(216.0);
+      a[4][1] = time_type(-8.0);
+      a[4][2] = time_type(3680.0)/time_type(513.0);
+      a[4][3] = time_type(-845.0)/time_type(4104.0);
+      a[5][0] = time_type(-8.0)/time_type(27.0);
+      a[5][1] = time_type(2.0);
+      a[5][2] = time_type(-3544.0)/time_type(2565.0);
+      a[5][3] = time_type(1859.0)/time_type(4104.0);
+      a[5][4] = time_type(-11.0)/time_type(40.0);
+
+      b[0] = time_type(25.0)/time_type(216.0);
+      b[1] = time_type(0.0);
+      b[2] = time_type(1408.0)/time_type(2565.0);
+      b[3] = time_type(2197.0)/time_type(4104.0);
+      b[4] = time_type(-1.0)/time_type(5.0);
+      b[5] = time_type(0.0);
+
+      bb[0] = time_type(16.0)/time_type(135.0);
+      bb[1] = time_type(0.0);
+      bb[2] = time_type(6656.0)/time_type(12825.0);
+      bb[3] = time_type(28561.0)/time_type(56430.0);
+      bb[4] = time_type(-9.0)/time_type(50.0);
+      bb[5] = time_type(2.0)/time_type(55.0);
+
+      time_type t0;
+      model.initialize(t0,u);
+      t = t0;
+      dt = time_type(0.1);
+    }
+
+    //! set time step of all members for subsequent steps
+    void set_dt (time_type dt_)
+    {
+      dt = dt_;
+    }
+
+    //! set tolerance for adaptive computation
+    void set_TOL (time_type TOL_)
+    {
+      TOL = TOL_;
+    }
+
+    //! set number of threads
+    void set_threads (size_type nthreads_)
+    {
+      nthreads = nthreads_;
+    }
+
+    //! do one step attempt for all members that did not reach the final time
+    void step ()
+    {
+      pool.run(this,&EnsembleRKF45::step_range,K,nthreads);
+    }
+
+    //! advance all members to time T_, the last step of each member hits T_
+    void advance (time_type T_)
+    {
+      T = T_;
+      while (!finished()) step();
+      T = std::numeric_limits<time_type>::max();
+    }
+
+    //! true if all members reached the final time of advance
+    bool finished () const
+    {
+      for (size_type k=0; k<K; k++)
+        if (active(k)) return false;
+      return true;
+    }
+
+    //! set state of member k
+    void set_member (size_type k, const Vector<number_type>& x)
+    {
+      for (size_type i=0; i<n; i++) u[i*K+k] = x[i];
+    }
+
+    //! get state of member k
+    void get_member (size_type k, Vector<number_type>& x) const
+    {
+      x.resize(n);
+      for (size_type i=0; i<n; i++) x[i] = u[i*K+k];
+    }
+
+    //! get current state of the ensemble
+    const Vector<number_type>& get_state () const
+    {
+      return u;
+    }
+
+    //! get current time of all members
+    const Vector<time_type>& get_time () const
+    {
+      return t;
+    }
+
+    //! get time steps of all members for the next step
+    const Vector<time_type>& get_dt () const
+    {
+      return dt;
+    }
+
+    //! return consistency order of the method
+    size_type get_order () const
+    {
+      return 4;
+    }
+
+    //! total number of step attempts of all members
+    size_type get_steps () const
+    {
+      size_type s(0);
+      for (size_type k=0; k<K; k++) s += steps[k];
+      return s;
+    }
+
+    //! total number of rejected step attempts of all members
+    size_type get_rejected () const
+    {
+      size_type s(0);
+      for (size_type k=0; k<K; k++) s += rejected[k];
+      return s;
+    }
+
+  private:
+    bool active (size_type k) const
+    {
+      return t[k]<T && T-t[k]>time_type(1e-12)*std::max(time_type(1.0),std::abs(T));
+    }
+
+    // blocks of members that all reached the final time are skipped
+    void step_range (size_type first, size_type last) const
+    {
+      const size_type block = 64;
+      for (size_type b=first; b<last; b+=block)
+        {
+          size_type e = std::min(last,b+block);
+          for (size_type k=b; k<e; k++)
+            if (active(k))
+              {
+                step_block(b,e);
+                break;
+              }
+        }
+    }
+
+    void step_block (size_type first, size_type last) const
+    {
+      // step size of each member, zero masks finished members
+      for (size_type k=first; k<last; k++)
+        h[k] = active(k) ? std::min(dt[k],T-t[k]) : time_type(0.0);
+
+      const Vector<number_type>* Z[6] = {&k1,&k2,&k3,&k4,&k5,&k6};
+      Vector<number_type>* stage[6] = {&k1,&k2,&k3,&k4,&k5,&k6};
+      model.f(t,u,k1,first,last);
+      for (int s=1; s<6; s++)
+        {
+          for (size_type k=first; k<last; k++) tw[k] = t[k]+c[s]*h[k];
+          ensemble::combine(n,K,first,last,w,u,h,s,a[s],Z);
+          model.f(tw,w,*stage[s],first,last);
+        }
+
+      // order 4 and order 5 approximations
+      ensemble::combine(n,K,first,last,w,u,h,6,b,Z);
+      ensemble::combine(n,K,first,last,ww,u,h,6,bb,Z);
+
+      // error estimate in the euclidean norm of each member
+      for (size_type k=first; k<last; k++) tw[k] = time_type(0.0);
+      for (size_type i=0; i<n; i++)
+        for (size_type k=first; k<last; k++)
+          {
+            number_type d = w[i*K+k]-ww[i*K+k];
+            tw[k] += d*d;
+          }
+
+      for (size_type k=first; k<last; k++)
+        {
+          if (h[k]==time_type(0.0)) continue;
+          time_type error(sqrt(tw[k]));
+          time_type dt_opt(h[k]*pow(rho*TOL/error,0.2));
+          dt_opt = std::min(beta*h[k],std::max(alpha*h[k],dt_opt));
+          steps[k]++;
+          if (error<=TOL)
+            {
+              for (size_type i=0; i<n; i++) u[i*K+k] = ww[i*K+k];
+              t[k] += h[k];
+              // a step shortened to hit the final time does not reduce dt
+              if (h[k]==dt[k]) dt[k] = dt_opt;
+            }
+          else
+            {
+              rejected[k]++;
+              dt[k] = std::max(dt_opt,dt_min);
+            }
+        }
+    }
+
+    const M& model;
+    size_type n, K, nthreads;
+    time_type TOL, rho, alpha, beta, dt_min, T;
+    time_type c[6], a[6][6], b[6], bb[6];
+    mutable Vector<number_type> u, w, ww, k1, k2, k3, k4, k5, k6;
+    mutable Vector<time_type> t, tw, dt, h;
+    mutable std::vector<size_type> steps, rejected;
+    ensemble::WorkerPool<EnsembleRKF45> pool;
+  };
+
+} // namespace hdnum
+
+#endif
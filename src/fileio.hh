@@ -0,0 +1,762 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_FILEIO_HH
+#define HDNUM_FILEIO_HH
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+#include "exceptions.hh"
+#include "vector.hh"
+#include "densematrix.hh"
+
+/** @file
+ *  @brief low level helpers for fast file input and output
+ *
+ *  MappedFile gives read access to a whole file via mmap. BinaryOutput
+ *  and TextOutput collect data in a large buffer and write it in
+ *  chunks. BinaryHeader is the common header of the binary formats for
+ *  trajectories, matrices and vectors: it stores a magic string, an
+ *  endianness marker, type tags and up to three sizes. parseNumber
+ *  converts the tokens of text files without copying them into streams.
+ *
+ *  The file functions of Vector and DenseMatrix built on them are
+ *  declared here as well, so that the POSIX headers are only included
+ *  with this file and not with every user of the core containers.
+ */
+
+namespace hdnum {
+
+  /** @brief Read-only view of a file mapped into memory
+
+      Falls back to reading the file into a buffer if the file can
+      not be mapped.
+  */
+  class MappedFile
+  {
+  public:
+    explicit MappedFile (const std::string& filename)
+      : ptr(0), len(0), mapped(false)
+    {
+      int fd = ::open(filename.c_str(),O_RDONLY);
+      if (fd<0) HDNUM_THROW(IOError,"Could not open file " << filename);
+      struct stat st;
+      if (::fstat(fd,&st)!=0)
+        {
+          ::close(fd);
+          HDNUM_THROW(IOError,"Could not stat file " << filename);
+        }
+      len = st.st_size;
+      if (len>0)
+        {
+          void* p = ::mmap(0,len,PROT_READ,MAP_PRIVATE,fd,0);
+          if (p!=MAP_FAILED)
+            {
+              ::madvise(p,len,MADV_SEQUENTIAL);
+              ptr = static_cast<const char*>(p);
+              mapped = true;
+            }
+          else
+            {
+              buffer.resize(len);
+              std::size_t done = 0;
+              while (done<len)
+                {
+                  ssize_t r = ::read(fd,&buffer[done],len-done);
+                  if (r<=0) break;
+                  done += r;
+                }
+              if (done<len)
+                {
+                  ::close(fd);
+                  HDNUM_THROW(IOError,"Could not read file " << filename);
+                }
+              ptr = &buffer[0];
+            }
+        }
+      ::close(fd);
+    }
+
+    ~MappedFile ()
+    {
+      if (mapped) ::munmap(const_cast<char*>(ptr),len);
+    }
+
+    //! pointer to the first byte of the file
+    const char* data () const
+    {
+      return ptr;
+    }
+
+    //! size of the file in bytes
+    std::size_t size () const
+    {
+      return len;
+    }
+
+  private:
+    MappedFile (const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    const char* ptr;
+    std::size_t len;
+    bool mapped;
+    std::vector<char> buffer;
+  };
+
+  //! true if the file can be opened for reading
+  inline bool readable (const std::string& filename)
+  {
+    return ::access(filename.c_str(),R_OK)==0;
+  }
+
+
+  /** @brief Type tags of the number types supported by the binary formats
+
+      Other types have the tag 0 and can not be stored in binary form.
+  */
+  template<class T> struct BinaryType { enum { tag = 0 }; };
+  template<> struct BinaryType<float> { enum { tag = 1 }; };
+  template<> struct BinaryType<double> { enum { tag = 2 }; };
+  template<> struct BinaryType<long double> { enum { tag = 3 }; };
+  template<> struct BinaryType<int32_t> { enum { tag = 4 }; };
+  template<> struct BinaryType<int64_t> { enum { tag = 5 }; };
+  template<> struct BinaryType<uint64_t> { enum { tag = 6 }; };
+
+  //! reverse the byte order of count values of the given size
+  inline void byteswap (void* p, std::size_t bytes, std::size_t count=1)
+  {
+    char* c = static_cast<char*>(p);
+    for (std::size_t k=0; k<count; k++, c+=bytes)
+      for (std::size_t i=0; i<bytes/2; i++) std::swap(c[i],c[bytes-1-i]);
+  }
+
+
+  /** @brief close a writer in its destructor
+
+      Destructors are noexcept since C++11, an exception leaving one
+      calls std::terminate. The destructors of the writers therefore
+      discard the exceptions of close(), write errors are only reported
+      by an explicit call of close().
+  */
+  template<class W>
+  void close_nothrow (W& writer) noexcept
+  {
+    try
+      {
+        writer.close();
+      }
+    catch (...)
+      {
+      }
+  }
+
+
+  /** @brief Write binary data through a large buffer
+   */
+  class BinaryOutput
+  {
+  public:
+    explicit BinaryOutput (const std::string& filename, std::size_t chunk_=1<<20)
+      : file(std::fopen(filename.c_str(),"wb")), chunk(chunk_)
+    {
+      if (!file) HDNUM_THROW(IOError,"Could not open file " << filename);
+      buffer.reserve(chunk);
+    }
+
+    ~BinaryOutput ()
+    {
+      close_nothrow(*this);
+    }
+
+    //! append bytes to the buffer, write the buffer when it is full
+    void write (const void* p, std::size_t bytes)
+    {
+      if (buffer.size()+bytes>chunk) flush();
+      if (bytes>chunk)
+        {
+          if (std::fwrite(p,1,bytes,file)!=bytes)
+            HDNUM_THROW(IOError,"Write error");
+        }
+      else
+        buffer.insert(buffer.end(),static_cast<const char*>(p),static_cast<const char*>(p)+bytes);
+    }
+
+    //! overwrite bytes at a position before the current end of the file
+    void write_at (std::size_t offset, const void* p, std::size_t bytes)
+    {
+      flush();
+      long pos = std::ftell(file);
+      if (pos<0 || std::fseek(file,offset,SEEK_SET)!=0)
+        HDNUM_THROW(IOError,"Seek error");
+      if (std::fwrite(p,1,bytes,file)!=bytes)
+        HDNUM_THROW(IOError,"Write error");
+      if (std::fseek(file,pos,SEEK_SET)!=0)
+        HDNUM_THROW(IOError,"Seek error");
+    }
+
+    void flush ()
+    {
+      if (buffer.size()>0)
+        {
+          if (std::fwrite(&buffer[0],1,buffer.size(),file)!=buffer.size())
+            HDNUM_THROW(IOError,"Write error");
+          buffer.clear();
+        }
+    }
+
+    //! write the buffer and close the file, throws IOError on write errors
+    void close ()
+    {
+      if (!file) return;
+      try
+        {
+          flush();
+        }
+      catch (...)
+        {
+          std::fclose(file);
+          file = 0;
+          buffer.clear();
+          throw;
+        }
+      bool ok = std::fclose(file)==0;
+      file = 0;
+      if (!ok) HDNUM_THROW(IOError,"Write error");
+    }
+
+  private:
+    BinaryOutput (const BinaryOutput&) = delete;
+    BinaryOutput& operator= (const BinaryOutput&) = delete;
+
+    std::FILE* file;
+    std::size_t chunk;
+    std::vector<char> buffer;
+  };
+
+
+  /** @brief Header of the binary file formats (48 bytes)
+
+      magic (8 bytes), endianness marker, version, two type tags
+      (uint32) and three sizes (uint64), all in the byte order of the
+      writing machine.
+  */
+  struct BinaryHeader
+  {
+    enum { bytes = 48, marker = 0x01020304, version_number = 1 };
+
+    char magic[8];
+    uint32_t endian, version, type1, type2;
+    uint64_t n[3];
+    bool swap; //!< set by read when the file has the other byte order
+
+    BinaryHeader (const char* magic_, uint32_t type1_, uint32_t type2_,
+                  uint64_t n0, uint64_t n1=0, uint64_t n2=0)
+      : endian(marker), version(version_number), type1(type1_), type2(type2_), swap(false)
+    {
+      std::memcpy(magic,magic_,8);
+      n[0] = n0; n[1] = n1; n[2] = n2;
+    }
+
+    void write (BinaryOutput& out) const
+    {
+      out.write(magic,8);
+      out.write(&endian,4);
+      out.write(&version,4);
+      out.write(&type1,4);
+      out.write(&type2,4);
+      out.write(n,24);
+    }
+
+    //! read header from memory and check magic and types
+    void read (const char* p, std::size_t size, const std::string& filename)
+    {
+      if (size<std::size_t(bytes) || std::memcmp(p,magic,8)!=0)
+        HDNUM_THROW(IOError,filename << " is not a file of type " << std::string(magic,8));
+      uint32_t expected1(type1), expected2(type2);
+      std::memcpy(&endian,p+8,4);
+      std::memcpy(&version,p+12,4);
+      std::memcpy(&type1,p+16,4);
+      std::memcpy(&type2,p+20,4);
+      std::memcpy(n,p+24,24);
+      swap = (endian!=uint32_t(marker));
+      if (swap)
+        {
+          byteswap(&endian,4);
+          if (endian!=uint32_t(marker))
+            HDNUM_THROW(IOError,filename << ": invalid endianness marker");
+          byteswap(&version,4);
+          byteswap(&type1,4);
+          byteswap(&type2,4);
+          byteswap(n,8,3);
+        }
+      if (version!=uint32_t(version_number))
+        HDNUM_THROW(IOError,filename << ": unsupported version " << version);
+      if (type1!=expected1 || type2!=expected2)
+        HDNUM_THROW(IOError,filename << ": stored number types (" << type1 << "," << type2
+                    << ") do not match requested types (" << expected1 << "," << expected2 << ")");
+    }
+  };
+
+
+  //! true for the whitespace characters separating numbers in text files
+  inline bool isBlank (char c)
+  {
+    return c==' ' || c=='\t' || c=='\n' || c=='\r' || c=='\v' || c=='\f';
+  }
+
+  //! advance p over blanks, stop at the end of the line if stop_at_newline is set
+  inline const char* skipBlanks (const char* p, const char* end, bool stop_at_newline=false)
+  {
+    while (p<end && isBlank(*p) && !(stop_at_newline && *p=='\n')) p++;
+    return p;
+  }
+
+  //! advance p to the first blank after a token
+  inline const char* skipToken (const char* p, const char* end)
+  {
+    while (p<end && !isBlank(*p)) p++;
+    return p;
+  }
+
+  namespace detail {
+
+    // strtod-like conversion of the token [begin,end), which needs
+    // not be null terminated
+    template<class T, class F>
+    inline T convert_token (const char* begin, const char* end, F convert)
+    {
+      char local[64];
+      std::size_t n = end-begin;
+      if (n<sizeof(local))
+        {
+          std::memcpy(local,begin,n);
+          local[n] = 0;
+          return convert(local);
+        }
+      std::string s(begin,end);
+      return convert(s.c_str());
+    }
+
+    inline double call_strtod (const char* s)
+    {
+      return std::strtod(s,0);
+    }
+
+    inline float call_strtof (const char* s)
+    {
+      return std::strtof(s,0);
+    }
+
+    inline long double call_strtold (const char* s)
+    {
+      return std::strtold(s,0);
+    }
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    // from_chars rejects a leading '+', tokens it can not convert
+    // completely (hex floats, trailing garbage, overflow) are left
+    // to strtod
+    template<class T, class F>
+    inline T parse_token (const char* begin, const char* end, F convert)
+    {
+      const char* p = (begin<end && *begin=='+') ? begin+1 : begin;
+      T x;
+      std::from_chars_result r = std::from_chars(p,end,x);
+      if (r.ec==std::errc() && r.ptr==end) return x;
+      return convert_token<T>(begin,end,convert);
+    }
+#else
+    template<class T, class F>
+    inline T parse_token (const char* begin, const char* end, F convert)
+    {
+      return convert_token<T>(begin,end,convert);
+    }
+#endif
+
+  } // namespace detail
+
+  /** @brief Convert the token [begin,end) to a number
+
+      Behaves like atof: the longest valid prefix is converted and
+      invalid input gives zero. Uses std::from_chars for the builtin
+      types if available. Other types are converted from double.
+  */
+  inline void parseNumber (const char* begin, const char* end, double& x)
+  {
+    x = detail::parse_token<double>(begin,end,detail::call_strtod);
+  }
+
+  inline void parseNumber (const char* begin, const char* end, float& x)
+  {
+    x = detail::parse_token<float>(begin,end,detail::call_strtof);
+  }
+
+  inline void parseNumber (const char* begin, const char* end, long double& x)
+  {
+    x = detail::parse_token<long double>(begin,end,detail::call_strtold);
+  }
+
+  template<class REAL>
+  inline void parseNumber (const char* begin, const char* end, REAL& x)
+  {
+    x = REAL(detail::convert_token<double>(begin,end,detail::call_strtod));
+  }
+
+
+  /** @brief Formatted text output through a large buffer
+
+      Numbers are written in scientific notation like an ostream with
+      std::scientific, std::showpoint and std::setprecision(p). For the
+      builtin floating point types std::to_chars (if available) or
+      snprintf is used, other types go through a stringstream.
+  */
+  class TextOutput
+  {
+  public:
+    explicit TextOutput (const std::string& filename, std::size_t chunk_=1<<20)
+      : file(std::fopen(filename.c_str(),"w")), chunk(chunk_), pos(0), buffer(chunk_+256)
+    {
+      if (!file) HDNUM_THROW(IOError,"Could not open file " << filename);
+    }
+
+    ~TextOutput ()
+    {
+      close_nothrow(*this);
+    }
+
+    void put (char c)
+    {
+      buffer[pos++] = c;
+      if (pos>=chunk) flush();
+    }
+
+    void put (const char* s)
+    {
+      while (*s) put(*s++);
+    }
+
+    //! write a number in scientific notation with p digits after the point
+    void put (double x, int p)
+    {
+      put_builtin(x,p);
+    }
+
+    void put (float x, int p)
+    {
+      put_builtin(x,p);
+    }
+
+    void put (long double x, int p)
+    {
+      if (p>64) p = 64;
+      pos += std::snprintf(&buffer[pos],buffer.size()-pos,"%#.*Le",p,x);
+      if (pos>=chunk) flush();
+    }
+
+    template<class REAL>
+    void put (const REAL& x, int p)
+    {
+      std::ostringstream s;
+      s << std::scientific << std::showpoint << std::setprecision(p) << x;
+      put(s.str().c_str());
+    }
+
+    void flush ()
+    {
+      if (pos>0)
+        {
+          if (std::fwrite(&buffer[0],1,pos,file)!=pos)
+            HDNUM_THROW(IOError,"Write error");
+          pos = 0;
+        }
+    }
+
+    //! write the buffer and close the file, throws IOError on write errors
+    void close ()
+    {
+      if (!file) return;
+      try
+        {
+          flush();
+        }
+      catch (...)
+        {
+          std::fclose(file);
+          file = 0;
+          pos = 0;
+          throw;
+        }
+      bool ok = std::fclose(file)==0;
+      file = 0;
+      if (!ok) HDNUM_THROW(IOError,"Write error");
+    }
+
+  private:
+    TextOutput (const TextOutput&) = delete;
+    TextOutput& operator= (const TextOutput&) = delete;
+
+    template<class T>
+    void put_builtin (T x, int p)
+    {
+      if (p>64) p = 64;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+      // to_chars omits the decimal point for p=0, showpoint keeps it
+      if (p>0)
+        {
+          std::to_chars_result r = std::to_chars(&buffer[pos],&buffer[0]+buffer.size(),x,
+                                                 std::chars_format::scientific,p);
+          pos = r.ptr-&buffer[0];
+        }
+      else
+#endif
+        pos += std::snprintf(&buffer[pos],buffer.size()-pos,"%#.*e",p,double(x));
+      if (pos>=chunk) flush();
+    }
+
+    std::FILE* file;
+    std::size_t chunk, pos;
+    std::vector<char> buffer;
+  };
+
+
+  /*!
+    \relates Vector
+    \brief Read vector from a text file
+
+    \param[in] filename name of the text file
+    \param[in,out] vector reference to a Vector
+
+    \b Example:
+    \code
+    hdnum::Vector<number> x;
+    readVectorFromFile("x.dat", x );
+    std::cout << "x=" << x << std::endl;
+    \endcode
+
+    \b Output:
+    \verbatim
+    Contents of "x.dat":
+    1.0
+    2.0
+    3.0
+
+    would give:
+    x=
+    [ 0]  1.0000000e+00
+    [ 1]  2.0000000e+00
+    [ 2]  3.0000000e+00
+    \endverbatim
+  */
+  template<typename REAL>
+  inline void readVectorFromFile (const std::string& filename, Vector<REAL> &vector)
+  {
+    if (!readable(filename)) HDNUM_ERROR("Could not open file!");
+    MappedFile file(filename);
+    const char* begin = file.data();
+    const char* end = begin+file.size();
+
+    // first pass: count the entries
+    std::size_t n = 0;
+    for (const char* p=skipBlanks(begin,end); p<end; p=skipBlanks(skipToken(p,end),end))
+      n++;
+
+    // second pass: convert the entries
+    std::size_t i = vector.size();
+    vector.resize(i+n);
+    for (const char* p=skipBlanks(begin,end); p<end; i++)
+      {
+        const char* q = skipToken(p,end);
+        parseNumber(p,q,vector[i]);
+        p = skipBlanks(q,end);
+      }
+  }
+
+
+  /*!
+    \relates Vector
+    \brief Write vector to a binary file
+
+    The file starts with a header containing an endianness marker, the
+    type of the entries and the size, followed by the raw entries. Only
+    float, double and long double vectors can be written.
+
+    \param[in] filename name of the binary file
+    \param[in] x the Vector
+  */
+  template<typename REAL>
+  inline void writeVectorToBinaryFile (const std::string& filename, const Vector<REAL> &x)
+  {
+    static_assert(int(BinaryType<REAL>::tag)!=0, "writeVectorToBinaryFile: REAL must be a builtin type");
+    BinaryOutput out(filename);
+    BinaryHeader header("HDNUMVEC",BinaryType<REAL>::tag,0,x.size());
+    header.write(out);
+    if (x.size()>0) out.write(&x[0],x.size()*sizeof(REAL));
+  }
+
+
+  /*!
+    \relates Vector
+    \brief Read vector from a binary file written by writeVectorToBinaryFile
+
+    The vector is resized to the size stored in the file. Files written
+    on a machine with different byte order are converted.
+
+    \param[in] filename name of the binary file
+    \param[out] x reference to a Vector
+  */
+  template<typename REAL>
+  inline void readVectorFromBinaryFile (const std::string& filename, Vector<REAL> &x)
+  {
+    MappedFile file(filename);
+    BinaryHeader header("HDNUMVEC",BinaryType<REAL>::tag,0,0);
+    header.read(file.data(),file.size(),filename);
+    std::size_t n = header.n[0];
+    if (file.size()<BinaryHeader::bytes+n*sizeof(REAL))
+      HDNUM_THROW(IOError,filename << " is truncated");
+    x.resize(n);
+    if (n==0) return;
+    std::memcpy(&x[0],file.data()+BinaryHeader::bytes,n*sizeof(REAL));
+    if (header.swap) byteswap(&x[0],sizeof(REAL),n);
+  }
+
+
+  /*!
+    \relates DenseMatrix
+    \brief Read matrix from a text file
+
+    \param[in] filename name of the text file
+    \param[in,out] A reference to a DenseMatrix
+
+	\b Example:
+	\code
+    hdnum::DenseMatrix<number> L;
+    readMatrixFromFile("matrixL.dat", L );
+    std::cout << "L=" << L << std::endl;
+	\endcode
+
+	\b Output:
+	\verbatim
+    Contents of "matrixL.dat":
+    1.000e+00  0.000e+00  0.000e+00
+    2.000e+00  1.000e+00  0.000e+00
+    3.000e+00  2.000e+00  1.000e+00
+
+    would give:
+    L=
+    0          1          2
+    0   1.000e+00  0.000e+00  0.000e+00
+    1   2.000e+00  1.000e+00  0.000e+00
+    2   3.000e+00  2.000e+00  1.000e+00
+	\endverbatim
+  */
+  template<typename REAL>
+  inline void readMatrixFromFile (const std::string& filename, DenseMatrix<REAL> &A)
+  {
+    if (!readable(filename)) HDNUM_ERROR("Could not open file!");
+    MappedFile file(filename);
+    const char* begin = file.data();
+    const char* end = begin+file.size();
+
+    // first pass: count rows and columns, empty lines are skipped
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    std::size_t line = 0;
+    for (const char* p=begin; p<end; line++)
+      {
+        std::size_t n = 0;
+        for (p=skipBlanks(p,end,true); p<end && *p!='\n'; p=skipBlanks(p,end,true))
+          {
+            p = skipToken(p,end);
+            n++;
+          }
+        if (p<end) p++;
+        if (n==0) continue;
+        if (rows==0) cols = n;
+        else if (n!=cols)
+          HDNUM_ERROR(filename << ": line " << line+1 << " has " << n
+                      << " entries, expected " << cols);
+        rows++;
+      }
+    if (rows==0) return;
+    if (A.rowsize()>0 && A.colsize()!=cols)
+      HDNUM_ERROR(filename << ": " << cols << " columns do not fit to matrix with "
+                  << A.colsize() << " columns");
+
+    // second pass: convert the entries, the rows are appended to A
+    std::size_t first = A.rowsize();
+    A.resize(first+rows,cols);
+    typename DenseMatrix<REAL>::VectorIterator it = A[first];
+    for (const char* p=skipBlanks(begin,end); p<end; ++it)
+      {
+        const char* q = skipToken(p,end);
+        parseNumber(p,q,*it);
+        p = skipBlanks(q,end);
+      }
+  }
+
+
+  /*!
+    \relates DenseMatrix
+    \brief Write matrix to a binary file
+
+    The file starts with a header containing an endianness marker, the
+    type of the entries and the sizes, followed by the entries row by
+    row. Only float, double and long double matrices can be written.
+
+    \param[in] filename name of the binary file
+    \param[in] A the DenseMatrix
+  */
+  template<typename REAL>
+  inline void writeMatrixToBinaryFile (const std::string& filename, const DenseMatrix<REAL> &A)
+  {
+    static_assert(int(BinaryType<REAL>::tag)!=0, "writeMatrixToBinaryFile: REAL must be a builtin type");
+    BinaryOutput out(filename);
+    BinaryHeader header("HDNUMMAT",BinaryType<REAL>::tag,0,A.rowsize(),A.colsize());
+    header.write(out);
+    if (A.rowsize()*A.colsize()>0)
+      out.write(&A(0,0),A.rowsize()*A.colsize()*sizeof(REAL));
+  }
+
+
+  /*!
+    \relates DenseMatrix
+    \brief Read matrix from a binary file written by writeMatrixToBinaryFile
+
+    A is resized to the sizes stored in the file. Files written on a
+    machine with different byte order are converted.
+
+    \param[in] filename name of the binary file
+    \param[out] A reference to a DenseMatrix
+  */
+  template<typename REAL>
+  inline void readMatrixFromBinaryFile (const std::string& filename, DenseMatrix<REAL> &A)
+  {
+    MappedFile file(filename);
+    BinaryHeader header("HDNUMMAT",BinaryType<REAL>::tag,0,0);
+    header.read(file.data(),file.size(),filename);
+    std::size_t rows = header.n[0], cols = header.n[1];
+    if (file.size()<BinaryHeader::bytes+rows*cols*sizeof(REAL))
+      HDNUM_THROW(IOError,filename << " is truncated");
+    A.resize(rows,cols);
+    if (rows*cols==0) return;
+    std::memcpy(&A(0,0),file.data()+BinaryHeader::bytes,rows*cols*sizeof(REAL));
+    if (header.swap) byteswap(&A(0,0),sizeof(REAL),rows*cols);
+  }
+
+} // namespace hdnum
+
+#endif
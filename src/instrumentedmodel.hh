@@ -0,0 +1,235 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_INSTRUMENTEDMODEL_HH
+#define HDNUM_INSTRUMENTEDMODEL_HH
+
+#include <vector>
+#include "vector.hh"
+#include "densematrix.hh"
+#include "statistics.hh"
+
+/** @file
+ *  @brief a model wrapper counting and timing the evaluations of any model
+ *
+ *  InstrumentedModel forwards to an ODE model (size, initialize, f,
+ *  f_x) or a nonlinear problem (size, F, F_x) and can be passed to
+ *  the solvers in its place. Comparing its evaluation time with the
+ *  total time of the solver separates the cost of the model from the
+ *  overhead of the solver, without changing the model.
+ */
+
+namespace hdnum {
+
+  namespace detail {
+
+    template<class T>
+    struct void_type
+    {
+      typedef void type;
+    };
+
+    // exports time_type if the model has one, nonlinear problems do not
+    template<class M, class = void>
+    struct ModelTimeType
+    {};
+
+    template<class M>
+    struct ModelTimeType<M,typename void_type<typename M::time_type>::type>
+    {
+      typedef typename M::time_type time_type;
+    };
+
+  } // namespace detail
+
+  /** @brief Counts and times the evaluations of a model
+
+      The evaluations of f and F are counted in fevals and time_f of
+      a SolverStatistics, those of f_x and F_x in jacobians and
+      time_jacobian; all other entries stay zero. Counting is always
+      on, the times are only measured with HDNUM_SOLVER_TIMING as in
+      the solvers, so that the clock does not slow down cheap models,
+      e.g. in WorkPrecision. For symplectic
+      methods f_velocity, usually the expensive force evaluation, is
+      counted as an evaluation of f while f_position is only forwarded.
+      Other members of the model are available through model().
+
+      With set_capacity(n) the last n evaluation points are kept in a
+      ring buffer. The wrapper is not thread safe.
+
+      \code
+      Model model;
+      InstrumentedModel<Model> counted(model);
+      RungeKutta4<InstrumentedModel<Model> > solver(counted);
+      ...
+      counted.get_statistics().report(std::cout);
+      \endcode
+
+      \tparam M the model type
+  */
+  template<class M>
+  class InstrumentedModel
+    : public detail::ModelTimeType<M>
+  {
+  public:
+    /** \brief export size_type */
+    typedef typename M::size_type size_type;
+
+    /** \brief export number_type */
+    typedef typename M::number_type number_type;
+
+    //! one recorded evaluation
+    struct Evaluation
+    {
+      const char* callback;           //!< "f", "f_x", "F" or "F_x"
+      number_type t;                  //!< time, zero for F and F_x
+      Vector<number_type> x;          //!< the state or iterate
+    };
+
+    //! constructor stores reference to the model
+    InstrumentedModel (const M& model_, size_type capacity_=0)
+      : wrapped(model_), capacity(capacity_), next(0)
+    {}
+
+    //! the wrapped model
+    const M& model () const
+    {
+      return wrapped;
+    }
+
+    //! return number of componentes for the model
+    std::size_t size () const
+    {
+      return wrapped.size();
+    }
+
+    //! set initial state including time value
+    template<class T>
+    void initialize (T& t0, Vector<number_type>& x0) const
+    {
+      wrapped.initialize(t0,x0);
+    }
+
+    //! model evaluation
+    template<class T>
+    void f (const T& t, const Vector<number_type>& x, Vector<number_type>& result) const
+    {
+      record("f",t,x);
+      StatisticsTimer timer(stats.time_f);
+      stats.fevals++;
+      wrapped.f(t,x,result);
+    }
+
+    //! jacobian evaluation needed for implicit solvers
+    template<class T>
+    void f_x (const T& t, const Vector<number_type>& x, DenseMatrix<number_type>& result) const
+    {
+      record("f_x",t,x);
+      StatisticsTimer timer(stats.time_jacobian);
+      stats.jacobians++;
+      wrapped.f_x(t,x,result);
+    }
+
+    //! position part of f for symplectic methods, not counted
+    template<class T>
+    void f_position (const T& t, const Vector<number_type>& x, Vector<number_type>& result) const
+    {
+      wrapped.f_position(t,x,result);
+    }
+
+    //! velocity part of f for symplectic methods, counted as f
+    template<class T>
+    void f_velocity (const T& t, const Vector<number_type>& x, Vector<number_type>& result) const
+    {
+      record("f",t,x);
+      StatisticsTimer timer(stats.time_f);
+      stats.fevals++;
+      wrapped.f_velocity(t,x,result);
+    }
+
+    //! exact solution of the wrapped model, e.g. for ordertest
+    template<class T>
+    void exact_solution (const T& t, Vector<number_type>& x) const
+    {
+      wrapped.exact_solution(t,x);
+    }
+
+    //! nonlinear residual
+    void F (const Vector<number_type>& x, Vector<number_type>& result) const
+    {
+      record("F",0.0,x);
+      StatisticsTimer timer(stats.time_f);
+      stats.fevals++;
+      wrapped.F(x,result);
+    }
+
+    //! jacobian of the nonlinear residual
+    void F_x (const Vector<number_type>& x, DenseMatrix<number_type>& result) const
+    {
+      record("F_x",0.0,x);
+      StatisticsTimer timer(stats.time_jacobian);
+      stats.jacobians++;
+      wrapped.F_x(x,result);
+    }
+
+    //! evaluations since construction or the last reset_statistics
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics and the recorded evaluations
+    void reset_statistics ()
+    {
+      stats.reset();
+      ring.clear();
+      next = 0;
+    }
+
+    //! keep the last n evaluation points, 0 switches recording off
+    void set_capacity (size_type n)
+    {
+      capacity = n;
+      ring.clear();
+      next = 0;
+    }
+
+    //! the recorded evaluations, oldest first
+    std::vector<Evaluation> get_evaluations () const
+    {
+      std::vector<Evaluation> result;
+      result.reserve(ring.size());
+      for (size_type i=0; i<ring.size(); i++)
+        result.push_back(ring[(next+i)%ring.size()]);
+      return result;
+    }
+
+  private:
+    template<class T>
+    void record (const char* callback, const T& t, const Vector<number_type>& x) const
+    {
+      if (capacity==0) return;
+      if (ring.size()<capacity)
+        {
+          Evaluation e;
+          e.callback = callback;
+          e.t = number_type(t);
+          e.x = x;
+          ring.push_back(e);
+          next = ring.size()%capacity;
+          return;
+        }
+      ring[next].callback = callback;
+      ring[next].t = number_type(t);
+      ring[next].x = x;
+      next = (next+1)%capacity;
+    }
+
+    const M& wrapped;
+    size_type capacity;
+    mutable std::vector<Evaluation> ring;
+    mutable size_type next;
+    mutable SolverStatistics stats;
+  };
+
+} // namespace hdnum
+
+#endif
@@ -3,6 +3,11 @@
 #define HDNUM_NEWTON_HH
 
 #include "lr.hh"
+#include "sparsity.hh"
+#include "profiler.hh"
+#include "statistics.hh"
+#include <limits>
+#include <memory>
 #include <type_traits>
 
 /** @file
@@ -57,6 +62,10 @@ namespace hdnum {
 
   /** @brief A generic problem class that can be set up with a lambda defining F(x)=0
 
+      The Jacobian is approximated by finite differences, column by
+      column or, if a sparsity pattern is given, with colored finite
+      differences.
+
       \tparam Lambda mapping a Vector to a Vector
       \tparam Vec    the type for the Vector
   */
@@ -66,6 +75,7 @@ namespace hdnum {
     Lambda lambda; // lambda defining the problem "lambda(x)=0"
     size_t s;
     typename Vec::value_type eps;
+    std::shared_ptr<const ColoredJacobian<typename Vec::value_type> > jacobian;
   
   public:
     /** \brief export size_type */
@@ -85,6 +95,14 @@ namespace hdnum {
       return s;
     }
 
+    //! use colored finite differences for the given pattern of the Jacobian
+    void set_sparsity (const SparsityPattern& pattern)
+    {
+      if (pattern.rowsize()!=s || pattern.colsize()!=s)
+        HDNUM_ERROR("GenericNonlinearProblem: sparsity pattern has wrong size");
+      jacobian = std::make_shared<const ColoredJacobian<number_type> >(pattern,eps);
+    }
+
     //! model evaluation
     void F (const Vec& x, Vec& result) const
     {
@@ -96,6 +114,11 @@ namespace hdnum {
     {
       Vec Fx(x.size());
       F(x,Fx);
+      if (jacobian)
+        {
+          jacobian->evaluate([this] (const Vec& z, Vec& Fz) { F(z,Fz); },x,Fx,result);
+          return;
+        }
       Vec z(x);
       Vec Fz(x.size());
     
@@ -126,6 +149,20 @@ namespace hdnum {
     return GenericNonlinearProblem<F,X>(f,x,eps);
   }
 
+  /** @brief A function returning a problem class with sparse Jacobian
+
+      \tparam F  a lambda mapping a Vector to a Vector
+      \tparam X  the type for the Vector
+  */
+  template<typename F, typename X>
+  GenericNonlinearProblem<F,X> getNonlinearProblem (const F& f, const X& x, const SparsityPattern& pattern,
+                                                    typename X::value_type eps = 1e-7)
+  {
+    GenericNonlinearProblem<F,X> problem(f,x,eps);
+    problem.set_sparsity(pattern);
+    return problem;
+  }
+
   /** @brief Solve nonlinear problem using a damped Newton method
 
       The Newton solver is parametrized by a model. The model also
@@ -192,9 +229,17 @@ namespace hdnum {
       Vector<N> s(model.size());              // scaling factors
       Vector<size_type> p(model.size());                 // row permutations
       Vector<size_type> q(model.size());                 // column permutations
+      HDNUM_PROFILE_REGION("Newton::solve");
+      StatisticsTimer timer(stats.time_total);
 
-      model.F(x,r);                                     // compute nonlinear residual
-      Real R0(std::abs(norm(r)));                          // norm of initial residual
+      {
+        HDNUM_PROFILE_REGION("residual");
+        StatisticsTimer ftimer(stats.time_f);
+        stats.fevals++;
+        model.F(x,r);                                   // compute nonlinear residual
+      }
+      using std::abs;
+      Real R0(abs(norm(r)));                               // norm of initial residual
       Real R(R0);                                // current residual norm
       if (verbosity>=1)
         {
@@ -215,24 +260,46 @@ namespace hdnum {
             } 
 
           // solve Jacobian system for update
-          model.F_x(x,A);                               // compute Jacobian matrix
-          row_equilibrate(A,s);                         // equilibrate rows
-          lr_fullpivot(A,p,q);                          // LR decomposition of A
-          z = N(0.0);                                   // clear solution
-          apply_equilibrate(s,r);                       // equilibration of right hand side
-          permute_forward(p,r);                         // permutation of right hand side
-          solveL(A,r,r);                                // forward substitution
-          solveR(A,z,r);                                // backward substitution
-          permute_backward(q,z);                        // backward permutation
+          stats.iterations++;
+          {
+            HDNUM_PROFILE_REGION("Jacobian");
+            StatisticsTimer jtimer(stats.time_jacobian);
+            stats.jacobians++;
+            model.F_x(x,A);                             // compute Jacobian matrix
+          }
+          {
+            HDNUM_PROFILE_REGION("factorization");
+            StatisticsTimer ltimer(stats.time_factorization);
+            stats.factorizations++;
+            row_equilibrate(A,s);                       // equilibrate rows
+            lr_fullpivot(A,p,q);                        // LR decomposition of A
+          }
+          {
+            HDNUM_PROFILE_REGION("linear solve");
+            StatisticsTimer stimer(stats.time_solve);
+            stats.linear_solves++;
+            z = N(0.0);                                 // clear solution
+            apply_equilibrate(s,r);                     // equilibration of right hand side
+            permute_forward(p,r);                       // permutation of right hand side
+            solveL(A,r,r);                              // forward substitution
+            solveR(A,z,r);                              // backward substitution
+            permute_backward(q,z);                      // backward permutation
+          }
 
           // line search
           Real lambda(1.0);                      // start with lambda=1
           for (size_type k=0; k<linesearchsteps; k++)
             {
+              HDNUM_PROFILE_REGION("line search");
               y = x;                                    
               y.update(-lambda,z);                       // y = x+lambda*z
-              model.F(y,r);                             // r = F(y)
-              Real newR(std::abs(norm(r)));                // compute norm
+              {
+                HDNUM_PROFILE_REGION("residual");
+                StatisticsTimer ftimer(stats.time_f);
+                stats.fevals++;
+                model.F(y,r);                           // r = F(y)
+              }
+              Real newR(abs(norm(r)));                     // compute norm
               if (verbosity>=3)
                 {
                   std::cout << "    line search "  << std::setw(2) << k 
@@ -299,6 +366,17 @@ namespace hdnum {
       return iterations_taken;
     }
 
+    //! work of all solves since construction or the last reset_statistics
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
 
   private:
     size_type maxit;
@@ -308,6 +386,738 @@ namespace hdnum {
     double reduction;
     double abslimit;
     mutable bool converged;
+    mutable SolverStatistics stats;
+  };
+
+
+
+
+  /** @brief Jacobian-free Newton-Krylov method with line search
+
+      Solves F(x)=0 like Newton, but only needs the model evaluation F.
+      The Newton equation is solved inexactly with restarted GMRES,
+      products of the Jacobian with a vector v are approximated by the
+      directional difference (F(x+hv)-F(x))/h. The relative tolerance
+      of GMRES (forcing term) is chosen by the second rule of Eisenstat
+      and Walker, eta_k = gamma (|F(x_k)|/|F(x_{k-1})|)^2, with the
+      usual safeguards. No matrix of size model.size()^2 is formed, so
+      the method can be used as solver S in IE and DIRK for large
+      systems.
+  */
+  class NewtonKrylov
+  {
+    typedef std::size_t size_type;
+
+  public:
+    //! constructor stores reference to the model
+    NewtonKrylov ()
+      : maxit(25), linesearchsteps(10), verbosity(0),
+        reduction(1e-14), abslimit(1e-30), restart(30), krylov_maxit(300),
+        eta_max(0.9), gamma(0.9), eps(1e-7), converged(false),
+        iterations_taken(0), linear_iterations(0)
+    {}
+
+    //! maximum number of iterations before giving up
+    void set_maxit (size_type n)
+    {
+      maxit = n;
+    }
+
+    //! maximum number of steps in linesearch before giving up
+    void set_linesearchsteps (size_type n)
+    {
+      linesearchsteps = n;
+    }
+
+    //! control output given 0=nothing, 1=summary, 2=every step, 3=include line search and GMRES
+    void set_verbosity (size_type n)
+    {
+      verbosity = n;
+    }
+
+    //! basolute limit for defect
+    void set_abslimit (double l)
+    {
+      abslimit = l;
+    }
+
+    //! reduction factor
+    void set_reduction (double l)
+    {
+      reduction = l;
+    }
+
+    //! dimension of the Krylov space before GMRES restarts
+    void set_restart (size_type m)
+    {
+      restart = m;
+    }
+
+    //! maximum number of GMRES iterations per Newton step
+    void set_krylov_maxit (size_type n)
+    {
+      krylov_maxit = n;
+    }
+
+    //! upper bound and factor gamma of the Eisenstat-Walker forcing terms
+    void set_forcing (double eta_max_, double gamma_=0.9)
+    {
+      eta_max = eta_max_;
+      gamma = gamma_;
+    }
+
+    //! relative size of the differencing step in Jacobian-vector products
+    void set_eps (double eps_)
+    {
+      eps = eps_;
+    }
+
+    //! do one step
+    template<class M>
+    void solve (const M& model, Vector<typename M::number_type> & x) const
+    {
+      typedef typename M::number_type N;
+      Vector<N> r(model.size());              // residual
+      Vector<N> y(model.size());              // temporary solution in line search
+      Vector<N> z(model.size());              // Newton update
+      StatisticsTimer timer(stats.time_total);
+
+      {
+        StatisticsTimer ftimer(stats.time_f);
+        stats.fevals++;
+        model.F(x,r);                                   // compute nonlinear residual
+      }
+      N R0(norm(r));                                    // norm of initial residual
+      N R(R0);                                          // current residual norm
+      N Rold(R0);                                       // residual norm of last step
+      N eta(eta_max);                                   // forcing term
+      if (verbosity>=1)
+        {
+          std::cout << "NewtonKrylov "
+                    << "   norm=" << std::scientific << std::showpoint
+                    << std::setprecision(4) << R0
+                    << std::endl;
+        }
+
+      converged = false;
+      iterations_taken = 0;
+      linear_iterations = 0;
+      for (size_type i=1; i<=maxit; i++)                // do Newton iterations
+        {
+          // check absolute size of residual
+          if (R<=abslimit)
+            {
+              converged = true;
+              return;
+            }
+
+          // forcing term, Eisenstat-Walker choice 2 with safeguards
+          if (i>1)
+            {
+              N etanew = N(gamma)*(R/Rold)*(R/Rold);
+              N etasafe = N(gamma)*eta*eta;
+              if (etasafe>N(0.1)) etanew = std::max(etanew,etasafe);
+              eta = std::min(etanew,N(eta_max));
+              // do not solve more accurately than needed for the final reduction
+              eta = std::max(eta,N(0.5)*N(reduction)*R0/R);
+            }
+
+          // solve J z = r inexactly
+          stats.iterations++;
+          {
+            StatisticsTimer stimer(stats.time_solve);
+            stats.linear_solves++;
+            gmres(model,x,r,R,eta,z);
+          }
+
+          // line search
+          N lambda(1.0);                                // start with lambda=1
+          Rold = R;
+          for (size_type k=0; k<linesearchsteps; k++)
+            {
+              y = x;
+              y.update(-lambda,z);                      // y = x+lambda*z
+              {
+                StatisticsTimer ftimer(stats.time_f);
+                stats.fevals++;
+                model.F(y,r);                           // r = F(y)
+              }
+              N newR(norm(r));                          // compute norm
+              if (verbosity>=3)
+                {
+                  std::cout << "    line search "  << std::setw(2) << k
+                            << " lambda=" << std::scientific << std::showpoint
+                            << std::setprecision(4) << lambda
+                            << " norm=" << std::scientific << std::showpoint
+                            << std::setprecision(4) << newR
+                            << " red=" << std::scientific << std::showpoint
+                            << std::setprecision(4) << newR/R
+                            << std::endl;
+                }
+              if (newR<(1.0-0.25*lambda)*R)             // check convergence
+                {
+                  if (verbosity>=2)
+                    {
+                      std::cout << "  step"  << std::setw(3) << i
+                                << " norm=" << std::scientific << std::showpoint
+                                << std::setprecision(4) << newR
+                                << " red=" << std::scientific << std::showpoint
+                                << std::setprecision(4) << newR/R
+                                << " eta=" << std::scientific << std::showpoint
+                                << std::setprecision(4) << eta
+                                << std::endl;
+                    }
+                  x = y;
+                  R = newR;
+                  break;                                // continue with Newton loop
+                }
+              else lambda *= 0.5;                       // reduce damping factor
+              if (k==linesearchsteps-1)
+                {
+                  if (verbosity>=3)
+                    std::cout << "    line search not converged within " << linesearchsteps << " steps" << std::endl;
+                  iterations_taken = i;
+                  return;
+                }
+            }
+
+          // check convergence
+          if (R<=reduction*R0)
+            {
+              if (verbosity>=1)
+                {
+                  std::cout << "NewtonKrylov converged in "  << i << " steps"
+                            << " reduction=" << std::scientific << std::showpoint
+                            << std::setprecision(4) << R/R0
+                            << " GMRES iterations=" << linear_iterations
+                            << std::endl;
+                }
+              iterations_taken = i;
+              converged = true;
+              return;
+            }
+          if (i==maxit)
+            {
+              iterations_taken = i;
+              if (verbosity>=1)
+                std::cout << "NewtonKrylov not converged within " << maxit << " iterations" << std::endl;
+            }
+        }
+    }
+
+    bool has_converged () const
+    {
+      return converged;
+    }
+
+    //! number of Newton iterations of the last solve
+    size_type iterations () const
+    {
+      return iterations_taken;
+    }
+
+    //! total number of GMRES iterations of the last solve
+    size_type get_linear_iterations () const
+    {
+      return linear_iterations;
+    }
+
+    /** @brief work of all solves since construction or the last reset_statistics
+
+        Each GMRES solve counts as one linear solve, its F evaluations
+        for the Jacobian-vector products are included in fevals and
+        its time in time_solve.
+    */
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
+  private:
+
+    // restarted GMRES for J(x) z = r with relative tolerance eta,
+    // Jacobian-vector products by directional differences
+    template<class M, class N>
+    void gmres (const M& model, const Vector<N>& x, const Vector<N>& r, N R, N eta,
+                Vector<N>& z) const
+    {
+      using std::sqrt;
+      using std::abs;
+      size_type n = x.size();
+      size_type m = std::max(restart,size_type(1));
+      std::vector<Vector<N> > V(m+1,Vector<N>(n));  // Krylov basis
+      std::vector<N> H((m+1)*m);                    // Hessenberg matrix, column-wise
+      std::vector<N> cs(m), sn(m), g(m+1);          // Givens rotations, rhs
+      Vector<N> w(n), xh(n), Fh(n), Fx(r);
+      N xnorm(norm(x));
+      N target(eta*R);
+      z = N(0.0);
+
+      size_type its = 0;
+      N beta(R);                                    // residual norm, starting from z=0
+      V[0] = r;
+      while (its<krylov_maxit && beta>target)
+        {
+          V[0] *= N(1.0)/beta;
+          std::fill(g.begin(),g.end(),N(0.0));
+          g[0] = beta;
+          size_type j = 0;
+          for (; j<m && its<krylov_maxit; j++, its++)
+            {
+              // w = J V[j] by a directional difference
+              N h(eps*(N(1.0)+xnorm));
+              xh = x;
+              xh.update(h,V[j]);
+              stats.fevals++;
+              model.F(xh,Fh);
+              for (size_type l=0; l<n; l++) w[l] = (Fh[l]-Fx[l])/h;
+
+              // modified Gram-Schmidt
+              for (size_type l=0; l<=j; l++)
+                {
+                  H[j*(m+1)+l] = w*V[l];
+                  w.update(-H[j*(m+1)+l],V[l]);
+                }
+              N wnorm(norm(w));
+              H[j*(m+1)+j+1] = wnorm;
+
+              // apply previous rotations and compute a new one
+              for (size_type l=0; l<j; l++)
+                {
+                  N a(H[j*(m+1)+l]), b(H[j*(m+1)+l+1]);
+                  H[j*(m+1)+l] = cs[l]*a+sn[l]*b;
+                  H[j*(m+1)+l+1] = -sn[l]*a+cs[l]*b;
+                }
+              N a(H[j*(m+1)+j]), b(H[j*(m+1)+j+1]);
+              N d(sqrt(a*a+b*b));
+              cs[j] = (d>N(0.0)) ? a/d : N(1.0);
+              sn[j] = (d>N(0.0)) ? b/d : N(0.0);
+              H[j*(m+1)+j] = d;
+              H[j*(m+1)+j+1] = N(0.0);
+              g[j+1] = -sn[j]*g[j];
+              g[j] = cs[j]*g[j];
+              beta = abs(g[j+1]);
+              if (verbosity>=3)
+                std::cout << "      GMRES " << std::setw(4) << its+1
+                          << " residual=" << std::scientific << std::showpoint
+                          << std::setprecision(4) << beta << std::endl;
+              if (beta<=target || wnorm==N(0.0))
+                {
+                  j++; its++;
+                  break;
+                }
+              V[j+1] = w;
+              V[j+1] *= N(1.0)/wnorm;
+            }
+
+          // solve the triangular system and update z
+          std::vector<N> c(j);
+          for (size_type l=j; l-->0; )
+            {
+              N s(g[l]);
+              for (size_type k=l+1; k<j; k++) s -= H[k*(m+1)+l]*c[k];
+              c[l] = s/H[l*(m+1)+l];
+            }
+          for (size_type l=0; l<j; l++) z.update(c[l],V[l]);
+
+          // residual r - J z for the restart
+          if (beta>target && its<krylov_maxit)
+            {
+              N znorm(norm(z));
+              N h(eps*(N(1.0)+xnorm)/znorm);
+              xh = x;
+              xh.update(h,z);
+              stats.fevals++;
+              model.F(xh,Fh);
+              for (size_type l=0; l<n; l++) V[0][l] = r[l]-(Fh[l]-Fx[l])/h;
+              beta = norm(V[0]);
+            }
+        }
+      linear_iterations += its;
+    }
+
+    size_type maxit;
+    size_type linesearchsteps;
+    size_type verbosity;
+    double reduction;
+    double abslimit;
+    size_type restart;
+    size_type krylov_maxit;
+    double eta_max;
+    double gamma;
+    double eps;
+    mutable bool converged;
+    mutable size_type iterations_taken;
+    mutable size_type linear_iterations;
+    mutable SolverStatistics stats;
+  };
+
+
+
+
+  /** @brief Solve nonlinear problem using Broyden's quasi-Newton method
+
+      Only one Jacobian is computed and factorized at the initial
+      guess, afterwards the inverse is approximated by rank one
+      updates. An iteration costs one evaluation of F and O(n^2+kn)
+      operations, k being the number of stored updates.
+
+      - "good" Broyden: H_{k+1} = H_k + (s-H_k y) s^T H_k/(s^T H_k y),
+        stored in product form
+      - "bad" Broyden:  H_{k+1} = H_k + (s-H_k y) y^T/(y^T y),
+        stored in additive form
+
+      with the step s = x_{k+1}-x_k and y = F(x_{k+1})-F(x_k). With
+      set_memory(m) at most m updates are kept, then the method
+      restarts from the initial Jacobian. If a step has to be damped,
+      the line search fails or the denominator of the update vanishes
+      up to rounding, the Jacobian is recomputed at the current iterate.
+  */
+  class Broyden
+  {
+    typedef std::size_t size_type;
+
+  public:
+    //! constructor selects the update, "good" or "bad"
+    Broyden (const std::string method="good")
+      : maxit(50), linesearchsteps(10), verbosity(0),
+        reduction(1e-14), abslimit(1e-30), memory(0), converged(false),
+        iterations_taken(0), jacobians(0)
+    {
+      if (method=="good") good = true;
+      else if (method=="bad") good = false;
+      else HDNUM_ERROR("Broyden: unknown method " << method);
+    }
+
+    //! maximum number of iterations before giving up
+    void set_maxit (size_type n)
+    {
+      maxit = n;
+    }
+
+    //! maximum number of steps in linesearch before giving up
+    void set_linesearchsteps (size_type n)
+    {
+      linesearchsteps = n;
+    }
+
+    //! control output given 0=nothing, 1=summary, 2=every step, 3=include line search
+    void set_verbosity (size_type n)
+    {
+      verbosity = n;
+    }
+
+    //! basolute limit for defect
+    void set_abslimit (double l)
+    {
+      abslimit = l;
+    }
+
+    //! reduction factor
+    void set_reduction (double l)
+    {
+      reduction = l;
+    }
+
+    //! maximum number of stored updates, 0 means no limit
+    void set_memory (size_type m)
+    {
+      memory = m;
+    }
+
+    //! do one step
+    template<class M>
+    void solve (const M& model, Vector<typename M::number_type> & x) const
+    {
+      typedef typename M::number_type N;
+      Vector<N> r(model.size());              // residual
+      Vector<N> rnew(model.size());           // residual at new iterate
+      Vector<N> y(model.size());              // temporary solution in line search
+      Vector<N> z(model.size());              // z = H_k r, x_{k+1} = x_k - lambda z
+      Vector<N> w(model.size());              // w = H_k r_{k+1}
+      DenseMatrix<N> A(model.size(),model.size()); // LR decomposition of initial Jacobian
+      Vector<N> s(model.size());              // scaling factors
+      Vector<size_type> p(model.size());      // row permutations
+      Vector<size_type> q(model.size());      // column permutations
+      std::vector<Vector<N> > U, V;           // stored updates
+      StatisticsTimer timer(stats.time_total);
+
+      evaluate(model,x,r);                              // compute nonlinear residual
+      N R0(norm(r));                                    // norm of initial residual
+      N R(R0);                                          // current residual norm
+      if (verbosity>=1)
+        {
+          std::cout << "Broyden "
+                    << "  norm=" << std::scientific << std::showpoint
+                    << std::setprecision(4) << R0
+                    << std::endl;
+        }
+
+      converged = false;
+      iterations_taken = 0;
+      jacobians = 0;
+      bool fresh = true;                                // H_k from a new Jacobian
+      factorize(model,x,A,s,p,q);
+      apply(A,s,p,q,U,V,r,z);
+      for (size_type i=1; i<=maxit; i++)                // do iterations
+        {
+          // check absolute size of residual
+          if (R<=abslimit)
+            {
+              converged = true;
+              return;
+            }
+          stats.iterations++;
+
+          // line search
+          N lambda(1.0);                                // start with lambda=1
+          bool accepted = false;
+          N newR(0.0);
+          for (size_type k=0; k<linesearchsteps; k++)
+            {
+              y = x;
+              y.update(-lambda,z);                      // y = x+lambda*z
+              evaluate(model,y,rnew);                   // r = F(y)
+              newR = norm(rnew);                        // compute norm
+              if (verbosity>=3)
+                {
+                  std::cout << "    line search "  << std::setw(2) << k
+                            << " lambda=" << std::scientific << std::showpoint
+                            << std::setprecision(4) << lambda
+                            << " norm=" << std::scientific << std::showpoint
+                            << std::setprecision(4) << newR
+                            << " red=" << std::scientific << std::showpoint
+                            << std::setprecision(4) << newR/R
+                            << std::endl;
+                }
+              if (newR<(1.0-0.25*lambda)*R)             // check convergence
+                {
+                  accepted = true;
+                  break;
+                }
+              lambda *= 0.5;                            // reduce damping factor
+            }
+          if (!accepted)
+            {
+              if (fresh)
+                {
+                  if (verbosity>=3)
+                    std::cout << "    line search not converged within " << linesearchsteps << " steps" << std::endl;
+                  iterations_taken = i;
+                  return;
+                }
+              // retry with a new Jacobian at the current iterate
+              if (verbosity>=2)
+                std::cout << "  step" << std::setw(3) << i << " new Jacobian" << std::endl;
+              U.clear(); V.clear();
+              factorize(model,x,A,s,p,q);
+              apply(A,s,p,q,U,V,r,z);
+              fresh = true;
+              continue;
+            }
+          if (verbosity>=2)
+            {
+              std::cout << "  step"  << std::setw(3) << i
+                        << " norm=" << std::scientific << std::showpoint
+                        << std::setprecision(4) << newR
+                        << " red=" << std::scientific << std::showpoint
+                        << std::setprecision(4) << newR/R
+                        << std::endl;
+            }
+
+          // check convergence
+          x = y;
+          R = newR;
+          if (R<=reduction*R0 || R<=abslimit)
+            {
+              if (verbosity>=1)
+                {
+                  std::cout << "Broyden converged in "  << i << " steps"
+                            << " reduction=" << std::scientific << std::showpoint
+                            << std::setprecision(4) << R/R0
+                            << " Jacobians=" << jacobians
+                            << std::endl;
+                }
+              iterations_taken = i;
+              converged = true;
+              return;
+            }
+          if (i==maxit)
+            {
+              iterations_taken = i;
+              if (verbosity>=1)
+                std::cout << "Broyden not converged within " << maxit << " iterations" << std::endl;
+              return;
+            }
+
+          // rank one update, with w = H_k F(x_{k+1}) one gets
+          // H_k y = w - z and s = -lambda z. Damped steps indicate a
+          // poor approximation and skip it.
+          bool restart = lambda<1.0;
+          if (!restart)
+            {
+              Vector<N> step(z);
+              step *= -lambda;                          // s = x_{k+1}-x_k
+              if (memory>0 && U.size()>=memory)
+                {
+                  // drop all updates, then z = H_0 r_k matches w = H_0 r_{k+1}
+                  U.clear(); V.clear();
+                  apply(A,s,p,q,U,V,r,z);
+                }
+              apply(A,s,p,q,U,V,rnew,w);
+              Vector<N> Hy(w);
+              Hy -= z;
+              Vector<N> u(step);
+              u -= Hy;                                  // u = s - H_k y
+              const N tiny(N(64.0)*std::numeric_limits<N>::epsilon());
+              if (good)
+                {
+                  N denom(step*Hy);
+                  if (abs(denom)>tiny*norm(step)*norm(Hy) && denom!=N(0.0))
+                    {
+                      u *= N(1.0)/denom;
+                      z = w;
+                      z.update(step*w,u);               // z = H_{k+1} r_{k+1}
+                      U.push_back(u);
+                      V.push_back(step);
+                    }
+                  else
+                    restart = true;
+                }
+              else
+                {
+                  Vector<N> yk(rnew);
+                  yk -= r;
+                  N denom(yk*yk);
+                  if (denom>N(0.0) && norm(yk)>tiny*norm(r))
+                    {
+                      u *= N(1.0)/denom;
+                      z = w;
+                      z.update(yk*rnew,u);              // z = H_{k+1} r_{k+1}
+                      U.push_back(u);
+                      V.push_back(yk);
+                    }
+                  else
+                    restart = true;
+                }
+            }
+
+          // start again with the Jacobian at the new iterate
+          if (restart)
+            {
+              if (verbosity>=2)
+                std::cout << "  step" << std::setw(3) << i << " new Jacobian" << std::endl;
+              U.clear(); V.clear();
+              factorize(model,x,A,s,p,q);
+              r = rnew;
+              apply(A,s,p,q,U,V,r,z);
+              fresh = true;
+              continue;
+            }
+          r = rnew;
+          fresh = false;
+        }
+    }
+
+    bool has_converged () const
+    {
+      return converged;
+    }
+
+    //! number of iterations of the last solve
+    size_type iterations () const
+    {
+      return iterations_taken;
+    }
+
+    //! number of Jacobians computed in the last solve
+    size_type get_jacobians () const
+    {
+      return jacobians;
+    }
+
+    /** @brief work of all solves since construction or the last reset_statistics
+
+        Applying the inverse approximation counts as a linear solve.
+    */
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
+  private:
+
+    // r = F(x)
+    template<class M, class N>
+    void evaluate (const M& model, const Vector<N>& x, Vector<N>& r) const
+    {
+      StatisticsTimer ftimer(stats.time_f);
+      stats.fevals++;
+      model.F(x,r);
+    }
+
+    // compute and factorize the Jacobian at x
+    template<class M, class N>
+    void factorize (const M& model, const Vector<N>& x, DenseMatrix<N>& A, Vector<N>& s,
+                    Vector<size_type>& p, Vector<size_type>& q) const
+    {
+      {
+        StatisticsTimer jtimer(stats.time_jacobian);
+        stats.jacobians++;
+        model.F_x(x,A);                                 // compute Jacobian matrix
+      }
+      StatisticsTimer ltimer(stats.time_factorization);
+      stats.factorizations++;
+      row_equilibrate(A,s);                             // equilibrate rows
+      lr_fullpivot(A,p,q);                              // LR decomposition of A
+      jacobians++;
+    }
+
+    // z = H r with H given by the initial Jacobian and the updates U, V
+    template<class N>
+    void apply (const DenseMatrix<N>& A, Vector<N>& s, const Vector<size_type>& p,
+                const Vector<size_type>& q, const std::vector<Vector<N> >& U,
+                const std::vector<Vector<N> >& V, const Vector<N>& r, Vector<N>& z) const
+    {
+      StatisticsTimer stimer(stats.time_solve);
+      stats.linear_solves++;
+      Vector<N> b(r);
+      std::vector<N> c(good ? 0 : U.size());
+      if (!good)
+        for (size_type i=0; i<U.size(); i++) c[i] = V[i]*b;
+      z = N(0.0);                                       // clear solution
+      apply_equilibrate(s,b);                           // equilibration of right hand side
+      permute_forward(p,b);                             // permutation of right hand side
+      solveL(A,b,b);                                    // forward substitution
+      solveR(A,z,b);                                    // backward substitution
+      permute_backward(q,z);                            // backward permutation
+      for (size_type i=0; i<U.size(); i++)
+        z.update(good ? V[i]*z : c[i],U[i]);
+    }
+
+    size_type maxit;
+    size_type linesearchsteps;
+    size_type verbosity;
+    double reduction;
+    double abslimit;
+    size_type memory;
+    bool good;
+    mutable bool converged;
+    mutable size_type iterations_taken;
+    mutable size_type jacobians;
+    mutable SolverStatistics stats;
   };
 
 
@@ -319,6 +1129,15 @@ namespace hdnum {
 
       \f[ x = x - \sigma*F(x) \f]
 
+      With set_anderson(m) the iteration is accelerated by Anderson
+      mixing: the new iterate is the combination of the last m+1
+      fixed point images whose residuals have the smallest norm. The
+      least squares problem is solved with a QR decomposition of the
+      residual differences that is updated when a column is added
+      and downdated with Givens rotations when the oldest one is
+      dropped, so an iteration costs O(mn) additional work. Old
+      differences are also dropped if they make the least squares
+      problem ill-conditioned.
   */
   class Banach
   {
@@ -328,7 +1147,8 @@ namespace hdnum {
     //! constructor stores reference to the model
     Banach ()
       : maxit(25), linesearchsteps(10), verbosity(0), 
-        reduction(1e-14), abslimit(1e-30),  sigma(1.0), converged(false)
+        reduction(1e-14), abslimit(1e-30),  sigma(1.0), anderson(0),
+        converged(false), iterations_taken(0)
     {}
 
     //! maximum number of iterations before giving up
@@ -343,6 +1163,12 @@ namespace hdnum {
       sigma = sigma_;
     }
 
+    //! number of previous iterates used in Anderson mixing, 0 switches it off
+    void set_anderson (size_type m)
+    {
+      anderson = m;
+    }
+
     //! maximum number of steps in linesearch before giving up
     void set_linesearchsteps (size_type n)
     {
@@ -375,7 +1201,24 @@ namespace hdnum {
       Vector<N> r(model.size());              // residual
       Vector<N> y(model.size());              // temporary solution in line search
 
-      model.F(x,r);                           // compute nonlinear residual
+      // history for Anderson mixing
+      size_type m = anderson;
+      Vector<N> f(model.size());              // f = -sigma F(x)
+      Vector<N> g(model.size());              // fixed point image g = x + f
+      Vector<N> fold, gold;                   // f and g of the previous iterate
+      std::vector<Vector<N> > Q(m);           // orthonormal basis of the differences of f
+      std::vector<Vector<N> > DG(m);          // differences of g, ring buffer
+      DenseMatrix<N> Rm(m,m);                 // triangular factor
+      Vector<N> gamma(m);                     // mixing coefficients
+      size_type k = 0;                        // number of stored differences
+      size_type head = 0;                     // position of the oldest difference in DG
+      StatisticsTimer timer(stats.time_total);
+
+      {
+        StatisticsTimer ftimer(stats.time_f);
+        stats.fevals++;
+        model.F(x,r);                         // compute nonlinear residual
+      }
       N R0(norm(r));                          // norm of initial residual
       N R(R0);                                // current residual norm
       if (verbosity>=1)
@@ -387,6 +1230,7 @@ namespace hdnum {
         }
 
       converged = false;
+      iterations_taken = 0;
       for (size_type i=1; i<=maxit; i++)                // do iterations
         {
           // check absolute size of residual
@@ -399,7 +1243,56 @@ namespace hdnum {
           // next iterate
           y = x;                                    
           y.update(-sigma,r);                       // y = x+lambda*z
-          model.F(y,r);                             // r = F(y)
+          if (m>0)
+            {
+              f = r;
+              f *= N(-sigma);
+              g = y;
+              if (i>1)
+                {
+                  Vector<N> df(f), dg(g);
+                  df -= fold;
+                  dg -= gold;
+                  // drop the oldest differences if the window is full, if
+                  // df is linear dependent or if R gets ill-conditioned
+                  bool added = false;
+                  while (!added)
+                    {
+                      if (k==m || (k>0 && !append(Q,Rm,k,df)))
+                        {
+                          downdate(Q,Rm,k);
+                          head = (head+1)%m;
+                          continue;
+                        }
+                      if (k==0 && !append(Q,Rm,k,df)) break;
+                      DG[(head+k)%m] = dg;
+                      k++;
+                      added = true;
+                    }
+                  while (k>1 && condition(Rm,k)>N(1e8))
+                    {
+                      downdate(Q,Rm,k);
+                      head = (head+1)%m;
+                    }
+                }
+              fold = f;
+              gold = g;
+
+              // minimize |f - sum_j gamma_j df_j|, y = g - sum_j gamma_j dg_j
+              for (size_type j=0; j<k; j++) gamma[j] = Q[j]*f;
+              for (size_type j=k; j-->0; )
+                {
+                  for (size_type l=j+1; l<k; l++) gamma[j] -= Rm[j][l]*gamma[l];
+                  gamma[j] /= Rm[j][j];
+                }
+              for (size_type j=0; j<k; j++) y.update(-gamma[j],DG[(head+j)%m]);
+            }
+          stats.iterations++;
+          {
+            StatisticsTimer ftimer(stats.time_f);
+            stats.fevals++;
+            model.F(y,r);                           // r = F(y)
+          }
           N newR(norm(r));                // compute norm
           if (verbosity>=2)
             {
@@ -412,6 +1305,7 @@ namespace hdnum {
             }
           x = y;                                // accept new iterate
           R = newR;                             // remember new norm
+          iterations_taken = i;
 
           // check convergence
           if (R<=reduction*R0 || R<=abslimit)
@@ -434,14 +1328,98 @@ namespace hdnum {
       return converged;
     }
 
+    //! number of iterations of the last solve
+    size_type iterations () const
+    {
+      return iterations_taken;
+    }
+
+    //! work of all solves since construction or the last reset_statistics
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
   private:
+
+    // add column v to the QR decomposition with k columns using modified
+    // Gram-Schmidt, returns false if v is numerically linear dependent
+    template<class N>
+    bool append (std::vector<Vector<N> >& Q, DenseMatrix<N>& Rm, size_type k, Vector<N> v) const
+    {
+      N vnorm(norm(v));
+      for (size_type j=0; j<k; j++)
+        {
+          Rm[j][k] = Q[j]*v;
+          v.update(-Rm[j][k],Q[j]);
+        }
+      N rkk(norm(v));
+      if (rkk<=N(1e-12)*vnorm || vnorm==N(0.0)) return false;
+      Rm[k][k] = rkk;
+      v *= N(1.0)/rkk;
+      Q[k] = v;
+      return true;
+    }
+
+    // estimate of the condition number of the triangular factor
+    template<class N>
+    N condition (const DenseMatrix<N>& Rm, size_type k) const
+    {
+      using std::abs;
+      N dmin(abs(Rm[0][0])), dmax(abs(Rm[0][0]));
+      for (size_type j=1; j<k; j++)
+        {
+          if (abs(Rm[j][j])<dmin) dmin = abs(Rm[j][j]);
+          if (abs(Rm[j][j])>dmax) dmax = abs(Rm[j][j]);
+        }
+      return dmax/dmin;
+    }
+
+    // remove the first column of the QR decomposition with k columns
+    template<class N>
+    void downdate (std::vector<Vector<N> >& Q, DenseMatrix<N>& Rm, size_type& k) const
+    {
+      using std::sqrt;
+      for (size_type j=0; j+1<k; j++)                   // shift columns, R becomes Hessenberg
+        for (size_type l=0; l<=j+1; l++) Rm[l][j] = Rm[l][j+1];
+      for (size_type j=0; j+1<k; j++)                   // restore triangular shape
+        {
+          N a(Rm[j][j]), b(Rm[j+1][j]);
+          N rho(sqrt(a*a+b*b));
+          N c(a/rho), s(b/rho);
+          Rm[j][j] = rho;
+          Rm[j+1][j] = N(0.0);
+          for (size_type l=j+1; l+1<k; l++)
+            {
+              N t1(Rm[j][l]), t2(Rm[j+1][l]);
+              Rm[j][l] = c*t1+s*t2;
+              Rm[j+1][l] = c*t2-s*t1;
+            }
+          Vector<N> q1(Q[j]);
+          Q[j] *= c;
+          Q[j].update(s,Q[j+1]);
+          Q[j+1] *= c;
+          Q[j+1].update(-s,q1);
+        }
+      k--;
+    }
+
     size_type maxit;
     size_type linesearchsteps;
     size_type verbosity;
     double reduction;
     double abslimit;
     double sigma;
+    size_type anderson;
     mutable bool converged;
+    mutable size_type iterations_taken;
+    mutable SolverStatistics stats;
   };
 
 } // namespace hdnum
@@ -0,0 +1,310 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_OBSERVER_HH
+#define HDNUM_OBSERVER_HH
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "vector.hh"
+#include "exceptions.hh"
+#include "fileio.hh"
+
+/** @file
+ *  @brief observers for the trajectories computed by ODE solvers
+ *
+ *  An observer attached to a solver is called with the new time, state
+ *  and the time step used after every accepted step. Observers can be
+ *  chained: the filters Decimator and Sampler forward a subset of the
+ *  steps to another observer. Recorder keeps the complete trajectory,
+ *  RingBuffer the last steps and FileWriter streams to a file, so that
+ *  long runs need not store all states.
+ */
+
+namespace hdnum {
+
+  /** @brief Interface for observers of accepted steps
+
+      \tparam T a type representing time values
+      \tparam N a type representing states
+  */
+  template<class T, class N>
+  class StepObserver
+  {
+  public:
+    virtual ~StepObserver () {}
+
+    //! called with time, state and time step used to compute the state
+    virtual void observe (T t, const Vector<N>& u, T dt) = 0;
+  };
+
+
+  /** @brief Base class of solvers notifying observers after accepted steps
+
+      \tparam S the solver type deriving from this class
+      \tparam T a type representing time values
+      \tparam N a type representing states
+  */
+  template<class S, class T, class N>
+  class Observable
+  {
+  public:
+    //! attach observer, it is called with the current state immediately
+    void attach (StepObserver<T,N>& observer)
+    {
+      observers.push_back(&observer);
+      const S& solver = static_cast<const S&>(*this);
+      observer.observe(solver.get_time(),solver.get_state(),solver.get_dt());
+    }
+
+    //! remove observer
+    void detach (StepObserver<T,N>& observer)
+    {
+      observers.erase(std::remove(observers.begin(),observers.end(),&observer),observers.end());
+    }
+
+  protected:
+    //! call all observers, to be used by the solver after an accepted step
+    void notify (T t, const Vector<N>& u, T dt) const
+    {
+      for (std::size_t i=0; i<observers.size(); i++)
+        observers[i]->observe(t,u,dt);
+    }
+
+  private:
+    std::vector<StepObserver<T,N>*> observers;
+  };
+
+
+  /** @brief Store the complete trajectory
+
+      \tparam T a type representing time values
+      \tparam N a type representing states
+  */
+  template<class T, class N>
+  class Recorder : public StepObserver<T,N>
+  {
+  public:
+    void observe (T t, const Vector<N>& u, T dt)
+    {
+      t_.push_back(t);
+      u_.push_back(u);
+      dt_.push_back(dt);
+    }
+
+    //! recorded time values
+    const std::vector<T>& times () const
+    {
+      return t_;
+    }
+
+    //! recorded states
+    const std::vector<Vector<N> >& states () const
+    {
+      return u_;
+    }
+
+    //! recorded time steps
+    const std::vector<T>& dts () const
+    {
+      return dt_;
+    }
+
+  private:
+    std::vector<T> t_;
+    std::vector<Vector<N> > u_;
+    std::vector<T> dt_;
+  };
+
+
+  /** @brief Forward every k-th step to another observer
+
+      \tparam T a type representing time values
+      \tparam N a type representing states
+  */
+  template<class T, class N>
+  class Decimator : public StepObserver<T,N>
+  {
+  public:
+    Decimator (StepObserver<T,N>& next_, std::size_t k_)
+      : next(next_), k(k_), count(0)
+    {
+      if (k==0) HDNUM_ERROR("Decimator: k must be positive");
+    }
+
+    void observe (T t, const Vector<N>& u, T dt)
+    {
+      if (count%k==0) next.observe(t,u,dt);
+      count++;
+    }
+
+  private:
+    StepObserver<T,N>& next;
+    std::size_t k, count;
+  };
+
+
+  /** @brief Forward the trajectory at equidistant times t0+j*delta
+
+      The states at the sampling times are obtained by linear
+      interpolation between the accepted steps, the time step passed
+      on is delta.
+
+      \tparam T a type representing time values
+      \tparam N a type representing states
+  */
+  template<class T, class N>
+  class Sampler : public StepObserver<T,N>
+  {
+  public:
+    Sampler (StepObserver<T,N>& next_, T t0_, T delta_)
+      : next(next_), t0(t0_), delta(delta_), j(0), first(true)
+    {
+      if (delta<=T(0.0)) HDNUM_ERROR("Sampler: delta must be positive");
+    }
+
+    void observe (T t, const Vector<N>& u, T dt)
+    {
+      T ts = t0+T(j)*delta;
+      if (first)
+        {
+          first = false;
+          while (ts<t-T(1e-12)*delta) ts = t0+T(++j)*delta;
+          using std::abs;
+          if (abs(ts-t)<=T(1e-12)*delta)
+            {
+              next.observe(ts,u,delta);
+              j++;
+            }
+        }
+      else
+        {
+          while (ts<=t+T(1e-12)*delta)
+            {
+              T theta = (ts-told)/(t-told);
+              us = uold;
+              us *= N(1.0)-N(theta);
+              us.update(N(theta),u);
+              next.observe(ts,us,delta);
+              ts = t0+T(++j)*delta;
+            }
+        }
+      told = t;
+      uold = u;
+    }
+
+  private:
+    StepObserver<T,N>& next;
+    T t0, delta, told;
+    std::size_t j;
+    bool first;
+    Vector<N> uold, us;
+  };
+
+
+  /** @brief Keep the last steps in a ring buffer of fixed capacity
+
+      \tparam T a type representing time values
+      \tparam N a type representing states
+  */
+  template<class T, class N>
+  class RingBuffer : public StepObserver<T,N>
+  {
+  public:
+    RingBuffer (std::size_t capacity_)
+      : capacity(capacity_), start(0), t_(capacity_), u_(capacity_), dt_(capacity_), count(0)
+    {
+      if (capacity==0) HDNUM_ERROR("RingBuffer: capacity must be positive");
+    }
+
+    void observe (T t, const Vector<N>& u, T dt)
+    {
+      std::size_t i = (start+count)%capacity;
+      if (count<capacity)
+        count++;
+      else
+        start = (start+1)%capacity;
+      t_[i] = t;
+      u_[i] = u;
+      dt_[i] = dt;
+    }
+
+    //! number of steps in the buffer
+    std::size_t size () const
+    {
+      return count;
+    }
+
+    //! time of entry i, i=0 is the oldest entry
+    T time (std::size_t i) const
+    {
+      return t_[(start+i)%capacity];
+    }
+
+    //! state of entry i, i=0 is the oldest entry
+    const Vector<N>& state (std::size_t i) const
+    {
+      return u_[(start+i)%capacity];
+    }
+
+    //! time step of entry i, i=0 is the oldest entry
+    T dt (std::size_t i) const
+    {
+      return dt_[(start+i)%capacity];
+    }
+
+  private:
+    std::size_t capacity, start;
+    std::vector<T> t_;
+    std::vector<Vector<N> > u_;
+    std::vector<T> dt_;
+    std::size_t count;
+  };
+
+
+  /** @brief Stream the trajectory to a file in the format of gnuplot()
+
+      Output is collected in a buffer of chunk bytes, the file is
+      complete after close() or destruction of the writer.
+
+      \tparam T a type representing time values
+      \tparam N a type representing states
+  */
+  template<class T, class N>
+  class FileWriter : public StepObserver<T,N>
+  {
+  public:
+    //! open file, with_dt adds the time step as last column
+    FileWriter (const std::string& fname, bool with_dt_=false, std::size_t chunk=1<<20)
+      : f(fname,chunk), with_dt(with_dt_)
+    {}
+
+    void observe (T t, const Vector<N>& u, T dt)
+    {
+      f.put(t,16);
+      for (typename Vector<N>::size_type i=0; i<u.size(); i++)
+        {
+          f.put(' ');
+          f.put(u[i],u.precision());
+        }
+      if (with_dt)
+        {
+          f.put(' ');
+          f.put(dt,16);
+        }
+      f.put('\n');
+    }
+
+    //! write buffered output and close the file
+    void close ()
+    {
+      f.close();
+    }
+
+  private:
+    TextOutput f;
+    bool with_dt;
+  };
+
+} // namespace hdnum
+
+#endif
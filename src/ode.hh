@@ -4,6 +4,8 @@
 
 #include<vector>
 #include "newton.hh"
+#include "observer.hh"
+#include "statistics.hh"
 
 /** @file
  *  @brief solvers for ordinary differential equations
@@ -21,6 +23,7 @@ namespace hdnum {
   */
   template<class M>
   class EE
+    : public Observable<EE<M>,typename M::time_type,typename M::number_type>
   {
   public:
     /** \brief export size_type */
@@ -49,9 +52,12 @@ namespace hdnum {
     //! do one step
     void step ()
     {
-      model.f(t,u,f);   // evaluate model
+      StatisticsTimer timer(stats.time_total);
+      evaluate_f(stats,model,t,u,f); // evaluate model
       u.update(dt,f);   // advance state
       t += dt;          // advance time
+      stats.steps++;
+      this->notify(t,u,dt);
     }
 
     //! set current state
@@ -85,11 +91,24 @@ namespace hdnum {
       return 1;
     }
 
+    //! work of all steps since construction or the last reset_statistics
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
   private:
     const M& model;
     time_type t, dt;
     Vector<number_type> u;
     Vector<number_type> f;
+    SolverStatistics stats;
   };
 
   /** @brief Modified Euler method (order 2 with 2 stages)
@@ -102,6 +121,7 @@ namespace hdnum {
   */
   template<class M>
   class ModifiedEuler
+    : public Observable<ModifiedEuler<M>,typename M::time_type,typename M::number_type>
   {
   public:
     /** \brief export size_type */
@@ -133,17 +153,21 @@ namespace hdnum {
     //! do one step
     void step ()
     {
+      StatisticsTimer timer(stats.time_total);
+
       // stage 1
-      model.f(t,u,k1);
+      evaluate_f(stats,model,t,u,k1);
 
       // stage 2
       w = u;
       w.update(dt*a21,k1);
-      model.f(t+c2*dt,w,k2);
+      evaluate_f(stats,model,t+c2*dt,w,k2);
 
       // final
       u.update(dt*b2,k2);
       t += dt;
+      stats.steps++;
+      this->notify(t,u,dt);
     }
 
     //! set current state
@@ -177,12 +201,25 @@ namespace hdnum {
       return 2;
     }
 
+    //! work of all steps since construction or the last reset_statistics
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
   private:
     const M& model;
     time_type t, dt;
     time_type c2,a21,b2;
     Vector<number_type> u,w;
     Vector<number_type> k1,k2;
+    SolverStatistics stats;
   };
 
 
@@ -196,6 +233,7 @@ namespace hdnum {
   */
   template<class M>
   class Heun2
+    : public Observable<Heun2<M>,typename M::time_type,typename M::number_type>
   {
   public:
     /** \brief export size_type */
@@ -228,18 +266,22 @@ namespace hdnum {
     //! do one step
     void step ()
     {
+      StatisticsTimer timer(stats.time_total);
+
       // stage 1
-      model.f(t,u,k1);
+      evaluate_f(stats,model,t,u,k1);
 
       // stage 2
       w = u;
       w.update(dt*a21,k1);
-      model.f(t+c2*dt,w,k2);
+      evaluate_f(stats,model,t+c2*dt,w,k2);
 
       // final
       u.update(dt*b1,k1);
       u.update(dt*b2,k2);
       t += dt;
+      stats.steps++;
+      this->notify(t,u,dt);
     }
 
     //! set current state
@@ -273,12 +315,25 @@ namespace hdnum {
       return 2;
     }
 
+    //! work of all steps since construction or the last reset_statistics
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
   private:
     const M& model;
     time_type t, dt;
     time_type c2,a21,b1,b2;
     Vector<number_type> u,w;
     Vector<number_type> k1,k2;
+    SolverStatistics stats;
   };
 
 
@@ -292,6 +347,7 @@ namespace hdnum {
   */
   template<class M>
   class Heun3
+    : public Observable<Heun3<M>,typename M::time_type,typename M::number_type>
   {
   public:
     /** \brief export size_type */
@@ -328,23 +384,27 @@ namespace hdnum {
     //! do one step
     void step ()
     {
+      StatisticsTimer timer(stats.time_total);
+
       // stage 1
-      model.f(t,u,k1);
+      evaluate_f(stats,model,t,u,k1);
 
       // stage 2
       w = u;
       w.update(dt*a21,k1);
-      model.f(t+c2*dt,w,k2);
+      evaluate_f(stats,model,t+c2*dt,w,k2);
 
       // stage 3
       w = u;
       w.update(dt*a32,k2);
-      model.f(t+c3*dt,w,k3);
+      evaluate_f(stats,model,t+c3*dt,w,k3);
 
       // final
       u.update(dt*b1,k1);
       u.update(dt*b3,k3);
       t += dt;
+      stats.steps++;
+      this->notify(t,u,dt);
     }
 
     //! set current state
@@ -378,12 +438,25 @@ namespace hdnum {
       return 3;
     }
 
+    //! work of all steps since construction or the last reset_statistics
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
   private:
     const M& model;
     time_type t, dt;
     time_type c2,c3,a21,a31,a32,b1,b2,b3;
     Vector<number_type> u,w;
     Vector<number_type> k1,k2,k3;
+    SolverStatistics stats;
   };
 
   /** @brief Kutta method (order 3 with 3 stages)
@@ -396,6 +469,7 @@ namespace hdnum {
   */
   template<class M>
   class Kutta3
+    : public Observable<Kutta3<M>,typename M::time_type,typename M::number_type>
   {
   public:
     /** \brief export size_type */
@@ -433,25 +507,29 @@ namespace hdnum {
     //! do one step
     void step ()
     {
+      StatisticsTimer timer(stats.time_total);
+
       // stage 1
-      model.f(t,u,k1);
+      evaluate_f(stats,model,t,u,k1);
 
       // stage 2
       w = u;
       w.update(dt*a21,k1);
-      model.f(t+c2*dt,w,k2);
+      evaluate_f(stats,model,t+c2*dt,w,k2);
 
       // stage 3
       w = u;
       w.update(dt*a31,k1);
       w.update(dt*a32,k2);
-      model.f(t+c3*dt,w,k3);
+      evaluate_f(stats,model,t+c3*dt,w,k3);
 
       // final
       u.update(dt*b1,k1);
       u.update(dt*b2,k2);
       u.update(dt*b3,k3);
       t += dt;
+      stats.steps++;
+      this->notify(t,u,dt);
     }
 
     //! set current state
@@ -485,12 +563,25 @@ namespace hdnum {
       return 3;
     }
 
+    //! work of all steps since construction or the last reset_statistics
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
   private:
     const M& model;
     time_type t, dt;
     time_type c2,c3,a21,a31,a32,b1,b2,b3;
     Vector<number_type> u,w;
     Vector<number_type> k1,k2,k3;
+    SolverStatistics stats;
   };
 
   /** @brief classical Runge-Kutta method (order 4 with 4 stages)
@@ -503,6 +594,7 @@ namespace hdnum {
   */
   template<class M>
   class RungeKutta4
+    : public Observable<RungeKutta4<M>,typename M::time_type,typename M::number_type>
   {
   public:
     /** \brief export size_type */
@@ -542,23 +634,25 @@ namespace hdnum {
     //! do one step
     void step ()
     {
+      StatisticsTimer timer(stats.time_total);
+
       // stage 1
-      model.f(t,u,k1);
+      evaluate_f(stats,model,t,u,k1);
 
       // stage 2
       w = u;
       w.update(dt*a21,k1);
-      model.f(t+c2*dt,w,k2);
+      evaluate_f(stats,model,t+c2*dt,w,k2);
 
       // stage 3
       w = u;
       w.update(dt*a32,k2);
-      model.f(t+c3*dt,w,k3);
+      evaluate_f(stats,model,t+c3*dt,w,k3);
 
       // stage 4
       w = u;
       w.update(dt*a43,k3);
-      model.f(t+c4*dt,w,k4);
+      evaluate_f(stats,model,t+c4*dt,w,k4);
 
       // final
       u.update(dt*b1,k1);
@@ -566,6 +660,8 @@ namespace hdnum {
       u.update(dt*b3,k3);
       u.update(dt*b4,k4);
       t += dt;
+      stats.steps++;
+      this->notify(t,u,dt);
     }
 
     //! set current state
@@ -599,12 +695,25 @@ namespace hdnum {
       return 4;
     }
 
+    //! work of all steps since construction or the last reset_statistics
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
   private:
     const M& model;
     time_type t, dt;
     time_type c2,c3,c4,a21,a32,a43,b1,b2,b3,b4;
     Vector<number_type> u,w;
     Vector<number_type> k1,k2,k3,k4;
+    SolverStatistics stats;
   };
 
   /** @brief Adaptive Runge-Kutta-Fehlberg method
@@ -613,6 +722,7 @@ namespace hdnum {
   */
   template<class M>
   class RKF45
+    : public Observable<RKF45<M>,typename M::time_type,typename M::number_type>
   {
   public:
     /** \brief export size_type */
@@ -627,8 +737,7 @@ namespace hdnum {
     //! constructor stores reference to the model
     RKF45 (const M& model_)
       : model(model_), u(model.size()), w(model.size()), ww(model.size()), k1(model.size()),
-        k2(model.size()), k3(model.size()), k4(model.size()), k5(model.size()), k6(model.size()),
-        steps(0), rejected(0)
+        k2(model.size()), k3(model.size()), k4(model.size()), k5(model.size()), k6(model.size())
     {
       TOL = time_type(0.0001);
       rho = time_type(0.8);
@@ -691,31 +800,99 @@ namespace hdnum {
       TOL = TOL_;
     }
 
+    //! set current state
+    void set_state (time_type t_, const Vector<number_type>& u_)
+    {
+      t = t_;
+      u = u_;
+    }
+
     //! do one step
     void step ()
     {
-      steps++;
+      HDNUM_PROFILE_REGION("RKF45::step");
+      StatisticsTimer timer(stats.time_total);
+      attempt();
+    }
+
+    //! get current state
+    const Vector<number_type>& get_state () const
+    {
+      return u;
+    }
 
+    //! get current time
+    time_type get_time () const
+    {
+      return t;
+    }
+
+    //! get dt used in last step (i.e. to compute current state)
+    time_type get_dt () const
+    {
+      return dt;
+    }
+
+    //! return consistency order of the method
+    size_type get_order () const
+    {
+      return 5;
+    }
+
+    //! number of accepted steps
+    size_type get_steps () const
+    {
+      return stats.steps;
+    }
+
+    //! number of rejected steps
+    size_type get_rejected () const
+    {
+      return stats.rejected;
+    }
+
+    //! work of all steps since construction or the last reset_statistics
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
+    //! print some information
+    void get_info () const
+    {
+      std::cout << "RKF45: steps=" << stats.steps+stats.rejected << " rejected=" << stats.rejected << std::endl;
+    }
+
+  private:
+    // try steps with decreasing dt until one is accepted
+    void attempt ()
+    {
       // stage 1
-      model.f(t,u,k1);
+      evaluate_f(stats,model,t,u,k1);
 
       // stage 2
       w = u;
       w.update(dt*a21,k1);
-      model.f(t+c2*dt,w,k2);
+      evaluate_f(stats,model,t+c2*dt,w,k2);
 
       // stage 3
       w = u;
       w.update(dt*a31,k1);
       w.update(dt*a32,k2);
-      model.f(t+c3*dt,w,k3);
+      evaluate_f(stats,model,t+c3*dt,w,k3);
 
       // stage 4
       w = u;
       w.update(dt*a41,k1);
       w.update(dt*a42,k2);
       w.update(dt*a43,k3);
-      model.f(t+c4*dt,w,k4);
+      evaluate_f(stats,model,t+c4*dt,w,k4);
 
       // stage 5
       w = u;
@@ -723,7 +900,7 @@ namespace hdnum {
       w.update(dt*a52,k2);
       w.update(dt*a53,k3);
       w.update(dt*a54,k4);
-      model.f(t+c5*dt,w,k5);
+      evaluate_f(stats,model,t+c5*dt,w,k5);
 
       // stage 6
       w = u;
@@ -732,7 +909,7 @@ namespace hdnum {
       w.update(dt*a63,k3);
       w.update(dt*a64,k4);
       w.update(dt*a65,k5);
-      model.f(t+c6*dt,w,k6);
+      evaluate_f(stats,model,t+c6*dt,w,k6);
 
       // compute order 4 approximation
       w = u;
@@ -762,47 +939,18 @@ namespace hdnum {
         {
           t += dt;
           u = ww;
+          stats.steps++;
+          this->notify(t,u,dt);
           dt = dt_opt;
         }
       else
         {
-          rejected++;
+          stats.rejected++;
           dt = dt_opt;
-          if (dt>dt_min) step();
+          if (dt>dt_min) attempt();
         }
     }
 
-    //! get current state
-    const Vector<number_type>& get_state () const
-    {
-      return u;
-    }
-
-    //! get current time
-    time_type get_time () const
-    {
-      return t;
-    }
-
-    //! get dt used in last step (i.e. to compute current state)
-    time_type get_dt () const
-    {
-      return dt;
-    }
-
-    //! return consistency order of the method
-    size_type get_order () const
-    {
-      return 5;
-    }
-
-    //! print some information
-    void get_info () const
-    {
-      std::cout << "RE: steps=" << steps << " rejected=" << rejected << std::endl;
-    }
-
-  private:
     const M& model;
     time_type t, dt;
     time_type TOL,rho,alpha,beta,dt_min;
@@ -812,7 +960,7 @@ namespace hdnum {
     time_type bb1,bb2,bb3,bb4,bb5,bb6; // 5th order
     Vector<number_type> u,w,ww;
     Vector<number_type> k1,k2,k3,k4,k5,k6;
-    mutable size_type steps, rejected;
+    SolverStatistics stats;
   };
 
 
@@ -823,6 +971,7 @@ namespace hdnum {
   */
   template<class M, class S>
   class RE
+    : public Observable<RE<M,S>,typename M::time_type,typename M::number_type>
   {
   public:
     /** \brief export size_type */
@@ -837,8 +986,7 @@ namespace hdnum {
     //! constructor stores reference to the model
     RE (const M& model_, S& solver_)
       : model(model_), solver(solver_), u(model.size()),
-        wlow(model.size()), whigh(model.size()), ww(model.size()),
-        steps(0), rejected(0)
+        wlow(model.size()), whigh(model.size()), ww(model.size())
     {
       model.initialize(t,u); // initialize state
       dt = 0.1;              // set initial time step
@@ -864,12 +1012,84 @@ namespace hdnum {
       TOL = TOL_;
     }
 
+    //! set current state
+    void set_state (time_type t_, const Vector<number_type>& u_)
+    {
+      t = t_;
+      u = u_;
+    }
+
     //! do one step
     void step ()
     {
-      // count steps done
-      steps++;
+      StatisticsTimer timer(stats.time_total);
+      SolverStatistics before(solver.get_statistics());
+      attempt();
+      stats.add_inner(solver.get_statistics()-before);
+    }
+
+    //! get current state
+    const Vector<number_type>& get_state () const
+    {
+      return u;
+    }
+
+    //! get current time
+    time_type get_time () const
+    {
+      return t;
+    }
+
+    //! get dt used in last step (i.e. to compute current state)
+    time_type get_dt () const
+    {
+      return dt;
+    }
+
+    //! return consistency order of the method
+    size_type get_order () const
+    {
+      return solver.get_order()+1;
+    }
+
+    //! number of accepted steps
+    size_type get_steps () const
+    {
+      return stats.steps;
+    }
+
+    //! number of rejected steps
+    size_type get_rejected () const
+    {
+      return stats.rejected;
+    }
+
+    /** @brief work of all steps since construction or the last reset_statistics
+
+        Steps are those of the extrapolation, evaluations and linear
+        algebra those of the underlying solver.
+    */
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
 
+    //! print some information
+    void get_info () const
+    {
+      std::cout << "RE: steps=" << stats.steps+stats.rejected << " rejected=" << stats.rejected << std::endl;
+    }
+
+  private:
+    // try steps with decreasing dt until one is accepted
+    void attempt ()
+    {
       // do 1 step with 2*dt
       time_type H(2.0*dt);
       solver.set_state(t,u);
@@ -899,54 +1119,25 @@ namespace hdnum {
           u *= two_power_m;
           u -= wlow;
           u /= two_power_m-1.0;
+          stats.steps++;
+          this->notify(t,u,H);
           dt = dt_opt;
         }
       else
         {
-          rejected++;
+          stats.rejected++;
           dt = dt_opt;
-          if (dt>dt_min) step();
+          if (dt>dt_min) attempt();
         }
     }
 
-    //! get current state
-    const Vector<number_type>& get_state () const
-    {
-      return u;
-    }
-
-    //! get current time
-    time_type get_time () const
-    {
-      return t;
-    }
-
-    //! get dt used in last step (i.e. to compute current state)
-    time_type get_dt () const
-    {
-      return dt;
-    }
-
-    //! return consistency order of the method
-    size_type get_order () const
-    {
-      return solver.get_order()+1;
-    }
-
-    //! print some information
-    void get_info () const
-    {
-      std::cout << "RE: steps=" << steps << " rejected=" << rejected << std::endl;
-    }
-
-  private:
     const M& model;
     S& solver;
     time_type t, dt;
     time_type two_power_m;
     Vector<number_type> u,wlow,whigh,ww;
     time_type TOL,rho,alpha,beta,dt_min;
-    mutable size_type steps, rejected;
+    SolverStatistics stats;
   };
 
 
@@ -961,6 +1152,7 @@ namespace hdnum {
   */
   template<class M, class S>
   class IE
+    : public Observable<IE<M,S>,typename M::time_type,typename M::number_type>
   {
     //! class providing nonlinear problem to be solved
     // h_n f(t_n, y_n) - y_n + y_{n-1} = 0
@@ -1048,6 +1240,8 @@ namespace hdnum {
     //! do one step
     void step ()
     {
+      HDNUM_PROFILE_REGION("IE::step");
+      StatisticsTimer timer(stats.time_total);
       if (verbosity>=2)
         std::cout << "IE: step" << " t=" << t << " dt=" << dt << std::endl;
       NonlinearProblem nlp(model,u,t+dt,dt);
@@ -1056,11 +1250,15 @@ namespace hdnum {
       while (1)
         {
           unew = u;
+          SolverStatistics before(newton.get_statistics());
           newton.solve(nlp,unew);
+          stats.add_inner(newton.get_statistics()-before);
           if (newton.has_converged())
             {
               u = unew;
               t += dt;
+              stats.steps++;
+              this->notify(t,u,dt);
               if (!reduced && dt<dtmax-1e-13)
                 {
                   dt = std::min(2.0*dt,dtmax);
@@ -1077,6 +1275,7 @@ namespace hdnum {
                   error = true;
                   break;
                 }
+              stats.rejected++;
               dt *= 0.5;
               reduced = true;
               nlp.set_tnew_dt(t+dt,dt);
@@ -1122,6 +1321,23 @@ namespace hdnum {
       return 1;
     }
 
+    /** @brief work of all steps since construction or the last reset_statistics
+
+        Steps whose nonlinear system could not be solved count as
+        rejected, evaluations and linear algebra are those of the
+        nonlinear solver.
+    */
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
     //! print some information
     void get_info () const
     {
@@ -1137,6 +1353,7 @@ namespace hdnum {
     Vector<number_type> u;
     Vector<number_type> unew;
     mutable bool error;
+    SolverStatistics stats;
   };
 
   /** @brief Implementation of a general Diagonal Implicit Runge-Kutta
@@ -1151,6 +1368,7 @@ namespace hdnum {
   */
   template<class M, class S>
   class DIRK
+    : public Observable<DIRK<M,S>,typename M::time_type,typename M::number_type>
   {
   public:
 
@@ -1388,6 +1606,8 @@ namespace hdnum {
     //! do one step
     void step ()
     {
+      HDNUM_PROFILE_REGION("DIRK::step");
+      StatisticsTimer timer(stats.time_total);
 
       const size_type R = butcher.colsize()-1;
 
@@ -1414,7 +1634,9 @@ namespace hdnum {
             // Solve nonlinear problem
             NonlinearProblem nlp(model,u,t,dt,butcher,i,k);
 
+            SolverStatistics before(newton.get_statistics());
             newton.solve(nlp,current_z);
+            stats.add_inner(newton.get_statistics()-before);
 
             converged = converged && newton.has_converged();
             if(!converged)
@@ -1423,7 +1645,7 @@ namespace hdnum {
             current_z.update(1., u);
             const number_type t_i = t + butcher[i][0] * dt;
             Vector<number_type>current_k(model.size(),0.);
-            model.f(t_i,current_z,current_k);
+            evaluate_f(stats,model,t_i,current_z,current_k);
 
             k.push_back( current_k );
           }
@@ -1438,6 +1660,8 @@ namespace hdnum {
                 u.update(dt*butcher[R][1+i],k[i]);
 
               t += dt;
+              stats.steps++;
+              this->notify(t,u,dt);
               if (!reduced && dt<dtmax-1e-13)
                 {
                   dt = std::min(2.0*dt,dtmax);
@@ -1454,6 +1678,7 @@ namespace hdnum {
                   error = true;
                   break;
                 }
+              stats.rejected++;
               dt *= 0.5;
               reduced = true;
               if (verbosity>0) std::cout << "DIRK: reducing time step to " << dt << std::endl;
@@ -1498,6 +1723,23 @@ namespace hdnum {
       return order;
     }
 
+    /** @brief work of all steps since construction or the last reset_statistics
+
+        Steps whose nonlinear systems could not be solved count as
+        rejected. The evaluations include those of the nonlinear
+        solver and the one per stage computing k_i.
+    */
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
     //! print some information
     void get_info () const
     {
@@ -1514,42 +1756,25 @@ namespace hdnum {
     Vector<number_type> u;
     int order;
     mutable bool error;
+    SolverStatistics stats;
   };
 
   //! gnuplot output for time and state sequence
   template<class T, class N>
-  inline void gnuplot (const std::string& fname, const std::vector<T> t, const std::vector<Vector<N> > u)
+  inline void gnuplot (const std::string& fname, const std::vector<T>& t, const std::vector<Vector<N> >& u)
   {
-    std::fstream f(fname.c_str(),std::ios::out);
+    FileWriter<T,N> f(fname);
     for (typename std::vector<T>::size_type n=0; n<t.size(); n++)
-      {
-        f << std::scientific << std::showpoint
-          << std::setprecision(16) << t[n];
-        for (typename Vector<N>::size_type i=0; i<u[n].size(); i++)
-          f << " " << std::scientific << std::showpoint
-            << std::setprecision(u[n].precision()) << u[n][i];
-        f << std::endl;
-      }
-    f.close();
+      f.observe(t[n],u[n],T(0.0));
   }
 
   //! gnuplot output for time and state sequence
   template<class T, class N>
-  inline void gnuplot (const std::string& fname, const std::vector<T> t, const std::vector<Vector<N> > u, const std::vector<T> dt)
+  inline void gnuplot (const std::string& fname, const std::vector<T>& t, const std::vector<Vector<N> >& u, const std::vector<T>& dt)
   {
-    std::fstream f(fname.c_str(),std::ios::out);
+    FileWriter<T,N> f(fname,true);
     for (typename std::vector<T>::size_type n=0; n<t.size(); n++)
-      {
-        f << std::scientific << std::showpoint
-          << std::setprecision(16) << t[n];
-        for (typename Vector<N>::size_type i=0; i<u[n].size(); i++)
-          f << " " << std::scientific << std::showpoint
-            << std::setprecision(u[n].precision()) << u[n][i];
-        f << " " << std::scientific << std::showpoint
-          << std::setprecision(16) << dt[n];
-        f << std::endl;
-      }
-    f.close();
+      f.observe(t[n],u[n],dt[n]);
   }
 
 } // namespace hdnum
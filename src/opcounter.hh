@@ -6,9 +6,17 @@
 #include <iostream>
 #include <cmath>
 #include <cstdlib>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <algorithm>
 
 /** @file
  *  @brief This file implements an operator counting class
+ *
+ *  Each thread counts in its own thread local counters, which are
+ *  merged when the operations are reported.
  */
 
 namespace hdnum {
@@ -23,7 +31,8 @@ namespace hdnum {
     /** Class counting operations
      *
      * This is done by overloading operations and storing the numbers
-     * in a static class member.
+     * in a static thread local class member. Named regions collect
+     * the operations between pushRegion and popRegion.
      */
     template<typename F>
     class OpCounter
@@ -166,6 +175,12 @@ namespace hdnum {
           return addition_count + multiplication_count + division_count + exp_count + pow_count + sin_count + sqrt_count + comparison_count;
         }
 
+        //! Floating point operations: additions, multiplications, divisions and square roots
+        size_type flopCount() const
+        {
+          return addition_count + multiplication_count + division_count + sqrt_count;
+        }
+
         Counters& operator+=(const Counters& rhs)
         {
           addition_count += rhs.addition_count;
@@ -210,30 +225,176 @@ namespace hdnum {
         counters.division_count += n;
       }
 
+      //! Counters of one thread, registered for merging
+      struct ThreadCounters : public Counters {
+
+        //! open regions with the counts at the time they were entered
+        std::vector<std::pair<std::string,Counters> > stack;
+
+        //! counts of the closed regions
+        std::map<std::string,Counters> regions;
+
+        ThreadCounters()
+        {
+          Registry& r = registry();
+          std::lock_guard<std::mutex> lock(r.mutex);
+          r.threads.push_back(this);
+        }
+
+        //! keep the counts of finished threads
+        ~ThreadCounters()
+        {
+          Registry& r = registry();
+          std::lock_guard<std::mutex> lock(r.mutex);
+          r.retired += *this;
+          for (auto it=regions.begin(); it!=regions.end(); ++it)
+            r.retired_regions[it->first] += it->second;
+          r.threads.erase(std::find(r.threads.begin(),r.threads.end(),this));
+        }
+
+        ThreadCounters(const ThreadCounters&) = delete;
+        ThreadCounters& operator=(const ThreadCounters&) = delete;
+      };
+
+      //! All thread local counters and the counts of finished threads
+      struct Registry {
+        std::mutex mutex;
+        std::vector<ThreadCounters*> threads;
+        Counters retired;
+        std::map<std::string,Counters> retired_regions;
+      };
+
+      static Registry& registry()
+      {
+        static Registry r;
+        return r;
+      }
+
+      //! Reset the counters of all threads
       static void reset()
       {
-        counters.reset();
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.retired.reset();
+        r.retired_regions.clear();
+        for (std::size_t i=0; i<r.threads.size(); i++)
+          {
+            r.threads[i]->reset();
+            r.threads[i]->regions.clear();
+            for (std::size_t k=0; k<r.threads[i]->stack.size(); k++)
+              r.threads[i]->stack[k].second.reset();
+          }
       }
 
-      //! Report operations to stream object
+      /** @brief Sum of the counters of all threads
+
+          The counters of other threads are read without
+          synchronization, so they should not count at the same
+          time, e.g. call this after joining them.
+      */
+      static Counters total()
+      {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        Counters c(r.retired);
+        for (std::size_t i=0; i<r.threads.size(); i++) c += *r.threads[i];
+        return c;
+      }
+
+      //! Report operations of all threads to stream object
       template<typename Stream>
       static void reportOperations(Stream& os, bool doReset = false)
       {
-        counters.reportOperations(os,doReset);
+        total().reportOperations(os);
+        if (doReset)
+          reset();
       }
 
-      //! Return total number of operations
+      //! Return total number of operations of all threads
       static size_type totalOperationCount(bool doReset=false)
       {
-        return counters.totalOperationCount(doReset);
+        if (doReset)
+          reset();
+
+        return total().totalOperationCount();
+      }
+
+      //! Enter a named counting region in the calling thread, regions may be nested
+      static void pushRegion(const std::string& name)
+      {
+        counters.stack.push_back(std::make_pair(name,Counters(counters)));
       }
 
-      static Counters counters;
+      //! Leave the innermost region, its operations are added to the region
+      static void popRegion()
+      {
+        if (counters.stack.empty())
+          return;
+        Counters c(counters);
+        counters.regions[counters.stack.back().first] += c - counters.stack.back().second;
+        counters.stack.pop_back();
+      }
+
+      //! Enters a region in the constructor and leaves it in the destructor
+      class ScopedRegion
+      {
+      public:
+        explicit ScopedRegion(const std::string& name)
+        {
+          pushRegion(name);
+        }
+
+        ~ScopedRegion()
+        {
+          popRegion();
+        }
+
+        ScopedRegion(const ScopedRegion&) = delete;
+        ScopedRegion& operator=(const ScopedRegion&) = delete;
+      };
+
+      //! Operations in all closed regions of the given name, summed over all threads
+      static Counters regionCounters(const std::string& name)
+      {
+        std::map<std::string,Counters> regions(allRegions());
+        return regions[name];
+      }
+
+      //! Report operations of each region to stream object
+      template<typename Stream>
+      static void reportRegions(Stream& os, bool doReset = false)
+      {
+        std::map<std::string,Counters> regions(allRegions());
+        for (auto it=regions.begin(); it!=regions.end(); ++it)
+          {
+            os << "region " << it->first << ":" << std::endl;
+            it->second.reportOperations(os);
+            os << std::endl;
+          }
+        if (doReset)
+          reset();
+      }
+
+      //! Counters of the calling thread
+      static thread_local ThreadCounters counters;
+
+    private:
+
+      static std::map<std::string,Counters> allRegions()
+      {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        std::map<std::string,Counters> regions(r.retired_regions);
+        for (std::size_t i=0; i<r.threads.size(); i++)
+          for (auto it=r.threads[i]->regions.begin(); it!=r.threads[i]->regions.end(); ++it)
+            regions[it->first] += it->second;
+        return regions;
+      }
 
     };
 
     template<typename F>
-    typename OpCounter<F>::Counters OpCounter<F>::counters;
+    thread_local typename OpCounter<F>::ThreadCounters OpCounter<F>::counters;
 
     // ********************************************************************************
     // negation
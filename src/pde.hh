@@ -4,6 +4,7 @@
 
 #include<vector>
 #include "newton.hh"
+#include "cholesky.hh"
 
 /** @file
  *  @brief solvers for partial differential equations
@@ -16,6 +17,9 @@ namespace hdnum {
       The PDE solver is parametrized by a model. The model also
       exports all relevant types for the solution.
       The PDE solver encapsulates the states needed for the computation.
+      The linear system is solved by LR decomposition with full pivoting
+      unless a solver for symmetric matrices is selected with
+      set_linear_solver.
 
       \tparam M the model type
   */
@@ -34,10 +38,24 @@ namespace hdnum {
 
     //! constructor stores reference to the model
     StationarySolver (const M& model_)
-      : model(model_), x(model.size())
+      : model(model_), x(model.size()), linear_solver("lr")
     {
     }
 
+    /** @brief select the linear solver
+
+        "lr" (default) for general matrices, "cholesky" and "skyline"
+        for symmetric positive definite and "ldlt" for symmetric
+        matrices. "skyline" only works inside the envelope of the
+        matrix and is the method of choice for band matrices.
+    */
+    void set_linear_solver (const std::string& solver)
+    {
+      if (solver!="lr" && solver!="cholesky" && solver!="ldlt" && solver!="skyline")
+        HDNUM_ERROR("StationarySolver: unknown linear solver " << solver);
+      linear_solver = solver;
+    }
+
     //! do one step
     void solve ()
     {
@@ -54,11 +72,31 @@ namespace hdnum {
 
       x = 0.;
 
-      model.f_x(t, x, A);
-      model.f(t, x, b);
+      HDNUM_PROFILE_REGION("StationarySolver::solve");
+      {
+        HDNUM_PROFILE_REGION("assemble");
+        model.f_x(t, x, A);
+        model.f(t, x, b);
+      }
 
       b*=-1.;
 
+      HDNUM_PROFILE_REGION("linear solve");
+      if (linear_solver=="cholesky")
+        {
+          linsolve_cholesky(A,x,b);
+          return;
+        }
+      if (linear_solver=="ldlt")
+        {
+          linsolve_ldlt(A,x,b);
+          return;
+        }
+      if (linear_solver=="skyline")
+        {
+          linsolve_skyline(A,x,b);
+          return;
+        }
       row_equilibrate(A,s);                         // equilibrate rows
       lr_fullpivot(A,p,q);                          // LR decomposition of A
       apply_equilibrate(s,b);                       // equilibration of right hand side
@@ -83,6 +121,7 @@ namespace hdnum {
   private:
     const M& model;
     Vector<number_type> x;
+    std::string linear_solver;
   };
 
 
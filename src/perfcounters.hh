@@ -0,0 +1,206 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_PERFCOUNTERS_HH
+#define HDNUM_PERFCOUNTERS_HH
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/** @file
+ *  @brief hardware performance counters through Linux perf_event_open
+ *
+ *  A PerfCounters object opens a group of counters for the calling
+ *  thread. Events the processor does not support are left out, without
+ *  any hardware counters (virtual machines) the software events task
+ *  clock and page faults are counted instead. If perf is not available
+ *  at all (other operating systems, containers without the syscall,
+ *  perf_event_paranoid > 2) the group is empty, available() returns
+ *  false and all counts are zero.
+ */
+
+namespace hdnum {
+
+  /** @brief Group of hardware counters of the calling thread
+
+      The default group counts cycles, instructions, L1 data cache read
+      misses and last level cache misses in user space. Processor
+      specific events, e.g. floating point operations, are added with
+      addRawEvent; on Intel processors since Haswell the event
+      FP_ARITH_INST_RETIRED has the raw codes 0x01c7 (scalar double),
+      0x04c7 (128 bit packed double) and 0x10c7 (256 bit packed double).
+  */
+  class PerfCounters
+  {
+  public:
+    typedef std::size_t size_type;
+    typedef unsigned long long count_type;
+
+    //! open the default events
+    PerfCounters ()
+      : leader(-1)
+    {
+#ifdef __linux__
+      add("cycles",PERF_TYPE_HARDWARE,PERF_COUNT_HW_CPU_CYCLES);
+      add("instructions",PERF_TYPE_HARDWARE,PERF_COUNT_HW_INSTRUCTIONS);
+      add("L1D misses",PERF_TYPE_HW_CACHE,
+          PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+      add("LLC misses",PERF_TYPE_HARDWARE,PERF_COUNT_HW_CACHE_MISSES);
+      if (leader<0)
+        {
+          // no hardware counters, e.g. in virtual machines
+          add("task clock [ns]",PERF_TYPE_SOFTWARE,PERF_COUNT_SW_TASK_CLOCK);
+          add("page faults",PERF_TYPE_SOFTWARE,PERF_COUNT_SW_PAGE_FAULTS);
+        }
+#else
+      message = "perf events are only available on Linux";
+#endif
+    }
+
+    ~PerfCounters ()
+    {
+#ifdef __linux__
+      for (size_type i=0; i<fds.size(); i++) close(fds[i]);
+#endif
+    }
+
+    PerfCounters (const PerfCounters&) = delete;
+    PerfCounters& operator= (const PerfCounters&) = delete;
+
+    //! add a processor specific event given by its raw code, returns false if it can not be opened
+    bool addRawEvent (const std::string& name, count_type config)
+    {
+#ifdef __linux__
+      return add(name,PERF_TYPE_RAW,config);
+#else
+      return false;
+#endif
+    }
+
+    //! true if at least one event is counted
+    bool available () const
+    {
+      return leader>=0;
+    }
+
+    //! reason why the counters or some events are not available
+    const std::string& error () const
+    {
+      return message;
+    }
+
+    //! number of counted events
+    size_type size () const
+    {
+      return names.size();
+    }
+
+    //! name of event i
+    const std::string& name (size_type i) const
+    {
+      return names[i];
+    }
+
+    //! position of the event with the given name or size() if it is not counted
+    size_type find (const std::string& event) const
+    {
+      for (size_type i=0; i<names.size(); i++)
+        if (names[i]==event) return i;
+      return names.size();
+    }
+
+    /** @brief current counts since the group was opened
+
+        Counts are scaled up if the kernel had to multiplex the
+        counters.
+    */
+    void read (std::vector<count_type>& values) const
+    {
+      values.assign(names.size(),0);
+#ifdef __linux__
+      if (leader<0) return;
+      std::vector<count_type> buffer(3+names.size());
+      ssize_t bytes = ::read(leader,&buffer[0],buffer.size()*sizeof(count_type));
+      if (bytes<ssize_t(3*sizeof(count_type))) return;
+      double scale = 1.0;
+      if (buffer[2]>0 && buffer[2]<buffer[1]) scale = double(buffer[1])/buffer[2];
+      for (size_type i=0; i<names.size() && i<buffer[0]; i++)
+        values[i] = count_type(buffer[3+i]*scale);
+#endif
+    }
+
+    //! remember the current counts
+    void start ()
+    {
+      read(begin);
+    }
+
+    //! counts since the last call of start
+    std::vector<count_type> stop () const
+    {
+      std::vector<count_type> values;
+      read(values);
+      for (size_type i=0; i<values.size() && i<begin.size(); i++) values[i] -= begin[i];
+      return values;
+    }
+
+    //! write counts with the derived instructions per cycle
+    template<typename Stream>
+    void report (Stream& os, const std::vector<count_type>& values) const
+    {
+      if (!available())
+        {
+          os << "perf counters not available: " << message << std::endl;
+          return;
+        }
+      for (size_type i=0; i<names.size(); i++)
+        os << std::setw(24) << std::left << names[i] << std::right << std::setw(16) << values[i] << std::endl;
+      size_type c = find("cycles"), n = find("instructions");
+      if (c<size() && n<size() && values[c]>0)
+        os << std::setw(24) << std::left << "IPC" << std::right << std::setw(16)
+           << std::fixed << std::setprecision(2) << double(values[n])/values[c] << std::endl;
+    }
+
+  private:
+#ifdef __linux__
+    bool add (const std::string& name, unsigned type, count_type config)
+    {
+      perf_event_attr attr;
+      std::memset(&attr,0,sizeof(attr));
+      attr.type = type;
+      attr.size = sizeof(attr);
+      attr.config = config;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      int fd = syscall(__NR_perf_event_open,&attr,0,-1,leader,0);
+      if (fd<0)
+        {
+          if (!message.empty()) message += ", ";
+          message += name + ": " + std::strerror(errno);
+          return false;
+        }
+      if (leader<0) leader = fd;
+      fds.push_back(fd);
+      names.push_back(name);
+      return true;
+    }
+#endif
+
+    int leader;
+    std::vector<int> fds;
+    std::vector<std::string> names;
+    std::vector<count_type> begin;
+    std::string message;
+  };
+
+} // namespace hdnum
+
+#endif
@@ -0,0 +1,435 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_PROFILER_HH
+#define HDNUM_PROFILER_HH
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#if HDNUM_PROFILE_RDTSC
+#include <x86intrin.h>
+#endif
+#if HDNUM_PROFILE_PERF
+#include "perfcounters.hh"
+#endif
+
+/** @file
+ *  @brief hierarchical profiler with named regions
+ *
+ *  Regions are opened with HDNUM_PROFILE_REGION("name") and closed at
+ *  the end of the enclosing scope. Nested regions form a tree per
+ *  thread, the trees of all threads are merged in the reports.
+ *  Unless HDNUM_PROFILING is defined to 1 before hdnum.hh is included
+ *  the macro expands to nothing. Time is measured with steady_clock,
+ *  with HDNUM_PROFILE_RDTSC=1 in cycles of the time stamp counter.
+ *  With HDNUM_PROFILE_PERF=1 the hardware counters of PerfCounters
+ *  are read at the begin and end of each region as well.
+ */
+
+#if HDNUM_PROFILING
+#define HDNUM_PROFILE_CONCAT_(a,b) a##b
+#define HDNUM_PROFILE_CONCAT(a,b) HDNUM_PROFILE_CONCAT_(a,b)
+#define HDNUM_PROFILE_REGION(name) \
+  hdnum::ProfileRegion HDNUM_PROFILE_CONCAT(hdnum_profile_region_,__LINE__)(name)
+#else
+#define HDNUM_PROFILE_REGION(name)
+#endif
+
+namespace hdnum {
+
+  /** @brief Region profiler
+
+      Each thread records into its own tree of regions, so entering and
+      leaving a region needs no synchronization. Reports should be
+      written when the other threads do not profile, e.g. after
+      joining them.
+  */
+  class Profiler
+  {
+  public:
+    typedef std::size_t size_type;
+#if HDNUM_PROFILE_RDTSC
+    typedef unsigned long long tick_type;
+#else
+    typedef std::chrono::steady_clock::rep tick_type;
+#endif
+
+    //! current time in ticks
+    static tick_type now ()
+    {
+#if HDNUM_PROFILE_RDTSC
+      return __rdtsc();
+#else
+      return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    //! unit of the times in the reports
+    static const char* unit ()
+    {
+#if HDNUM_PROFILE_RDTSC
+      return "Mcycles";
+#else
+      return "s";
+#endif
+    }
+
+    //! convert ticks to the unit of the reports
+    static double convert (tick_type ticks)
+    {
+#if HDNUM_PROFILE_RDTSC
+      return ticks*1e-6;
+#else
+      typedef std::chrono::steady_clock::period period;
+      return double(ticks)*period::num/period::den;
+#endif
+    }
+
+    //! one node of the region tree
+    struct Node
+    {
+      const char* key;                  // name as passed by the caller, compared first
+      std::string name;
+      size_type parent;
+      std::vector<size_type> children;
+      size_type calls;
+      tick_type ticks;
+      std::vector<unsigned long long> events;  // hardware counts
+
+      Node (const char* key_, const std::string& name_, size_type parent_)
+        : key(key_), name(name_), parent(parent_), calls(0), ticks(0)
+      {}
+    };
+
+    //! region tree of one thread, node 0 is the root
+    struct Tree
+    {
+      std::vector<Node> nodes;
+      size_type current;
+      std::vector<tick_type> start;
+      std::vector<std::vector<unsigned long long> > startevents;
+
+      Tree ()
+        : nodes(1,Node(0,"total",0)), current(0)
+      {}
+
+      //! child of node i with the given name, created if needed
+      size_type child (size_type i, const char* name)
+      {
+        for (size_type k=0; k<nodes[i].children.size(); k++)
+          {
+            size_type c = nodes[i].children[k];
+            if (nodes[c].key==name || nodes[c].name==name) return c;
+          }
+        nodes.push_back(Node(name,name,i));
+        nodes[i].children.push_back(nodes.size()-1);
+        return nodes.size()-1;
+      }
+
+      //! as above, compares names only
+      size_type child (size_type i, const std::string& name)
+      {
+        for (size_type k=0; k<nodes[i].children.size(); k++)
+          {
+            size_type c = nodes[i].children[k];
+            if (nodes[c].name==name) return c;
+          }
+        nodes.push_back(Node(0,name,i));
+        nodes[i].children.push_back(nodes.size()-1);
+        return nodes.size()-1;
+      }
+
+      //! add the times and calls of node j of another tree below node i
+      void merge (size_type i, const Tree& other, size_type j)
+      {
+        nodes[i].calls += other.nodes[j].calls;
+        nodes[i].ticks += other.nodes[j].ticks;
+        if (nodes[i].events.size()<other.nodes[j].events.size())
+          nodes[i].events.resize(other.nodes[j].events.size(),0);
+        for (size_type e=0; e<other.nodes[j].events.size(); e++)
+          nodes[i].events[e] += other.nodes[j].events[e];
+        for (size_type k=0; k<other.nodes[j].children.size(); k++)
+          {
+            size_type oc = other.nodes[j].children[k];
+            size_type c = child(i,other.nodes[oc].name);
+            merge(c,other,oc);
+          }
+      }
+
+      void clear ()
+      {
+        for (size_type i=0; i<nodes.size(); i++)
+          {
+            nodes[i].calls = 0;
+            nodes[i].ticks = 0;
+            nodes[i].events.assign(nodes[i].events.size(),0);
+          }
+      }
+    };
+
+    //! enter a region in the calling thread
+    static void enter (const char* name)
+    {
+      Tree& t = tree();
+      t.current = t.child(t.current,name);
+      t.nodes[t.current].calls++;
+#if HDNUM_PROFILE_PERF
+      t.startevents.push_back(std::vector<unsigned long long>());
+      perf().read(t.startevents.back());
+#endif
+      t.start.push_back(now());
+    }
+
+    //! leave the innermost region of the calling thread
+    static void leave ()
+    {
+      Tree& t = tree();
+      if (t.start.empty()) return;
+      t.nodes[t.current].ticks += now()-t.start.back();
+      t.start.pop_back();
+#if HDNUM_PROFILE_PERF
+      std::vector<unsigned long long> values;
+      perf().read(values);
+      std::vector<unsigned long long>& events = t.nodes[t.current].events;
+      events.resize(values.size(),0);
+      for (size_type e=0; e<values.size(); e++) events[e] += values[e]-t.startevents.back()[e];
+      t.startevents.pop_back();
+#endif
+      t.current = t.nodes[t.current].parent;
+    }
+
+    //! clear the times of all threads, the open regions are kept
+    static void reset ()
+    {
+      Registry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      r.retired = Tree();
+      for (size_type i=0; i<r.threads.size(); i++) r.threads[i]->clear();
+    }
+
+    //! region tree merged over all threads
+    static Tree merged ()
+    {
+      Registry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      Tree t;
+      t.merge(0,r.retired,0);
+      for (size_type i=0; i<r.threads.size(); i++) t.merge(0,*r.threads[i],0);
+      return t;
+    }
+
+    //! report each region with calls, inclusive time and time without subregions
+    template<typename Stream>
+    static void reportTree (Stream& os)
+    {
+      Tree t(merged());
+      os << std::setw(40) << std::left << "region" << std::right
+         << std::setw(10) << "calls" << std::setw(14) << (std::string("total [")+unit()+"]")
+         << std::setw(14) << (std::string("self [")+unit()+"]") << std::setw(10) << "% parent" << std::endl;
+      for (size_type k=0; k<t.nodes[0].children.size(); k++)
+        reportNode(os,t,t.nodes[0].children[k],0);
+    }
+
+    //! report regions of the same name together, sorted by time without subregions
+    template<typename Stream>
+    static void reportFlat (Stream& os)
+    {
+      std::map<std::string,Entry> entries(flat());
+      std::vector<std::pair<std::string,Entry> > sorted(entries.begin(),entries.end());
+      std::sort(sorted.begin(),sorted.end(),
+                [] (const std::pair<std::string,Entry>& a, const std::pair<std::string,Entry>& b)
+                { return a.second.self>b.second.self; });
+      os << std::setw(40) << std::left << "region" << std::right
+         << std::setw(10) << "calls" << std::setw(14) << (std::string("total [")+unit()+"]")
+         << std::setw(14) << (std::string("self [")+unit()+"]") << std::endl;
+      for (size_type k=0; k<sorted.size(); k++)
+        os << std::setw(40) << std::left << sorted[k].first << std::right
+           << std::setw(10) << sorted[k].second.calls
+           << std::scientific << std::setprecision(3)
+           << std::setw(14) << convert(sorted[k].second.total)
+           << std::setw(14) << convert(sorted[k].second.self) << std::endl;
+    }
+
+    //! number of times regions with the given name were entered, summed over all threads
+    static size_type calls (const std::string& name)
+    {
+      std::map<std::string,Entry> entries(flat());
+      return entries[name].calls;
+    }
+
+    //! inclusive time of the regions with the given name in the unit of the reports
+    static double total (const std::string& name)
+    {
+      std::map<std::string,Entry> entries(flat());
+      return convert(entries[name].total);
+    }
+
+#if HDNUM_PROFILE_PERF
+    //! hardware counters of the calling thread
+    static PerfCounters& perf ()
+    {
+      static thread_local PerfCounters counters;
+      return counters;
+    }
+
+    //! report the hardware counts of each region
+    template<typename Stream>
+    static void reportPerf (Stream& os)
+    {
+      PerfCounters& pc = perf();
+      if (!pc.available())
+        {
+          os << "perf counters not available: " << pc.error() << std::endl;
+          return;
+        }
+      Tree t(merged());
+      os << std::setw(40) << std::left << "region" << std::right;
+      for (size_type e=0; e<pc.size(); e++) os << std::setw(16) << pc.name(e);
+      os << std::setw(8) << "IPC" << std::endl;
+      for (size_type k=0; k<t.nodes[0].children.size(); k++)
+        reportPerfNode(os,t,t.nodes[0].children[k],0);
+    }
+#endif
+
+  private:
+
+#if HDNUM_PROFILE_PERF
+    template<typename Stream>
+    static void reportPerfNode (Stream& os, const Tree& t, size_type i, size_type depth)
+    {
+      PerfCounters& pc = perf();
+      const std::vector<unsigned long long>& events = t.nodes[i].events;
+      os << std::setw(40) << std::left << (std::string(2*depth,' ')+t.nodes[i].name) << std::right;
+      for (size_type e=0; e<pc.size(); e++) os << std::setw(16) << ((e<events.size()) ? events[e] : 0);
+      size_type c = pc.find("cycles"), n = pc.find("instructions");
+      if (c<events.size() && n<events.size() && events[c]>0)
+        os << std::fixed << std::setprecision(2) << std::setw(8) << double(events[n])/events[c];
+      os << std::endl;
+      for (size_type k=0; k<t.nodes[i].children.size(); k++)
+        reportPerfNode(os,t,t.nodes[i].children[k],depth+1);
+    }
+#endif
+
+    struct Entry
+    {
+      size_type calls;
+      tick_type total;
+      tick_type self;
+
+      Entry ()
+        : calls(0), total(0), self(0)
+      {}
+    };
+
+    //! Tree of one thread, registered for merging
+    struct ThreadTree : public Tree
+    {
+      ThreadTree ()
+      {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.threads.push_back(this);
+      }
+
+      //! keep the times of finished threads
+      ~ThreadTree ()
+      {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.retired.merge(0,*this,0);
+        r.threads.erase(std::find(r.threads.begin(),r.threads.end(),this));
+      }
+
+      ThreadTree (const ThreadTree&) = delete;
+      ThreadTree& operator= (const ThreadTree&) = delete;
+    };
+
+    struct Registry
+    {
+      std::mutex mutex;
+      std::vector<ThreadTree*> threads;
+      Tree retired;
+    };
+
+    static Registry& registry ()
+    {
+      static Registry r;
+      return r;
+    }
+
+    static Tree& tree ()
+    {
+      static thread_local ThreadTree t;
+      return t;
+    }
+
+    // calls, inclusive and self time of each region name over the merged tree
+    static std::map<std::string,Entry> flat ()
+    {
+      Tree t(merged());
+      std::map<std::string,Entry> entries;
+      for (size_type i=1; i<t.nodes.size(); i++)
+        {
+          Entry& e = entries[t.nodes[i].name];
+          e.calls += t.nodes[i].calls;
+          e.self += self(t,i);
+          // count the inclusive time only for the outermost occurrence
+          bool nested = false;
+          for (size_type p=t.nodes[i].parent; p!=0; p=t.nodes[p].parent)
+            if (t.nodes[p].name==t.nodes[i].name) nested = true;
+          if (!nested) e.total += t.nodes[i].ticks;
+        }
+      return entries;
+    }
+
+    static tick_type self (const Tree& t, size_type i)
+    {
+      tick_type s = t.nodes[i].ticks;
+      for (size_type k=0; k<t.nodes[i].children.size(); k++)
+        s -= t.nodes[t.nodes[i].children[k]].ticks;
+      return s;
+    }
+
+    template<typename Stream>
+    static void reportNode (Stream& os, const Tree& t, size_type i, size_type depth)
+    {
+      tick_type parent = t.nodes[t.nodes[i].parent].ticks;
+      os << std::setw(40) << std::left << (std::string(2*depth,' ')+t.nodes[i].name) << std::right
+         << std::setw(10) << t.nodes[i].calls
+         << std::scientific << std::setprecision(3)
+         << std::setw(14) << convert(t.nodes[i].ticks)
+         << std::setw(14) << convert(self(t,i));
+      if (depth>0 && parent>0)
+        os << std::fixed << std::setprecision(1) << std::setw(10) << 100.0*t.nodes[i].ticks/parent;
+      os << std::endl;
+      for (size_type k=0; k<t.nodes[i].children.size(); k++)
+        reportNode(os,t,t.nodes[i].children[k],depth+1);
+    }
+  };
+
+
+  //! Enters a profiler region in the constructor and leaves it in the destructor
+  class ProfileRegion
+  {
+  public:
+    explicit ProfileRegion (const char* name)
+    {
+      Profiler::enter(name);
+    }
+
+    ~ProfileRegion ()
+    {
+      Profiler::leave();
+    }
+
+    ProfileRegion (const ProfileRegion&) = delete;
+    ProfileRegion& operator= (const ProfileRegion&) = delete;
+  };
+
+} // namespace hdnum
+
+#endif
@@ -4,10 +4,18 @@
 
 #include "vector.hh"
 #include "densematrix.hh"
+#include "exceptions.hh"
 #include <cmath>
+#include <algorithm>
 
 /** @file
  *  @brief This file implements QR decomposition
+ *
+ *  Besides Gram-Schmidt orthogonalization there is a Householder QR
+ *  decomposition that stores the reflectors in the lower part of the
+ *  matrix (as LAPACK's geqrf). Blocks of reflectors are combined to
+ *  I - V T V^T (compact WY form, Schreiber and Van Loan, 1989), so the
+ *  trailing matrix is updated by matrix-matrix products.
  */
 
 namespace hdnum
@@ -59,7 +67,7 @@ namespace hdnum
     for (int k=0; k<Q.colsize(); k++)
       {
         // modify all later columns with column k
-        for (int j=k+1; j<Q.rowsize(); j++)
+        for (int j=k+1; j<Q.colsize(); j++)
           {
             // compute factor
             T sum_nom(0.0);
@@ -87,5 +95,232 @@ namespace hdnum
     return Q;
   }
 
+  namespace detail {
+
+    /* Householder QR of the columns k0,...,k1-1 of A, only these
+       columns are updated. H_k = I - tau_k v_k v_k^T, v_k[k]=1 */
+    template<class T>
+    void qr_panel (DenseMatrix<T>& A, Vector<T>& tau, std::size_t k0, std::size_t k1)
+    {
+      using std::sqrt;
+      std::size_t m = A.rowsize();
+      std::vector<T> w(k1);
+      for (std::size_t k=k0; k<k1; k++)
+        {
+          // reflector for column k
+          T alpha(A[k][k]);
+          T xnorm2(0.0);
+          for (std::size_t i=k+1; i<m; i++) xnorm2 += A[i][k]*A[i][k];
+          if (xnorm2==T(0.0))
+            {
+              tau[k] = T(0.0);                          // nothing to eliminate
+              continue;
+            }
+          T beta(sqrt(alpha*alpha+xnorm2));
+          if (alpha>=T(0.0)) beta = -beta;              // avoid cancellation
+          tau[k] = (beta-alpha)/beta;
+          T scale = T(1.0)/(alpha-beta);
+          for (std::size_t i=k+1; i<m; i++) A[i][k] *= scale;
+          A[k][k] = beta;
+
+          // apply to the remaining columns of the panel, row by row
+          for (std::size_t j=k+1; j<k1; j++) w[j] = A[k][j];
+          for (std::size_t i=k+1; i<m; i++)
+            {
+              T vi(A[i][k]);
+              for (std::size_t j=k+1; j<k1; j++) w[j] += vi*A[i][j];
+            }
+          for (std::size_t j=k+1; j<k1; j++)
+            {
+              w[j] *= tau[k];
+              A[k][j] -= w[j];
+            }
+          for (std::size_t i=k+1; i<m; i++)
+            {
+              T vi(A[i][k]);
+              for (std::size_t j=k+1; j<k1; j++) A[i][j] -= vi*w[j];
+            }
+        }
+    }
+
+    /* triangular factor Tm of the block reflector
+       H_k0 ... H_{k1-1} = I - V Tm V^T (LAPACK's larft) */
+    template<class T>
+    void qr_block_reflector (const DenseMatrix<T>& A, const Vector<T>& tau,
+                             std::size_t k0, std::size_t k1, DenseMatrix<T>& Tm)
+    {
+      std::size_t m = A.rowsize();
+      std::size_t nb = k1-k0;
+      std::vector<T> c(nb);
+      for (std::size_t l=0; l<nb; l++)
+        {
+          std::size_t k = k0+l;
+          // c = V(:,0:l-1)^T v_l, v_l is zero above row k
+          for (std::size_t j=0; j<l; j++) c[j] = A[k][k0+j];
+          for (std::size_t i=k+1; i<m; i++)
+            {
+              T vi(A[i][k]);
+              for (std::size_t j=0; j<l; j++) c[j] += A[i][k0+j]*vi;
+            }
+          // Tm(0:l-1,l) = -tau_l Tm(0:l-1,0:l-1) c
+          for (std::size_t i=0; i<l; i++)
+            {
+              T sum(0.0);
+              for (std::size_t j=i; j<l; j++) sum += Tm[i][j]*c[j];
+              Tm[i][l] = -tau[k]*sum;
+            }
+          for (std::size_t i=l+1; i<nb; i++) Tm[i][l] = T(0.0);
+          Tm[l][l] = tau[k];
+        }
+    }
+
+    /* C = (I - V Tm V^T)^T C for the columns j0,...,A.colsize()-1 of A,
+       V is stored in the columns k0,...,k1-1 */
+    template<class T>
+    void qr_block_update (DenseMatrix<T>& A, const DenseMatrix<T>& Tm,
+                          std::size_t k0, std::size_t k1, std::size_t j0)
+    {
+      std::size_t m = A.rowsize();
+      std::size_t n = A.colsize();
+      std::size_t nb = k1-k0;
+      std::size_t nc = n-j0;
+      if (nc==0) return;
+
+      // W = V^T C, accumulated row by row of C
+      DenseMatrix<T> W(nb,nc,T(0.0));
+      for (std::size_t i=k0; i<m; i++)
+        {
+          std::size_t lmax = std::min(nb,i-k0+1);
+          for (std::size_t l=0; l<lmax; l++)
+            {
+              T vil = (i==k0+l) ? T(1.0) : A[i][k0+l];
+              for (std::size_t j=0; j<nc; j++) W[l][j] += vil*A[i][j0+j];
+            }
+        }
+
+      // W = Tm^T W, Tm is upper triangular
+      for (std::size_t l=nb; l-->0; )
+        for (std::size_t j=0; j<nc; j++)
+          {
+            T sum(0.0);
+            for (std::size_t r=0; r<=l; r++) sum += Tm[r][l]*W[r][j];
+            W[l][j] = sum;
+          }
+
+      // C = C - V W
+      for (std::size_t i=k0; i<m; i++)
+        {
+          std::size_t lmax = std::min(nb,i-k0+1);
+          for (std::size_t l=0; l<lmax; l++)
+            {
+              T vil = (i==k0+l) ? T(1.0) : A[i][k0+l];
+              for (std::size_t j=0; j<nc; j++) A[i][j0+j] -= vil*W[l][j];
+            }
+        }
+    }
+
+  }
+
+
+  /** @brief Householder QR decomposition A = QR
+
+      A (m x n, m>=n) is overwritten with R in the upper triangle and the
+      Householder vectors v_k below the diagonal, Q = H_0 ... H_{n-1}
+      with H_k = I - tau_k v_k v_k^T and v_k[k]=1. The columns are
+      processed in blocks of nb, the trailing matrix is updated with
+      the compact WY representation of each block.
+
+      \param[in,out] A   the matrix, afterwards R and the reflectors
+      \param[out]    tau the factors of the reflectors
+      \param[in]     nb  block size, nb=1 gives the unblocked algorithm
+  */
+  template<class T>
+  void qr_householder (DenseMatrix<T>& A, Vector<T>& tau, std::size_t nb=32)
+  {
+    if (A.rowsize()<A.colsize() || A.colsize()==0)
+      HDNUM_ERROR("qr_householder: need nonempty matrix with rows >= columns");
+    if (nb==0) nb = 1;
+    std::size_t n = A.colsize();
+    tau.resize(n);
+    for (std::size_t k0=0; k0<n; k0+=nb)
+      {
+        std::size_t k1 = std::min(n,k0+nb);
+        detail::qr_panel(A,tau,k0,k1);                  // factorize the panel
+        if (k1<n)
+          {
+            DenseMatrix<T> Tb(k1-k0,k1-k0);
+            detail::qr_block_reflector(A,tau,k0,k1,Tb);
+            detail::qr_block_update(A,Tb,k0,k1,k1);     // update trailing matrix
+          }
+      }
+  }
+
+  //! b = Q^T b with Q given by qr_householder, Q is not formed
+  template<class T>
+  void apply_qt (const DenseMatrix<T>& QR, const Vector<T>& tau, Vector<T>& b)
+  {
+    if (QR.rowsize()!=b.size())
+      HDNUM_ERROR("apply_qt: vector incompatible with matrix");
+    std::size_t m = QR.rowsize();
+    for (std::size_t k=0; k<QR.colsize(); k++)
+      {
+        T w(b[k]);
+        for (std::size_t i=k+1; i<m; i++) w += QR[i][k]*b[i];
+        w *= tau[k];
+        b[k] -= w;
+        for (std::size_t i=k+1; i<m; i++) b[i] -= QR[i][k]*w;
+      }
+  }
+
+  //! b = Q b with Q given by qr_householder, Q is not formed
+  template<class T>
+  void apply_q (const DenseMatrix<T>& QR, const Vector<T>& tau, Vector<T>& b)
+  {
+    if (QR.rowsize()!=b.size())
+      HDNUM_ERROR("apply_q: vector incompatible with matrix");
+    std::size_t m = QR.rowsize();
+    for (std::size_t k=QR.colsize(); k-->0; )
+      {
+        T w(b[k]);
+        for (std::size_t i=k+1; i<m; i++) w += QR[i][k]*b[i];
+        w *= tau[k];
+        b[k] -= w;
+        for (std::size_t i=k+1; i<m; i++) b[i] -= QR[i][k]*w;
+      }
+  }
+
+  /** @brief least squares solution from a QR decomposition
+
+      x minimizes |Ax-b| with QR and tau computed by qr_householder.
+  */
+  template<class T>
+  void solve_least_squares (const DenseMatrix<T>& QR, const Vector<T>& tau, Vector<T>& x, const Vector<T>& b)
+  {
+    std::size_t n = QR.colsize();
+    Vector<T> c(b);
+    apply_qt(QR,tau,c);                                 // c = Q^T b
+    x.resize(n);
+    for (std::size_t i=n; i-->0; )                      // solve R x = c
+      {
+        if (QR[i][i]==T(0.0))
+          HDNUM_ERROR("solve_least_squares: matrix has not full rank");
+        T rhs(c[i]);
+        for (std::size_t j=i+1; j<n; j++) rhs -= QR[i][j]*x[j];
+        x[i] = rhs/QR[i][i];
+      }
+  }
+
+  //! least squares solution x of min |Ax-b| with Householder QR, A is not modified
+  template<class T>
+  void solve_least_squares (const DenseMatrix<T>& A, Vector<T>& x, const Vector<T>& b)
+  {
+    if (A.rowsize()!=b.size())
+      HDNUM_ERROR("solve_least_squares: right hand side incompatible with matrix");
+    DenseMatrix<T> QR(A);
+    Vector<T> tau(A.colsize());
+    qr_householder(QR,tau);
+    solve_least_squares(QR,tau,x,b);
+  }
+
 }
 #endif
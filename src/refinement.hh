@@ -0,0 +1,360 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_REFINEMENT_HH
+#define HDNUM_REFINEMENT_HH
+
+#include <limits>
+#include <iostream>
+#include <iomanip>
+#include "vector.hh"
+#include "densematrix.hh"
+#include "exceptions.hh"
+#include "lr.hh"
+
+#if HDNUM_HAS_GMP
+#include <gmpxx.h>
+#endif
+
+/** @file
+ *  @brief mixed precision iterative refinement for dense linear systems
+ *
+ *  The O(n^3) LR decomposition is done in a low precision L, e.g.
+ *  float, which halves the memory traffic and doubles the width of
+ *  vector instructions. The solution is then improved in O(n^2) per
+ *  step by
+ *
+ *  \f[ r = b - A x, \quad \hat{A} d = r, \quad x = x + d \f]
+ *
+ *  where the residual is computed in a precision H at least as high
+ *  as the working precision T and the correction is solved with the
+ *  low precision factors. For condition numbers up to about
+ *  1/eps(L) the iteration converges to the accuracy of a solve in T.
+ */
+
+namespace hdnum {
+
+  namespace detail {
+
+    // conversion between number types, mpf_class needs get_d
+    template<class To, class From>
+    struct NumberConverter
+    {
+      static To apply (const From& x)
+      {
+        return To(x);
+      }
+    };
+
+#if HDNUM_HAS_GMP
+    template<class To>
+    struct NumberConverter<To,mpf_class>
+    {
+      static To apply (const mpf_class& x)
+      {
+        return To(x.get_d());
+      }
+    };
+
+    template<>
+    struct NumberConverter<mpf_class,mpf_class>
+    {
+      static mpf_class apply (const mpf_class& x)
+      {
+        return x;
+      }
+    };
+#endif
+
+    template<class To, class From>
+    To convert_number (const From& x)
+    {
+      return NumberConverter<To,From>::apply(x);
+    }
+
+  } // namespace detail
+
+  /** @brief Solve A x = b with a low precision factorization and iterative refinement
+
+      \code
+      IterativeRefinement<float,double> solver;    // factor in float
+      solver.factorize(A);
+      solver.solve(x,b);
+      if (solver.used_fallback()) ...              // solved in double
+      \endcode
+
+      The iteration stops when the residual reaches the rounding level
+      of H, |b - A x| <= sqrt(n) eps(H) |A| |x| in the maximum norm, or
+      when the correction is below the reduction factor relative to the
+      solution, by default eps(T). If the correction does not at least
+      halve in a step, the maximum number of iterations is reached or
+      the factorization in L fails, the system is solved with row
+      equilibration and full pivoting in T, as linsolve does.
+
+      With HDNUM_HAS_GMP the residual can be computed with mpf_class,
+      e.g. IterativeRefinement<float,double,mpf_class>; set its
+      precision with mpf_set_default_prec before. numeric_limits gives
+      no epsilon for mpf_class, so then the correction decides.
+
+      \tparam L precision of the factorization
+      \tparam T working precision of matrix, right hand side and solution
+      \tparam H precision of the residual
+  */
+  template<class L, class T, class H=T>
+  class IterativeRefinement
+  {
+  public:
+    typedef std::size_t size_type;
+
+    IterativeRefinement ()
+      : maxit(20), verbosity(0), reduction(std::numeric_limits<T>::epsilon()), anorm(0.0),
+        factorized(false), low_ok(false), fallback_factorized(false),
+        converged(false), fallback(false), iterations_taken(0)
+    {}
+
+    //! maximum number of refinement steps before the fallback
+    void set_maxit (size_type n)
+    {
+      maxit = n;
+    }
+
+    //! control output given 0=nothing, 1=summary, 2=every step
+    void set_verbosity (size_type n)
+    {
+      verbosity = n;
+    }
+
+    //! also stop when the correction is below l times the solution in the maximum norm
+    void set_reduction (T l)
+    {
+      reduction = l;
+    }
+
+    //! store A and factorize it in the low precision
+    void factorize (const DenseMatrix<T>& A_)
+    {
+      if (A_.rowsize()!=A_.colsize() || A_.rowsize()==0)
+        HDNUM_ERROR("need square and nonempty matrix");
+      A = A_;
+      size_type n = A.rowsize();
+      LR = DenseMatrix<L>(n,n);
+      s = Vector<L>(n);
+      p = Vector<size_type>(n);
+      fallback_factorized = false;
+      factorized = true;
+
+      // entries outside the range of L go directly to the fallback
+      low_ok = true;
+      const T big(std::numeric_limits<L>::max());
+      anorm = T(0.0);
+      for (size_type i=0; i<n; i++)
+        {
+          T rowsum(0.0);
+          for (size_type j=0; j<n; j++)
+            {
+              if (abs(A[i][j])>big) low_ok = false;
+              rowsum += abs(A[i][j]);
+              LR[i][j] = detail::convert_number<L>(A[i][j]);
+            }
+          if (rowsum>anorm) anorm = rowsum;
+        }
+      if (!low_ok) return;
+      try
+        {
+          row_equilibrate(LR,s);
+          lr_partialpivot(LR,p);
+        }
+      catch (const ErrorException&)
+        {
+          low_ok = false;
+        }
+    }
+
+    /** @brief solve A x = b with the matrix given to factorize
+
+        x needs the size of b; its input value is not used.
+    */
+    void solve (Vector<T>& x, const Vector<T>& b)
+    {
+      if (!factorized)
+        HDNUM_ERROR("IterativeRefinement: factorize has to be called first");
+      size_type n = A.rowsize();
+      if (b.size()!=n || x.size()!=n)
+        HDNUM_ERROR("right hand side or solution incompatible with matrix");
+
+      converged = false;
+      fallback = false;
+      iterations_taken = 0;
+      if (low_ok)
+        {
+          Vector<L> rl(n), dl(n);
+          for (size_type i=0; i<n; i++) rl[i] = detail::convert_number<L>(b[i]);
+          solve_low(rl,dl);
+          for (size_type i=0; i<n; i++) x[i] = detail::convert_number<T>(dl[i]);
+
+          // residuals at the rounding level of H carry no more information
+          const T rtol(sqrt(T(n))*detail::convert_number<T>(std::numeric_limits<H>::epsilon())*anorm);
+          T dold(std::numeric_limits<T>::max());
+          for (size_type k=0; ; k++)
+            {
+              T rnorm(residual(x,b,rl)), xnorm(0.0);
+              for (size_type i=0; i<n; i++)
+                if (abs(x[i])>xnorm) xnorm = abs(x[i]);
+              if (verbosity>=2)
+                std::cout << "  refinement " << std::setw(3) << k
+                          << " residual=" << std::scientific << std::showpoint
+                          << std::setprecision(4) << rnorm << std::endl;
+              if (rnorm<=rtol*xnorm)
+                {
+                  converged = true;
+                  break;
+                }
+              if (k==maxit) break;
+
+              solve_low(rl,dl);
+              T dnorm(0.0);
+              for (size_type i=0; i<n; i++)
+                {
+                  T d(detail::convert_number<T>(dl[i]));
+                  x[i] += d;
+                  if (abs(d)>dnorm) dnorm = abs(d);
+                }
+              iterations_taken = k+1;
+              if (dnorm<=reduction*xnorm)
+                {
+                  converged = true;
+                  break;
+                }
+              // written such that NaN from overflow also stagnates
+              if (!(dnorm<=T(0.5)*dold))
+                break;
+              dold = dnorm;
+            }
+        }
+      if (!converged)
+        {
+          solve_fallback(x,b);
+          fallback = true;
+        }
+      if (verbosity>=1)
+        {
+          if (fallback)
+            std::cout << "IterativeRefinement: stagnated after " << iterations_taken
+                      << " steps, solved in working precision" << std::endl;
+          else
+            std::cout << "IterativeRefinement: converged in " << iterations_taken
+                      << " steps" << std::endl;
+        }
+    }
+
+    //! true if the last solve reached the reduction by refinement
+    bool has_converged () const
+    {
+      return converged;
+    }
+
+    //! true if the last solve used the factorization in the working precision
+    bool used_fallback () const
+    {
+      return fallback;
+    }
+
+    //! number of refinement steps of the last solve
+    size_type iterations () const
+    {
+      return iterations_taken;
+    }
+
+  private:
+    // r = b - A x in precision H, rounded to L; returns its maximum norm
+    T residual (const Vector<T>& x, const Vector<T>& b, Vector<L>& r) const
+    {
+      size_type n = A.rowsize();
+      Vector<H> xh(n);
+      for (size_type j=0; j<n; j++) xh[j] = H(x[j]);
+      T rnorm(0.0);
+      for (size_type i=0; i<n; i++)
+        {
+          H sum(b[i]);
+          for (size_type j=0; j<n; j++)
+            sum -= H(A[i][j])*xh[j];
+          T ri(detail::convert_number<T>(sum));
+          if (abs(ri)>rnorm) rnorm = abs(ri);
+          r[i] = detail::convert_number<L>(sum);
+        }
+      return rnorm;
+    }
+
+    // solve with the low precision factors
+    void solve_low (Vector<L>& r, Vector<L>& d) const
+    {
+      apply_equilibrate(s,r);
+      permute_forward(p,r);
+      solveL(LR,r,r);
+      solveR(LR,d,r);
+    }
+
+    // full pivoting in T, computed when it is first needed
+    void solve_fallback (Vector<T>& x, const Vector<T>& b)
+    {
+      size_type n = A.rowsize();
+      if (!fallback_factorized)
+        {
+          AT = A;
+          sT = Vector<T>(n);
+          pT = Vector<size_type>(n);
+          qT = Vector<size_type>(n);
+          row_equilibrate(AT,sT);
+          lr_fullpivot(AT,pT,qT);
+          fallback_factorized = true;
+        }
+      Vector<T> c(b);
+      apply_equilibrate(sT,c);
+      permute_forward(pT,c);
+      solveL(AT,c,c);
+      solveR(AT,x,c);
+      permute_backward(qT,x);
+    }
+
+    size_type maxit;
+    size_type verbosity;
+    T reduction;
+    T anorm;
+    DenseMatrix<T> A, AT;
+    DenseMatrix<L> LR;
+    mutable Vector<L> s;
+    Vector<size_type> p;
+    Vector<T> sT;
+    Vector<size_type> pT, qT;
+    bool factorized, low_ok, fallback_factorized;
+    bool converged, fallback;
+    size_type iterations_taken;
+  };
+
+  /** @brief a complete mixed precision solver, A and b are not modified
+
+      Factorizes in float and refines to double, see IterativeRefinement.
+      Returns true if the refinement converged and false if the system
+      had to be solved in double. The number of refinement steps is
+      stored in iterations, it is 0 e.g. for a diagonal A, whose float
+      solution needs no correction.
+  */
+  template<class T>
+  bool linsolve_mixed (const DenseMatrix<T>& A, Vector<T>& x, const Vector<T>& b, std::size_t& iterations)
+  {
+    IterativeRefinement<float,T> solver;
+    solver.factorize(A);
+    solver.solve(x,b);
+    iterations = solver.iterations();
+    return !solver.used_fallback();
+  }
+
+  //! as above without the number of refinement steps
+  template<class T>
+  bool linsolve_mixed (const DenseMatrix<T>& A, Vector<T>& x, const Vector<T>& b)
+  {
+    std::size_t iterations;
+    return linsolve_mixed(A,x,b,iterations);
+  }
+
+} // namespace hdnum
+
+#endif
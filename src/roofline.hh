@@ -0,0 +1,287 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_ROOFLINE_HH
+#define HDNUM_ROOFLINE_HH
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include "exceptions.hh"
+#include "profiler.hh"
+
+/** @file
+ *  @brief roofline model: achieved performance relative to the machine limits
+ *
+ *  A kernel with arithmetic intensity I (floating point operations per
+ *  byte moved between memory and processor) can at most reach
+ *  min(P, I B), where P is the peak floating point rate and B the
+ *  memory bandwidth. Kernels with I < P/B are bandwidth bound, the
+ *  others compute bound. The operations of a kernel are counted with
+ *  OpCounter, its time is measured with the Profiler and the bytes are
+ *  given by a traffic model, e.g. one of the traffic_ functions below,
+ *  or measured, e.g. as 64 bytes per LLC miss counted by PerfCounters.
+ */
+
+namespace hdnum {
+
+  /** @brief Roofline report of kernels or profiler regions
+
+      \code
+      Roofline roofline;
+      roofline.measure_peak();
+      // flops per call from a run with OpCounter<double>, time from the profiler
+      roofline.add_region("lr_partialpivot",flops,traffic_lr<double>(n));
+      roofline.report(std::cout);
+      \endcode
+  */
+  class Roofline
+  {
+  public:
+    typedef std::size_t size_type;
+
+    //! one kernel, all numbers are totals over all calls
+    struct Kernel
+    {
+      std::string name;
+      size_type calls;
+      double flops;
+      double bytes;
+      double seconds;
+    };
+
+    //! peak values are unknown until measure_peak or set_peak is called
+    Roofline ()
+      : peak_flops(0.0), peak_bandwidth(0.0)
+    {}
+
+    //! set the peak floating point rate [flop/s] and memory bandwidth [byte/s]
+    void set_peak (double flops, double bandwidth)
+    {
+      peak_flops = flops;
+      peak_bandwidth = bandwidth;
+    }
+
+    /** @brief measure the peak values of the calling thread
+
+        The floating point rate is taken from a loop of independent
+        multiply-add chains held in registers, the bandwidth from the
+        STREAM triad a = b + s c on arrays of n doubles each, which
+        should be much larger than the last level cache. The triad
+        moves four arrays: the store to a first loads its cache lines
+        (write-allocate), as in the traffic models below. Both are the
+        best of a few runs and reflect what code compiled with the
+        current flags can reach, e.g. without -march=native no wide
+        vector instructions are used.
+    */
+    void measure_peak (size_type n=1<<22)
+    {
+      // compute: 8 independent chains of x = x*a + b, 2 flops each
+      const size_type iterations = 1<<24;
+      double best = 1e100;
+      for (int r=0; r<3; r++)
+        {
+          double x[8] = {1.0,1.1,1.2,1.3,1.4,1.5,1.6,1.7};
+          volatile double va = 0.999999, vb = 1e-7;
+          double a = va, b = vb;
+          std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+          for (size_type i=0; i<iterations; i++)
+            for (int k=0; k<8; k++) x[k] = x[k]*a + b;
+          std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+          volatile double sink = x[0]+x[1]+x[2]+x[3]+x[4]+x[5]+x[6]+x[7];
+          (void)sink;
+          best = std::min(best,elapsed.count());
+        }
+      peak_flops = 16.0*iterations/best;
+
+      // memory: STREAM triad
+      std::vector<double> a(n,0.0), b(n,1.0), c(n,2.0);
+      volatile double vs = 0.5;
+      double s = vs;
+      best = 1e100;
+      for (int r=0; r<5; r++)
+        {
+          std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+          for (size_type i=0; i<n; i++) a[i] = b[i] + s*c[i];
+          std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+          volatile double sink = a[n/2];
+          (void)sink;
+          best = std::min(best,elapsed.count());
+        }
+      peak_bandwidth = 4.0*sizeof(double)*n/best;
+    }
+
+    //! peak floating point rate in flop/s
+    double get_peak_flops () const
+    {
+      return peak_flops;
+    }
+
+    //! peak memory bandwidth in byte/s
+    double get_peak_bandwidth () const
+    {
+      return peak_bandwidth;
+    }
+
+    //! add a kernel with total operations, bytes and time of all calls
+    void add (const std::string& name, size_type calls, double flops, double bytes, double seconds)
+    {
+      Kernel k;
+      k.name = name;
+      k.calls = calls;
+      k.flops = flops;
+      k.bytes = bytes;
+      k.seconds = seconds;
+      kernels.push_back(k);
+    }
+
+    /** @brief add a profiler region
+
+        Calls and time are taken from the Profiler, so the program has
+        to be compiled with HDNUM_PROFILING=1. Operations and bytes are
+        given per call; count the operations e.g. with
+        OpCounter<double>::regionCounters(name).flopCount() in a
+        separate run.
+    */
+    void add_region (const std::string& name, double flops_per_call, double bytes_per_call)
+    {
+#if HDNUM_PROFILE_RDTSC
+      HDNUM_ERROR("Roofline: needs profiler times in seconds, not cycles");
+#endif
+      size_type calls = Profiler::calls(name);
+      if (calls==0)
+        HDNUM_ERROR("Roofline: profiler region " << name << " was never entered");
+      add(name,calls,calls*flops_per_call,calls*bytes_per_call,Profiler::total(name));
+    }
+
+    //! kernels added so far
+    const std::vector<Kernel>& get_kernels () const
+    {
+      return kernels;
+    }
+
+    /** @brief write achieved rates, intensity and distance to the roof
+
+        For each kernel: GFLOP/s, GB/s, arithmetic intensity in
+        flop/byte, percentage of the peak floating point rate, the
+        bound given by the ridge point P/B and the percentage of the
+        attainable rate min(P, I B).
+
+        A kernel faster than its roof is not described by the model,
+        e.g. because its data came from the cache while the peak
+        bandwidth is that of the main memory, or because it uses
+        vector instructions the peak loop does not. Such percentages
+        are flagged as "above" instead of printed.
+    */
+    template<typename Stream>
+    void report (Stream& os) const
+    {
+      if (peak_flops>0.0 && peak_bandwidth>0.0)
+        os << "peak " << std::fixed << std::setprecision(2) << peak_flops*1e-9 << " GFLOP/s, "
+           << peak_bandwidth*1e-9 << " GB/s, ridge point "
+           << peak_flops/peak_bandwidth << " flop/byte" << std::endl;
+      os << std::setw(32) << std::left << "kernel" << std::right << std::setw(10) << "calls"
+         << std::setw(12) << "time [s]" << std::setw(10) << "GFLOP/s" << std::setw(10) << "GB/s"
+         << std::setw(12) << "flop/byte" << std::setw(10) << "% peak" << std::setw(10) << "bound"
+         << std::setw(10) << "% roof" << std::endl;
+      for (size_type i=0; i<kernels.size(); i++)
+        {
+          const Kernel& k = kernels[i];
+          double gflops = (k.seconds>0.0) ? k.flops/k.seconds : 0.0;
+          double bandwidth = (k.seconds>0.0) ? k.bytes/k.seconds : 0.0;
+          double intensity = (k.bytes>0.0) ? k.flops/k.bytes : 0.0;
+          os << std::setw(32) << std::left << k.name << std::right << std::setw(10) << k.calls
+             << std::scientific << std::setprecision(3) << std::setw(12) << k.seconds
+             << std::fixed << std::setprecision(3) << std::setw(10) << gflops*1e-9
+             << std::setw(10) << bandwidth*1e-9 << std::setw(12) << intensity;
+          if (peak_flops>0.0 && peak_bandwidth>0.0)
+            {
+              double roof = std::min(peak_flops,intensity*peak_bandwidth);
+              percent(os,gflops/peak_flops);
+              os << std::setw(10) << ((intensity<peak_flops/peak_bandwidth) ? "memory" : "compute");
+              percent(os,(roof>0.0) ? gflops/roof : 0.0);
+            }
+          os << std::endl;
+        }
+    }
+
+  private:
+    // a fraction in percent, or a flag if it exceeds 100 percent
+    template<typename Stream>
+    static void percent (Stream& os, double fraction)
+    {
+      if (fraction>1.0)
+        os << std::setw(10) << "above";
+      else
+        os << std::fixed << std::setprecision(1) << std::setw(10) << 100.0*fraction;
+    }
+
+    double peak_flops, peak_bandwidth;
+    std::vector<Kernel> kernels;
+  };
+
+  /** @name Traffic models
+
+      Compulsory bytes moved between memory and processor by one call
+      of a kernel of hdnum: every operand is read once and every result
+      is written once. A store to memory that is not in the cache first
+      loads the cache line (write-allocate), so a result that is only
+      written counts twice, like a in the triad of measure_peak.
+
+      This is a lower bound of the traffic. It is reached by streaming
+      kernels and by kernels whose operands fit into the cache, e.g.
+      mm and lr for matrices of a few hundred rows. Larger matrices do
+      not fit, then the unblocked loops of mm and lr load their
+      operands repeatedly and the actual intensity is lower than the
+      one reported; measure the traffic with PerfCounters in that case.
+  */
+  //@{
+
+  //! x.update(alpha,y): read x and y, write x
+  template<class T>
+  double traffic_update (std::size_t n)
+  {
+    return 3.0*n*sizeof(T);
+  }
+
+  //! x*y: read x and y
+  template<class T>
+  double traffic_dot (std::size_t n)
+  {
+    return 2.0*n*sizeof(T);
+  }
+
+  //! norm(x): x is passed by value, i.e. read and copied to a new vector
+  template<class T>
+  double traffic_norm (std::size_t n)
+  {
+    return 3.0*n*sizeof(T);
+  }
+
+  //! A.mv(y,x) with an m x n matrix: read A and x, write y
+  template<class T>
+  double traffic_mv (std::size_t m, std::size_t n)
+  {
+    return (double(m)*n+n+2.0*m)*sizeof(T);
+  }
+
+  //! C.mm(A,B) with A m x k and B k x n: read A and B, write C
+  template<class T>
+  double traffic_mm (std::size_t m, std::size_t k, std::size_t n)
+  {
+    return (double(m)*k+double(k)*n+2.0*m*n)*sizeof(T);
+  }
+
+  //! lr or lr_partialpivot of an n x n matrix: read and write the matrix
+  template<class T>
+  double traffic_lr (std::size_t n)
+  {
+    return 2.0*n*n*sizeof(T);
+  }
+
+  //@}
+
+} // namespace hdnum
+
+#endif
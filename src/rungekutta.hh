@@ -2,8 +2,12 @@
 #ifndef HDNUM_RUNGEKUTTA_HH
 #define HDNUM_RUNGEKUTTA_HH
 
+#include <complex>
+#include <limits>
 #include "vector.hh"
 #include "newton.hh"
+#include "observer.hh"
+#include "statistics.hh"
 
 /** @file
  *  @general Runge-Kutta solver
@@ -155,6 +159,7 @@ namespace hdnum {
   */
   template<class M, class S = Newton>
   class RungeKutta
+    : public Observable<RungeKutta<M,S>,typename M::time_type,typename M::number_type>
   {
   public:
     /** \brief export size_type */
@@ -250,11 +255,12 @@ namespace hdnum {
   //! do one step
   void step ()
   {
+    StatisticsTimer timer(stats.time_total);
     if (check_explicit())
     {
       // compute k_1
       w = u;
-      model.f(t, w, K[0]);
+      evaluate_f(stats, model, t, w, K[0]);
       for (int i = 0; i < s; i++)
       {
         Vector<number_type> sum (K[0].size(), 0.0);
@@ -265,7 +271,7 @@ namespace hdnum {
           sum.update(A[i][j],K[j]);
         }
         Vector<number_type> wert = w.update(dt,sum);
-        model.f(t + c[i]*dt, wert, K[i]);
+        evaluate_f(stats, model, t + c[i]*dt, wert, K[i]);
         u.update(dt *b[i], K[i]);
       }
     }
@@ -294,6 +300,12 @@ namespace hdnum {
       Vector<number_type> zij (s*n,0.0);
       solver.solve(problem,zij);
 
+      // F evaluates f in each stage, F_x f_x in each block column
+      SolverStatistics inner(solver.get_statistics());
+      inner.fevals *= s;
+      inner.jacobians *= s*s;
+      stats.add_inner(inner);
+
 
       DenseMatrix<number_type> Ainv (s,s,number_type(0));
       if (not last_row_eq_b)
@@ -359,6 +371,8 @@ namespace hdnum {
       }
     }
       t = t+dt;
+      stats.steps++;
+      this->notify(t,u,dt);
    }
 
    //! set current state
@@ -392,6 +406,22 @@ namespace hdnum {
      verbosity = verbosity_;
    }
 
+   /** @brief work of all steps since construction or the last reset_statistics
+
+       For implicit methods the work of the nonlinear solver is
+       included, with evaluations counted per stage.
+   */
+   const SolverStatistics& get_statistics () const
+   {
+     return stats;
+   }
+
+   //! clear the statistics
+   void reset_statistics ()
+   {
+     stats.reset();
+   }
+
   private:
     const M& model;
     time_type t, dt;
@@ -405,6 +435,467 @@ namespace hdnum {
 	Vector<number_type> c;
     number_type sigma;
     int verbosity;
+    SolverStatistics stats;
+  };
+
+
+  /** @brief Radau IIA method (order 5 with 3 stages) with adaptive time step
+
+      Fully implicit method for stiff problems following Hairer and
+      Wanner, Solving Ordinary Differential Equations II, Sect. IV.8.
+      The stage equations are solved with a simplified Newton method.
+      The coefficient matrix is brought to block diagonal form, so
+      a step factorizes one real and one complex n x n matrix instead
+      of the 3n x 3n matrix used by the generic RungeKutta class.
+      The Jacobian is only recomputed when Newton converged slowly.
+
+      The model has to provide f_x. The number type has to be usable
+      in std::complex, i.e. float, double or long double.
+
+      \tparam M the model type
+  */
+  template<class M>
+  class RadauIIA
+    : public Observable<RadauIIA<M>,typename M::time_type,typename M::number_type>
+  {
+  public:
+    /** \brief export size_type */
+    typedef typename M::size_type size_type;
+
+    /** \brief export time_type */
+    typedef typename M::time_type time_type;
+
+    /** \brief export number_type */
+    typedef typename M::number_type number_type;
+
+    /** \brief complex type used for the complex conjugate eigenvalue pair */
+    typedef std::complex<number_type> complex_type;
+
+    //! constructor stores reference to the model
+    RadauIIA (const M& model_)
+      : verbosity(0), model(model_), n(model.size()),
+        u(n), f0(n), w(n), scal(n), r1(n), d1(n), s1(n), r2(n), d2(n), s2(n),
+        p1(n), q1(n), p2(n), q2(n), J(n,n), E1(n,n), E2(n,n),
+        Z(3,Vector<number_type>(n)), W(3,Vector<number_type>(n)), K(3,Vector<number_type>(n))
+    {
+      model.initialize(t,u);
+      dt = 0.1;
+      TOL = time_type(0.0001);
+      dt_min = 1E-12;
+      maxit = 7;
+      faccon = 1.0;
+      jacobian_ok = false;
+      decomposition_ok = false;
+      first = true;
+      reject = false;
+      init_coefficients();
+    }
+
+    //! set time step for subsequent steps
+    void set_dt (time_type dt_)
+    {
+      dt = dt_;
+      decomposition_ok = false;
+    }
+
+    //! set tolerance for adaptive computation (used as relative and absolute tolerance)
+    void set_TOL (time_type TOL_)
+    {
+      TOL = TOL_;
+    }
+
+    //! set verbosity level
+    void set_verbosity (size_type verbosity_)
+    {
+      verbosity = verbosity_;
+    }
+
+    //! do one step, i.e. repeat until a step is accepted
+    void step ()
+    {
+      StatisticsTimer timer(stats.time_total);
+      const number_type uround = std::numeric_limits<number_type>::epsilon();
+
+      // tolerances as recommended for the embedded error estimator
+      const number_type rtol = 0.1*pow(TOL,2.0/3.0);
+      const number_type atol = rtol;
+      const number_type fnewt = std::max(number_type(10.0)*uround/rtol,std::min(number_type(0.03),sqrt(rtol)));
+      for (size_type i=0; i<n; i++)
+        scal[i] = atol + rtol*abs(u[i]);
+
+      evaluate_f(stats,model,t,u,f0);
+      bool fresh = false; // Jacobian evaluated at the current state
+      while (1)
+        {
+          if (!jacobian_ok)
+            {
+              evaluate_f_x(stats,model,t,u,J);
+              jacobian_ok = fresh = true;
+              decomposition_ok = false;
+            }
+          if (!decomposition_ok)
+            {
+              decompose();
+              decomposition_ok = true;
+            }
+
+          // simplified Newton iteration for the transformed stage values
+          for (int i=0; i<3; i++) { Z[i] = number_type(0.0); W[i] = number_type(0.0); }
+          faccon = pow(std::max(faccon,uround),0.8);
+          number_type theta(abs(thet)), dynold(0.0), thqold(0.0);
+          bool converged = false, reduced = false;
+          size_type newt = 0;
+          for (newt=0; newt<maxit; newt++)
+            {
+              stats.iterations++;
+              for (int i=0; i<3; i++)
+                {
+                  w = u;
+                  w += Z[i];
+                  evaluate_f(stats,model,t+c[i]*dt,w,K[i]);
+                }
+
+              // right hand side of the transformed system
+              const number_type fac1 = gamma/dt, alphn = alpha/dt, betan = beta/dt;
+              for (size_type k=0; k<n; k++)
+                {
+                  number_type a0 = TI[0][0]*K[0][k] + TI[0][1]*K[1][k] + TI[0][2]*K[2][k];
+                  number_type a1 = TI[1][0]*K[0][k] + TI[1][1]*K[1][k] + TI[1][2]*K[2][k];
+                  number_type a2 = TI[2][0]*K[0][k] + TI[2][1]*K[1][k] + TI[2][2]*K[2][k];
+                  r1[k] = a0 - fac1*W[0][k];
+                  r2[k] = complex_type(a1 - alphn*W[1][k] - betan*W[2][k],
+                                       a2 + betan*W[1][k] - alphn*W[2][k]);
+                }
+              solve(E1,s1,p1,q1,r1,d1);
+              solve(E2,s2,p2,q2,r2,d2);
+
+              // scaled norm of the Newton correction
+              number_type dyno(0.0);
+              for (size_type k=0; k<n; k++)
+                {
+                  number_type x0 = d1[k]/scal[k];
+                  number_type x1 = d2[k].real()/scal[k];
+                  number_type x2 = d2[k].imag()/scal[k];
+                  dyno += x0*x0 + x1*x1 + x2*x2;
+                }
+              dyno = sqrt(dyno/(3*n));
+
+              // convergence rate
+              if (newt>0)
+                {
+                  number_type thq = dyno/dynold;
+                  theta = (newt==1) ? thq : sqrt(thq*thqold);
+                  thqold = thq;
+                  if (theta>=0.99)
+                    break;
+                  faccon = theta/(1.0-theta);
+                  number_type dyth = faccon*dyno*pow(theta,number_type(maxit-1-newt))/fnewt;
+                  if (dyth>=1.0)
+                    {
+                      // convergence too slow, reduce time step
+                      number_type qnewt = std::max(number_type(1e-4),std::min(number_type(20.0),dyth));
+                      dt *= 0.8*pow(qnewt,-1.0/(4.0+maxit-1-newt));
+                      reduced = true;
+                      break;
+                    }
+                }
+              dynold = std::max(dyno,uround);
+
+              // update transformed and original stage values
+              for (size_type k=0; k<n; k++)
+                {
+                  W[0][k] += d1[k];
+                  W[1][k] += d2[k].real();
+                  W[2][k] += d2[k].imag();
+                }
+              for (int i=0; i<3; i++)
+                for (size_type k=0; k<n; k++)
+                  Z[i][k] = T[i][0]*W[0][k] + T[i][1]*W[1][k] + T[i][2]*W[2][k];
+
+              if (faccon*dyno<=fnewt)
+                {
+                  converged = true;
+                  break;
+                }
+            }
+
+          if (!converged)
+            {
+              // retry with smaller step; an old Jacobian is recomputed first
+              stats.rejected++;
+              if (!reduced) dt *= 0.5;
+              if (verbosity>0)
+                std::cout << "RadauIIA: Newton failed, reducing time step to " << dt << std::endl;
+              jacobian_ok = fresh;
+              decomposition_ok = false;
+              reject = true;
+              if (dt<dt_min) HDNUM_ERROR("time step too small in RadauIIA");
+              continue;
+            }
+
+          // error estimate with the embedded method of order 3
+          number_type err = estimate_error();
+
+          // new step size
+          const number_type safe = 0.9;
+          const number_type fac = std::min(safe,safe*(2*maxit+1)/(newt+1+2*maxit));
+          number_type quot = std::max(number_type(0.125),std::min(number_type(5.0),pow(err,0.25)/fac));
+          time_type dtnew = dt/quot;
+
+          if (err<1.0)
+            {
+              // accept step, last stage is the new solution
+              u += Z[2];
+              t += dt;
+              stats.steps++;
+              this->notify(t,u,dt);
+              first = false;
+              reject = false;
+              jacobian_ok = (theta<=thet);
+              number_type ratio = dtnew/dt;
+              if (jacobian_ok && ratio>=1.0 && ratio<=1.2)
+                return; // keep time step and decomposition
+              dt = dtnew;
+              decomposition_ok = false;
+              return;
+            }
+          else
+            {
+              stats.rejected++;
+              if (verbosity>0)
+                std::cout << "RadauIIA: error " << err << " too large, reducing time step to " << dtnew << std::endl;
+              dt = first ? 0.1*dt : dtnew;
+              decomposition_ok = false;
+              reject = true;
+              if (dt<dt_min) HDNUM_ERROR("time step too small in RadauIIA");
+            }
+        }
+    }
+
+    //! set current state
+    void set_state (time_type t_, const Vector<number_type>& u_)
+    {
+      t = t_;
+      u = u_;
+      jacobian_ok = false;
+      decomposition_ok = false;
+    }
+
+    //! get current state
+    const Vector<number_type>& get_state () const
+    {
+      return u;
+    }
+
+    //! get current time
+    time_type get_time () const
+    {
+      return t;
+    }
+
+    //! get dt to be used in the next step
+    time_type get_dt () const
+    {
+      return dt;
+    }
+
+    //! return consistency order of the method
+    size_type get_order () const
+    {
+      return 5;
+    }
+
+    //! number of accepted steps
+    size_type get_steps () const
+    {
+      return stats.steps;
+    }
+
+    //! number of rejected steps
+    size_type get_rejected () const
+    {
+      return stats.rejected;
+    }
+
+    /** @brief work of all steps since construction or the last reset_statistics
+
+        Each decomposition consists of two factorizations, a real and a
+        complex one; each iteration solves with both.
+    */
+    const SolverStatistics& get_statistics () const
+    {
+      return stats;
+    }
+
+    //! clear the statistics
+    void reset_statistics ()
+    {
+      stats.reset();
+    }
+
+    //! print some information
+    void get_info () const
+    {
+      std::cout << "RadauIIA: steps=" << stats.steps+stats.rejected << " rejected=" << stats.rejected
+                << " f evaluations=" << stats.fevals << " jacobians=" << stats.jacobians
+                << " decompositions=" << stats.factorizations/2 << std::endl;
+    }
+
+  private:
+
+    //! Radau IIA tableau and transformation to block diagonal form
+    void init_coefficients ()
+    {
+      const number_type sq6 = sqrt(number_type(6.0));
+      c[0] = (4.0-sq6)/10.0;
+      c[1] = (4.0+sq6)/10.0;
+      c[2] = 1.0;
+
+      // eigenvalues of the inverse coefficient matrix: gamma and alpha +- i beta
+      const number_type cb81 = pow(number_type(81.0),1.0/3.0), cb9 = pow(number_type(9.0),1.0/3.0);
+      const number_type u1 = (6.0+cb81-cb9)/30.0;
+      const number_type alph = (12.0-cb81+cb9)/60.0;
+      const number_type bet = (cb81+cb9)*sqrt(number_type(3.0))/60.0;
+      const number_type cno = alph*alph+bet*bet;
+      gamma = 1.0/u1;
+      alpha = alph/cno;
+      beta = bet/cno;
+
+      // inverse of the coefficient matrix
+      number_type A[3][3] = {
+        {(88.0-7.0*sq6)/360.0, (296.0-169.0*sq6)/1800.0, (-2.0+3.0*sq6)/225.0},
+        {(296.0+169.0*sq6)/1800.0, (88.0+7.0*sq6)/360.0, (-2.0-3.0*sq6)/225.0},
+        {(16.0-sq6)/36.0, (16.0+sq6)/36.0, 1.0/9.0}};
+      number_type Ainv[3][3];
+      invert3(A,Ainv);
+
+      // the columns of T are the real eigenvector and the real and
+      // imaginary part of the complex eigenvector to alpha + i beta
+      complex_type B[3][3];
+      for (int i=0; i<3; i++)
+        for (int j=0; j<3; j++)
+          B[i][j] = Ainv[i][j] - ((i==j) ? complex_type(alpha,beta) : complex_type(0.0));
+      complex_type v[3] = {B[0][1]*B[1][2]-B[0][2]*B[1][1],
+                           B[0][2]*B[1][0]-B[0][0]*B[1][2],
+                           B[0][0]*B[1][1]-B[0][1]*B[1][0]};
+      for (int i=0; i<3; i++)
+        for (int j=0; j<3; j++)
+          B[i][j] = Ainv[i][j] - ((i==j) ? gamma : number_type(0.0));
+      for (int i=0; i<3; i++)
+        {
+          int i1 = (i+1)%3, i2 = (i+2)%3;
+          T[i][0] = B[0][i1].real()*B[1][i2].real()-B[0][i2].real()*B[1][i1].real();
+          T[i][1] = v[i].real();
+          T[i][2] = v[i].imag();
+        }
+      invert3(T,TI);
+
+      // coefficients of the embedded error estimator
+      dd[0] = -(13.0+7.0*sq6)/3.0;
+      dd[1] = (-13.0+7.0*sq6)/3.0;
+      dd[2] = -1.0/3.0;
+      thet = 0.001;
+    }
+
+    //! invert a 3x3 matrix by the cofactor formula
+    static void invert3 (const number_type A[3][3], number_type B[3][3])
+    {
+      number_type det = A[0][0]*(A[1][1]*A[2][2]-A[1][2]*A[2][1])
+        - A[0][1]*(A[1][0]*A[2][2]-A[1][2]*A[2][0])
+        + A[0][2]*(A[1][0]*A[2][1]-A[1][1]*A[2][0]);
+      for (int i=0; i<3; i++)
+        for (int j=0; j<3; j++)
+          {
+            int j1 = (j+1)%3, j2 = (j+2)%3, i1 = (i+1)%3, i2 = (i+2)%3;
+            B[i][j] = (A[j1][i1]*A[j2][i2]-A[j1][i2]*A[j2][i1])/det;
+          }
+    }
+
+    //! factorize gamma/dt I - J and (alpha-i beta)/dt I - J
+    void decompose ()
+    {
+      StatisticsTimer timer(stats.time_factorization);
+      const number_type fac1 = gamma/dt;
+      const complex_type fac2(alpha/dt,-beta/dt);
+      for (size_type i=0; i<n; i++)
+        for (size_type j=0; j<n; j++)
+          {
+            E1[i][j] = -J[i][j];
+            E2[i][j] = complex_type(-J[i][j]);
+          }
+      for (size_type i=0; i<n; i++)
+        {
+          E1[i][i] += fac1;
+          E2[i][i] += fac2;
+        }
+      row_equilibrate(E1,s1);
+      lr_fullpivot(E1,p1,q1);
+      row_equilibrate(E2,s2);
+      lr_fullpivot(E2,p2,q2);
+      stats.factorizations += 2;
+    }
+
+    //! solve with a decomposed matrix, the right hand side is overwritten
+    template<class X>
+    void solve (const DenseMatrix<X>& LR, Vector<X>& s, const Vector<size_type>& p,
+                const Vector<size_type>& q, Vector<X>& r, Vector<X>& x)
+    {
+      StatisticsTimer timer(stats.time_solve);
+      stats.linear_solves++;
+      apply_equilibrate(s,r);
+      permute_forward(p,r);
+      solveL(LR,r,r);
+      solveR(LR,x,r);
+      permute_backward(q,x);
+    }
+
+    //! scaled error of the embedded method, the tolerances are in scal
+    number_type estimate_error ()
+    {
+      for (size_type k=0; k<n; k++)
+        w[k] = (dd[0]*Z[0][k] + dd[1]*Z[1][k] + dd[2]*Z[2][k])/dt;
+      for (size_type k=0; k<n; k++)
+        r1[k] = w[k] + f0[k];
+      solve(E1,s1,p1,q1,r1,d1);
+      number_type err = scaled_norm(d1);
+      if (err>=1.0 && (first || reject))
+        {
+          // improved estimate (Hairer & Wanner, IV.8, (8.21))
+          K[0] = u;
+          K[0] += d1;
+          evaluate_f(stats,model,t,K[0],r1);
+          r1 += w;
+          solve(E1,s1,p1,q1,r1,d1);
+          err = scaled_norm(d1);
+        }
+      return std::max(err,number_type(1e-10));
+    }
+
+    number_type scaled_norm (const Vector<number_type>& x) const
+    {
+      number_type sum(0.0);
+      for (size_type k=0; k<n; k++)
+        sum += (x[k]/scal[k])*(x[k]/scal[k]);
+      return sqrt(sum/n);
+    }
+
+    size_type verbosity;
+    const M& model;
+    size_type n;
+    time_type t, dt;
+    time_type TOL, dt_min;
+    size_type maxit;
+    number_type faccon, thet;
+    bool jacobian_ok, decomposition_ok, first, reject;
+    number_type c[3], dd[3], T[3][3], TI[3][3];
+    number_type gamma, alpha, beta;
+    Vector<number_type> u, f0, w, scal, r1, d1, s1;
+    Vector<complex_type> r2, d2, s2;
+    Vector<size_type> p1, q1, p2, q2;
+    DenseMatrix<number_type> J, E1;
+    DenseMatrix<complex_type> E2;
+    std::vector< Vector<number_type> > Z, W, K;
+    SolverStatistics stats;
   };
 
 
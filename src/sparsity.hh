@@ -0,0 +1,337 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_SPARSITY_HH
+#define HDNUM_SPARSITY_HH
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "vector.hh"
+#include "densematrix.hh"
+#include "exceptions.hh"
+
+/** @file
+ *  @brief sparsity patterns and colored finite difference Jacobians
+ *
+ *  If the sparsity pattern of a Jacobian is known, all columns without
+ *  a common nonzero row can be approximated by one finite difference
+ *  (Curtis, Powell and Reid, 1974). A banded Jacobian then needs
+ *  bandwidth instead of n function evaluations.
+ */
+
+namespace hdnum {
+
+  /** @brief Positions of the nonzero entries of a matrix
+
+      Entries are added with add(i,j), duplicates are allowed.
+  */
+  class SparsityPattern
+  {
+  public:
+    /** \brief export size_type */
+    typedef std::size_t size_type;
+
+    //! empty pattern of a rows x cols matrix
+    SparsityPattern (size_type rows_, size_type cols_)
+      : entries(rows_), cols(cols_), sorted(true)
+    {}
+
+    //! mark entry (i,j) as nonzero
+    void add (size_type i, size_type j)
+    {
+      if (i>=entries.size() || j>=cols)
+        HDNUM_ERROR("SparsityPattern: entry (" << i << "," << j << ") out of range");
+      entries[i].push_back(j);
+      sorted = false;
+    }
+
+    //! number of rows
+    size_type rowsize () const
+    {
+      return entries.size();
+    }
+
+    //! number of columns
+    size_type colsize () const
+    {
+      return cols;
+    }
+
+    //! sorted column indices of the nonzeros in row i
+    const std::vector<size_type>& row (size_type i) const
+    {
+      compress();
+      return entries[i];
+    }
+
+    //! number of nonzero entries
+    size_type nonzeros () const
+    {
+      compress();
+      size_type nnz = 0;
+      for (size_type i=0; i<entries.size(); i++) nnz += entries[i].size();
+      return nnz;
+    }
+
+    //! true if (i,j) is a nonzero entry
+    bool contains (size_type i, size_type j) const
+    {
+      compress();
+      return std::binary_search(entries[i].begin(),entries[i].end(),j);
+    }
+
+  private:
+    // sort rows and remove duplicates
+    void compress () const
+    {
+      if (sorted) return;
+      for (size_type i=0; i<entries.size(); i++)
+        {
+          std::sort(entries[i].begin(),entries[i].end());
+          entries[i].erase(std::unique(entries[i].begin(),entries[i].end()),entries[i].end());
+        }
+      sorted = true;
+    }
+
+    mutable std::vector<std::vector<size_type> > entries;
+    size_type cols;
+    mutable bool sorted;
+  };
+
+
+  /** @brief Pattern of an n x n band matrix
+
+      \param[in] n     size of the matrix
+      \param[in] lower number of subdiagonals
+      \param[in] upper number of superdiagonals
+  */
+  inline SparsityPattern bandedPattern (std::size_t n, std::size_t lower, std::size_t upper)
+  {
+    SparsityPattern pattern(n,n);
+    for (std::size_t i=0; i<n; i++)
+      {
+        std::size_t first = (i>lower) ? i-lower : 0;
+        std::size_t last = std::min(n-1,i+upper);
+        for (std::size_t j=first; j<=last; j++) pattern.add(i,j);
+      }
+    return pattern;
+  }
+
+
+  /** @brief Greedy coloring of the columns of a sparsity pattern
+
+      Columns with a common nonzero row get different colors. The
+      columns are colored in their natural order, which is optimal
+      for band matrices.
+
+      \param[in]  pattern the sparsity pattern
+      \param[out] color   color of each column
+      \return number of colors used
+  */
+  inline std::size_t colorColumns (const SparsityPattern& pattern, std::vector<std::size_t>& color)
+  {
+    typedef std::size_t size_type;
+    const size_type none = size_type(-1);
+    size_type n = pattern.colsize();
+
+    // rows of the nonzeros in each column
+    std::vector<std::vector<size_type> > column(n);
+    for (size_type i=0; i<pattern.rowsize(); i++)
+      for (size_type k=0; k<pattern.row(i).size(); k++)
+        column[pattern.row(i)[k]].push_back(i);
+
+    color.assign(n,none);
+    std::vector<size_type> forbidden(n,none); // forbidden[c]==j: c not allowed for column j
+    size_type colors = 0;
+    for (size_type j=0; j<n; j++)
+      {
+        for (size_type k=0; k<column[j].size(); k++)
+          {
+            const std::vector<size_type>& r = pattern.row(column[j][k]);
+            for (size_type l=0; l<r.size(); l++)
+              if (color[r[l]]!=none) forbidden[color[r[l]]] = j;
+          }
+        size_type c = 0;
+        while (forbidden[c]==j) c++;
+        color[j] = c;
+        colors = std::max(colors,c+1);
+      }
+    return colors;
+  }
+
+
+  /** @brief Finite difference approximation of a sparse Jacobian
+
+      All columns of one color are perturbed at the same time, so one
+      evaluation of F per color is needed. Entries outside of the
+      pattern are set to zero. Without a pattern the Jacobian is dense
+      and every column is perturbed separately, no pattern is built.
+
+      \tparam N a type representing matrix entries
+  */
+  template<class N>
+  class ColoredJacobian
+  {
+  public:
+    /** \brief export size_type */
+    typedef std::size_t size_type;
+
+    //! dense rows_ x cols_ Jacobian, one color per column
+    ColoredJacobian (size_type rows_, size_type cols_, N eps_=N(1e-7))
+      : rows(rows_), cols(cols_), dense(true), eps(eps_)
+    {}
+
+    //! color the columns of the pattern
+    ColoredJacobian (const SparsityPattern& pattern, N eps_=N(1e-7))
+      : rows(pattern.rowsize()), cols(pattern.colsize()), dense(false),
+        columns(pattern.colsize()), eps(eps_)
+    {
+      std::vector<size_type> color;
+      size_type colors = colorColumns(pattern,color);
+      group.resize(colors);
+      for (size_type j=0; j<cols; j++) group[color[j]].push_back(j);
+      for (size_type i=0; i<pattern.rowsize(); i++)
+        for (size_type k=0; k<pattern.row(i).size(); k++)
+          columns[pattern.row(i)[k]].push_back(i);
+    }
+
+    //! number of colors, i.e. function evaluations per Jacobian
+    size_type colors () const
+    {
+      return dense ? cols : group.size();
+    }
+
+    /** @brief compute the Jacobian
+
+        \param[in]  F      function object called as F(z,Fz)
+        \param[in]  x      point of evaluation
+        \param[in]  Fx     value of F at x
+        \param[out] result approximation of the Jacobian at x
+    */
+    template<class Function, class V>
+    void evaluate (Function F, const V& x, const V& Fx, DenseMatrix<N>& result) const
+    {
+      if (result.rowsize()!=rows || result.colsize()!=cols)
+        HDNUM_ERROR("ColoredJacobian: matrix has wrong size");
+      using std::abs;
+      V z(x);
+      V Fz(Fx.size());
+      if (dense)
+        {
+          for (size_type j=0; j<cols; j++)
+            {
+              N dzj = (N(1.0)+abs(x[j]))*eps;
+              z[j] += dzj;
+              F(z,Fz);
+              for (size_type i=0; i<rows; i++) result[i][j] = (Fz[i]-Fx[i])/dzj;
+              z[j] = x[j];
+            }
+          return;
+        }
+      zero(result);
+      Vector<N> dz(cols);
+      for (size_type c=0; c<group.size(); c++)
+        {
+          for (size_type k=0; k<group[c].size(); k++)
+            {
+              size_type j = group[c][k];
+              dz[j] = (N(1.0)+abs(x[j]))*eps;
+              z[j] += dz[j];
+            }
+          F(z,Fz);
+          for (size_type k=0; k<group[c].size(); k++)
+            {
+              size_type j = group[c][k];
+              for (size_type l=0; l<columns[j].size(); l++)
+                {
+                  size_type i = columns[j][l];
+                  result[i][j] = (Fz[i]-Fx[i])/dz[j];
+                }
+              z[j] = x[j];
+            }
+        }
+    }
+
+  private:
+    size_type rows, cols;
+    bool dense;
+    std::vector<std::vector<size_type> > columns; // rows of the nonzeros in each column
+    std::vector<std::vector<size_type> > group;   // columns of each color
+    N eps;
+  };
+
+
+  /** @brief Adds a finite difference Jacobian f_x to an ODE model
+
+      For models that do not provide f_x, e.g. to use them with
+      implicit solvers. With a sparsity pattern the Jacobian is
+      computed with colored finite differences, without one all
+      columns are approximated separately.
+
+      \tparam M the model type
+  */
+  template<class M>
+  class FiniteDifferenceModel
+  {
+  public:
+    /** \brief export size_type */
+    typedef typename M::size_type size_type;
+
+    /** \brief export time_type */
+    typedef typename M::time_type time_type;
+
+    /** \brief export number_type */
+    typedef typename M::number_type number_type;
+
+    //! dense Jacobian, one evaluation of f per column
+    FiniteDifferenceModel (const M& model_, number_type eps=number_type(1e-7))
+      : model(model_), jacobian(model_.size(),model_.size(),eps)
+    {}
+
+    //! Jacobian with the given sparsity pattern
+    FiniteDifferenceModel (const M& model_, const SparsityPattern& pattern,
+                           number_type eps=number_type(1e-7))
+      : model(model_), jacobian(pattern,eps)
+    {}
+
+    //! return number of componentes for the model
+    std::size_t size () const
+    {
+      return model.size();
+    }
+
+    //! set initial state including time value
+    void initialize (time_type& t0, Vector<number_type>& x0) const
+    {
+      model.initialize(t0,x0);
+    }
+
+    //! model evaluation
+    void f (const time_type& t, const Vector<number_type>& x, Vector<number_type>& result) const
+    {
+      model.f(t,x,result);
+    }
+
+    //! jacobian evaluation needed for implicit solvers
+    void f_x (const time_type& t, const Vector<number_type>& x, DenseMatrix<number_type>& result) const
+    {
+      Vector<number_type> fx(x.size());
+      model.f(t,x,fx);
+      const M& m = model;
+      jacobian.evaluate([&m,&t] (const Vector<number_type>& z, Vector<number_type>& fz) { m.f(t,z,fz); },
+                        x,fx,result);
+    }
+
+    //! number of evaluations of f per Jacobian, without the one at x
+    size_type colors () const
+    {
+      return jacobian.colors();
+    }
+
+  private:
+    const M& model;
+    ColoredJacobian<number_type> jacobian;
+  };
+
+} // namespace hdnum
+
+#endif
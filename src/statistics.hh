@@ -0,0 +1,181 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_STATISTICS_HH
+#define HDNUM_STATISTICS_HH
+
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+/** @file
+ *  @brief statistics collected by the time integrators and nonlinear solvers
+ *
+ *  All solvers of ode.hh, rungekutta.hh and newton.hh count their work
+ *  in a SolverStatistics object returned by get_statistics(). The
+ *  counts accumulate over the lifetime of the solver until
+ *  reset_statistics() is called. The times per phase are only measured
+ *  if HDNUM_SOLVER_TIMING is defined to 1, otherwise they stay zero and
+ *  cost nothing.
+ */
+
+namespace hdnum {
+
+  //! work done by a solver
+  struct SolverStatistics
+  {
+    typedef std::size_t size_type;
+
+    size_type steps;                  //!< accepted time steps
+    size_type rejected;               //!< rejected time steps
+    size_type fevals;                 //!< evaluations of f or F
+    size_type jacobians;              //!< evaluations of f_x or F_x
+    size_type iterations;             //!< nonlinear iterations
+    size_type factorizations;         //!< LU decompositions
+    size_type linear_solves;          //!< solves with a decomposition or a Krylov method
+    double time_f;                    //!< seconds in f or F
+    double time_jacobian;             //!< seconds in f_x or F_x
+    double time_factorization;        //!< seconds in decompositions
+    double time_solve;                //!< seconds in linear solves
+    double time_total;                //!< seconds in step() or solve()
+
+    SolverStatistics ()
+    {
+      reset();
+    }
+
+    //! set all counts and times to zero
+    void reset ()
+    {
+      steps = rejected = fevals = jacobians = iterations = factorizations = linear_solves = 0;
+      time_f = time_jacobian = time_factorization = time_solve = time_total = 0.0;
+    }
+
+    SolverStatistics& operator+= (const SolverStatistics& other)
+    {
+      steps += other.steps;
+      rejected += other.rejected;
+      fevals += other.fevals;
+      jacobians += other.jacobians;
+      iterations += other.iterations;
+      factorizations += other.factorizations;
+      linear_solves += other.linear_solves;
+      time_f += other.time_f;
+      time_jacobian += other.time_jacobian;
+      time_factorization += other.time_factorization;
+      time_solve += other.time_solve;
+      time_total += other.time_total;
+      return *this;
+    }
+
+    SolverStatistics& operator-= (const SolverStatistics& other)
+    {
+      steps -= other.steps;
+      rejected -= other.rejected;
+      fevals -= other.fevals;
+      jacobians -= other.jacobians;
+      iterations -= other.iterations;
+      factorizations -= other.factorizations;
+      linear_solves -= other.linear_solves;
+      time_f -= other.time_f;
+      time_jacobian -= other.time_jacobian;
+      time_factorization -= other.time_factorization;
+      time_solve -= other.time_solve;
+      time_total -= other.time_total;
+      return *this;
+    }
+
+    //! the work done between two snapshots of the statistics of a solver
+    SolverStatistics operator- (const SolverStatistics& before) const
+    {
+      SolverStatistics diff(*this);
+      diff -= before;
+      return diff;
+    }
+
+    /** @brief add the work of a solver used inside another one
+
+        Steps and total time are those of the outer solver, the
+        evaluations, iterations, linear algebra and their times are
+        taken from the inner solver.
+    */
+    SolverStatistics& add_inner (const SolverStatistics& inner)
+    {
+      fevals += inner.fevals;
+      jacobians += inner.jacobians;
+      iterations += inner.iterations;
+      factorizations += inner.factorizations;
+      linear_solves += inner.linear_solves;
+      time_f += inner.time_f;
+      time_jacobian += inner.time_jacobian;
+      time_factorization += inner.time_factorization;
+      time_solve += inner.time_solve;
+      return *this;
+    }
+
+    //! one line with name=value pairs, easy to parse by monitoring scripts
+    template<typename Stream>
+    void report (Stream& os) const
+    {
+      os << "steps=" << steps << " rejected=" << rejected << " fevals=" << fevals
+         << " jacobians=" << jacobians << " iterations=" << iterations
+         << " factorizations=" << factorizations << " linear_solves=" << linear_solves
+         << std::scientific << std::setprecision(3)
+         << " time_f=" << time_f << " time_jacobian=" << time_jacobian
+         << " time_factorization=" << time_factorization << " time_solve=" << time_solve
+         << " time_total=" << time_total << std::endl;
+    }
+  };
+
+  /** @brief adds the lifetime of the object in seconds to a statistics entry
+
+      Empty unless HDNUM_SOLVER_TIMING is 1.
+  */
+  class StatisticsTimer
+  {
+  public:
+#if HDNUM_SOLVER_TIMING
+    explicit StatisticsTimer (double& time_)
+      : time(time_), start(std::chrono::steady_clock::now())
+    {}
+
+    ~StatisticsTimer ()
+    {
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+      time += elapsed.count();
+    }
+#else
+    explicit StatisticsTimer (double& )
+    {}
+#endif
+
+    StatisticsTimer (const StatisticsTimer&) = delete;
+    StatisticsTimer& operator= (const StatisticsTimer&) = delete;
+
+  private:
+#if HDNUM_SOLVER_TIMING
+    double& time;
+    std::chrono::steady_clock::time_point start;
+#endif
+  };
+
+  //! evaluate model.f(t,x,result) and count it in stats
+  template<class M, class T, class V>
+  void evaluate_f (SolverStatistics& stats, const M& model, const T& t, const V& x, V& result)
+  {
+    StatisticsTimer timer(stats.time_f);
+    stats.fevals++;
+    model.f(t,x,result);
+  }
+
+  //! evaluate model.f_x(t,x,result) and count it in stats
+  template<class M, class T, class V, class A>
+  void evaluate_f_x (SolverStatistics& stats, const M& model, const T& t, const V& x, A& result)
+  {
+    StatisticsTimer timer(stats.time_jacobian);
+    stats.jacobians++;
+    model.f_x(t,x,result);
+  }
+
+} // namespace hdnum
+
+#endif
@@ -0,0 +1,210 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_SYMPLECTIC_HH
+#define HDNUM_SYMPLECTIC_HH
+
+#include <vector>
+#include <string>
+#include "vector.hh"
+#include "exceptions.hh"
+#include "observer.hh"
+
+/** @file
+ *  @brief symplectic splitting methods for separable Hamiltonian systems
+ */
+
+namespace hdnum {
+
+  /** @brief Symplectic splitting methods for separable Hamiltonian systems
+
+      The model has to provide, in addition to the usual interface,
+      the two parts of the right hand side f = f_position + f_velocity:
+
+      f_position(t,x,result) sets the derivatives of the position
+      components (which only depend on the velocities) and zero in
+      all velocity components.
+
+      f_velocity(t,x,result) sets the derivatives of the velocity
+      components (which only depend on the positions) and zero in
+      all position components.
+
+      One step is a sequence of kicks (velocity updates) and drifts
+      (position updates)
+
+      kick b_0, drift a_0, kick b_1, ..., drift a_{s-1}, kick b_s.
+
+      Zero coefficients are skipped and the last acceleration of a
+      step is reused in the first kick of the next step, so the
+      number of f_velocity evaluations per step is the number of
+      nonzero interior kicks. Available methods are
+
+      - "Stoermer-Verlet" (or "Leapfrog"): order 2, 1 evaluation per step
+      - "Forest-Ruth": order 4, drift-kick-drift form, 3 evaluations
+      - "Yoshida4": order 4, triple jump of velocity Verlet, 3 evaluations
+      - "Yoshida6": order 6, Yoshida's solution A, 7 evaluations
+
+      \tparam M the model type
+  */
+  template<class M>
+  class Symplectic
+    : public Observable<Symplectic<M>,typename M::time_type,typename M::number_type>
+  {
+  public:
+    /** \brief export size_type */
+    typedef typename M::size_type size_type;
+
+    /** \brief export time_type */
+    typedef typename M::time_type time_type;
+
+    /** \brief export number_type */
+    typedef typename M::number_type number_type;
+
+    //! constructor stores reference to the model and selects the method
+    Symplectic (const M& model_, const std::string method = "Stoermer-Verlet")
+      : model(model_), u(model.size()), k(model.size()), accel(model.size()),
+        valid(false)
+    {
+      init_coefficients(method);
+      model.initialize(t,u);
+      dt = 0.1;
+    }
+
+    //! set time step for subsequent steps
+    void set_dt (time_type dt_)
+    {
+      dt = dt_;
+    }
+
+    //! do one step
+    void step ()
+    {
+      time_type tau(t);
+      for (size_type i=0; i<b.size(); i++)
+        {
+          // kick
+          if (b[i]!=time_type(0.0))
+            {
+              if (!valid)
+                {
+                  model.f_velocity(tau,u,accel);
+                  valid = true;
+                }
+              u.update(dt*b[i],accel);
+            }
+
+          // drift
+          if (i<a.size() && a[i]!=time_type(0.0))
+            {
+              model.f_position(tau,u,k);
+              u.update(dt*a[i],k);
+              tau += dt*a[i];
+              valid = false;
+            }
+        }
+      t += dt;
+      this->notify(t,u,dt);
+    }
+
+    //! set current state
+    void set_state (time_type t_, const Vector<number_type>& u_)
+    {
+      t = t_;
+      u = u_;
+      valid = false;
+    }
+
+    //! get current state
+    const Vector<number_type>& get_state () const
+    {
+      return u;
+    }
+
+    //! get current time
+    time_type get_time () const
+    {
+      return t;
+    }
+
+    //! get dt used in last step (i.e. to compute current state)
+    time_type get_dt () const
+    {
+      return dt;
+    }
+
+    //! return consistency order of the method
+    size_type get_order () const
+    {
+      return order;
+    }
+
+  private:
+
+    // kick/drift coefficients of a composition of velocity Verlet
+    // steps with the weights w
+    void compose (const std::vector<time_type>& w)
+    {
+      a = w;
+      b.assign(w.size()+1,time_type(0.0));
+      for (size_type i=0; i<w.size(); i++)
+        {
+          b[i] += time_type(0.5)*w[i];
+          b[i+1] += time_type(0.5)*w[i];
+        }
+    }
+
+    void init_coefficients (const std::string& method)
+    {
+      std::vector<time_type> w;
+      if (method.find("Verlet") != std::string::npos ||
+          method.find("Leapfrog") != std::string::npos)
+        {
+          w.push_back(time_type(1.0));
+          compose(w);
+          order = 2;
+        }
+      else if (method.find("Forest-Ruth") != std::string::npos)
+        {
+          time_type theta = time_type(1.0)/(time_type(2.0)-pow(time_type(2.0),time_type(1.0)/time_type(3.0)));
+          a.resize(4);
+          a[0] = a[3] = time_type(0.5)*theta;
+          a[1] = a[2] = time_type(0.5)*(time_type(1.0)-theta);
+          b.resize(5);
+          b[0] = b[4] = time_type(0.0);
+          b[1] = b[3] = theta;
+          b[2] = time_type(1.0)-time_type(2.0)*theta;
+          order = 4;
+        }
+      else if (method.find("Yoshida4") != std::string::npos)
+        {
+          time_type w1 = time_type(1.0)/(time_type(2.0)-pow(time_type(2.0),time_type(1.0)/time_type(3.0)));
+          w.push_back(w1);
+          w.push_back(time_type(1.0)-time_type(2.0)*w1);
+          w.push_back(w1);
+          compose(w);
+          order = 4;
+        }
+      else if (method.find("Yoshida6") != std::string::npos)
+        {
+          // H. Yoshida, Phys. Lett. A 150 (1990), solution A
+          time_type w1(-1.17767998417887), w2(0.235573213359357), w3(0.784513610477560);
+          time_type w0 = time_type(1.0)-time_type(2.0)*(w1+w2+w3);
+          w.push_back(w3); w.push_back(w2); w.push_back(w1);
+          w.push_back(w0);
+          w.push_back(w1); w.push_back(w2); w.push_back(w3);
+          compose(w);
+          order = 6;
+        }
+      else
+        HDNUM_ERROR("Unknown symplectic method.");
+    }
+
+    const M& model;
+    time_type t, dt;
+    std::vector<time_type> a, b;
+    size_type order;
+    Vector<number_type> u, k, accel;
+    bool valid;
+  };
+
+} // namespace hdnum
+
+#endif
@@ -0,0 +1,211 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_TRAJECTORY_HH
+#define HDNUM_TRAJECTORY_HH
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include "vector.hh"
+#include "exceptions.hh"
+#include "fileio.hh"
+#include "observer.hh"
+
+/** @file
+ *  @brief binary files for trajectories computed by ODE solvers
+ *
+ *  A trajectory file starts with a BinaryHeader with magic "HDNUMTRJ",
+ *  the type tags of the time and number type and the sizes dimension,
+ *  number of records and a flag whether time steps are stored. Then
+ *  follow the records t, u[0], ..., u[d-1] (and dt) without padding.
+ *  Only the builtin number types can be stored.
+ */
+
+namespace hdnum {
+
+  /** @brief Stream the trajectory to a binary file
+
+      The number of records is written to the header when the file is
+      closed. A file that was not closed can still be read, the number
+      of records is then computed from the file size.
+
+      \tparam T a type representing time values
+      \tparam N a type representing states
+  */
+  template<class T, class N>
+  class BinaryFileWriter : public StepObserver<T,N>
+  {
+    static_assert(int(BinaryType<T>::tag)!=0 && int(BinaryType<N>::tag)!=0,
+                  "BinaryFileWriter: time and number type must be builtin types");
+
+  public:
+    //! open file, with_dt stores the time step after each state
+    BinaryFileWriter (const std::string& fname, bool with_dt_=false, std::size_t chunk=1<<20)
+      : out(fname,chunk), with_dt(with_dt_), dim(0), count(0)
+    {
+      BinaryHeader header("HDNUMTRJ",BinaryType<T>::tag,BinaryType<N>::tag,0,0,with_dt);
+      header.write(out);
+    }
+
+    ~BinaryFileWriter ()
+    {
+      close_nothrow(*this);
+    }
+
+    void observe (T t, const Vector<N>& u, T dt)
+    {
+      if (count==0)
+        {
+          dim = u.size();
+          uint64_t d(dim);
+          out.write_at(24,&d,8);
+        }
+      else if (u.size()!=dim)
+        HDNUM_ERROR("BinaryFileWriter: dimension changed from " << dim << " to " << u.size());
+      out.write(&t,sizeof(T));
+      if (dim>0) out.write(&u[0],dim*sizeof(N));
+      if (with_dt) out.write(&dt,sizeof(T));
+      count++;
+    }
+
+    //! write number of records to the header and close the file
+    void close ()
+    {
+      if (count>0)
+        {
+          uint64_t c(count);
+          out.write_at(32,&c,8);
+          count = 0;
+        }
+      out.close();
+    }
+
+  private:
+    BinaryOutput out;
+    bool with_dt;
+    std::size_t dim, count;
+  };
+
+
+  /** @brief Read a binary trajectory file via a memory mapping
+
+      Files written on a machine with different byte order are
+      converted when the records are accessed.
+
+      \tparam T a type representing time values
+      \tparam N a type representing states
+  */
+  template<class T, class N>
+  class TrajectoryReader
+  {
+  public:
+    //! open file and check the header
+    TrajectoryReader (const std::string& fname)
+      : file(fname), header("HDNUMTRJ",BinaryType<T>::tag,BinaryType<N>::tag,0)
+    {
+      header.read(file.data(),file.size(),fname);
+      dim_ = header.n[0];
+      with_dt = (header.n[2]!=0);
+      record = sizeof(T)*(with_dt ? 2 : 1)+sizeof(N)*dim_;
+      std::size_t available = (file.size()-BinaryHeader::bytes)/record;
+      count = header.n[1];
+      if (count==0 || count>available) count = available;
+    }
+
+    //! number of records
+    std::size_t size () const
+    {
+      return count;
+    }
+
+    //! dimension of the states
+    std::size_t dim () const
+    {
+      return dim_;
+    }
+
+    //! true if the time steps are stored
+    bool has_dt () const
+    {
+      return with_dt;
+    }
+
+    //! time of record i
+    T time (std::size_t i) const
+    {
+      return get<T>(i,0);
+    }
+
+    //! state of record i
+    void state (std::size_t i, Vector<N>& u) const
+    {
+      u.resize(dim_);
+      if (dim_==0) return;
+      std::memcpy(&u[0],address(i,sizeof(T)),dim_*sizeof(N));
+      if (header.swap) byteswap(&u[0],sizeof(N),dim_);
+    }
+
+    //! time step of record i
+    T dt (std::size_t i) const
+    {
+      if (!with_dt) HDNUM_ERROR("TrajectoryReader: file contains no time steps");
+      return get<T>(i,sizeof(T)+dim_*sizeof(N));
+    }
+
+  private:
+    const char* address (std::size_t i, std::size_t offset) const
+    {
+      if (i>=count) HDNUM_ERROR("TrajectoryReader: record " << i << " out of range");
+      return file.data()+BinaryHeader::bytes+i*record+offset;
+    }
+
+    template<class V>
+    V get (std::size_t i, std::size_t offset) const
+    {
+      V v;
+      std::memcpy(&v,address(i,offset),sizeof(V));
+      if (header.swap) byteswap(&v,sizeof(V));
+      return v;
+    }
+
+    MappedFile file;
+    BinaryHeader header;
+    std::size_t dim_, count, record;
+    bool with_dt;
+  };
+
+
+  //! binary output for time and state sequence
+  template<class T, class N>
+  inline void writeTrajectory (const std::string& fname, const std::vector<T>& t, const std::vector<Vector<N> >& u)
+  {
+    BinaryFileWriter<T,N> writer(fname);
+    for (typename std::vector<T>::size_type n=0; n<t.size(); n++)
+      writer.observe(t[n],u[n],T(0.0));
+  }
+
+  //! binary output for time and state sequence
+  template<class T, class N>
+  inline void writeTrajectory (const std::string& fname, const std::vector<T>& t, const std::vector<Vector<N> >& u, const std::vector<T>& dt)
+  {
+    BinaryFileWriter<T,N> writer(fname,true);
+    for (typename std::vector<T>::size_type n=0; n<t.size(); n++)
+      writer.observe(t[n],u[n],dt[n]);
+  }
+
+  //! read time and state sequence from a binary file
+  template<class T, class N>
+  inline void readTrajectory (const std::string& fname, std::vector<T>& t, std::vector<Vector<N> >& u)
+  {
+    TrajectoryReader<T,N> reader(fname);
+    t.resize(reader.size());
+    u.resize(reader.size());
+    for (std::size_t n=0; n<reader.size(); n++)
+      {
+        t[n] = reader.time(n);
+        reader.state(n,u[n]);
+      }
+  }
+
+} // namespace hdnum
+
+#endif
@@ -665,58 +665,6 @@ namespace hdnum {
 
 
 
-  /*!
-    \relates Vector
-    \brief Read vector from a text file
-
-    \param[in] filename name of the text file
-    \param[in,out] vector reference to a Vector
-
-    \b Example:
-    \code
-    hdnum::Vector<number> x;
-    readVectorFromFile("x.dat", x );
-    std::cout << "x=" << x << std::endl;
-    \endcode
-
-    \b Output:
-    \verbatim
-    Contents of "x.dat":
-    1.0
-    2.0
-    3.0
-
-    would give:
-    x=
-    [ 0]  1.0000000e+00
-    [ 1]  2.0000000e+00
-    [ 2]  3.0000000e+00
-    \endverbatim
-  */
-  template<typename REAL>
-  inline void readVectorFromFile (const std::string& filename, Vector<REAL> &vector)
-  {
-    std::string buffer;
-    std::ifstream fin( filename.c_str() );
-    if( fin.is_open() ){
-      while( fin ){
-        std::string sub;
-        fin >> sub;
-        //std::cout << " sub = " << sub.c_str() << ": ";
-        if( sub.length()>0 ){
-          REAL a = atof(sub.c_str());
-          //std::cout << std::fixed << std::setw(10) << std::setprecision(5) << a;
-          vector.push_back(a);
-        }
-      }
-      fin.close();
-    }
-    else{
-      HDNUM_ERROR("Could not open file!");
-    }
-  }
-
-
   //! annulize vector
   template<class REAL>
   inline void zero (Vector<REAL>& x)
@@ -0,0 +1,247 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef HDNUM_WORKPRECISION_HH
+#define HDNUM_WORKPRECISION_HH
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include "vector.hh"
+#include "densematrix.hh"
+#include "exceptions.hh"
+#include "instrumentedmodel.hh"
+
+/** @file
+ *  @brief work-precision data for ODE integrators
+ *
+ *  An integrator is run on [t0,T] for a sequence of time steps or
+ *  tolerances. For each run the error at T, the wall clock time, the
+ *  number of steps, rejected steps and evaluations of f and f_x are
+ *  recorded. Plotting error against time or evaluations shows the
+ *  cheapest method for a given accuracy.
+ */
+
+namespace hdnum {
+
+  //! one run of an integrator
+  struct WorkPrecisionPoint
+  {
+    std::string method;               //!< name of the integrator
+    double parameter;                 //!< time step or tolerance
+    double error;                     //!< Euclidean norm of the error at T
+    double seconds;                   //!< wall clock time of the run
+    std::size_t steps;                //!< accepted steps
+    std::size_t rejected;             //!< rejected steps
+    std::size_t fevals;               //!< evaluations of f
+    std::size_t jacobians;            //!< evaluations of f_x
+  };
+
+  /** @brief Work-precision diagram of integrators for one model
+
+      The integrators have to be constructed with model(), which counts
+      the evaluations of the model, and need set_state, set_dt,
+      get_dt, get_time, get_state, step and get_statistics; adaptive
+      ones set_TOL. Build without HDNUM_SOLVER_TIMING, otherwise the
+      recorded times include the clocks in the solvers and the model.
+
+      \code
+      WorkPrecision<Model> wp(model,T);      // error against model.exact_solution(T,u)
+      typedef WorkPrecision<Model>::model_type CM;
+      RungeKutta4<CM> rk4(wp.model());
+      wp.sweep_dt("RungeKutta4",rk4,{0.1,0.05,0.025});
+      RKF45<CM> rkf(wp.model());
+      wp.sweep_tol("RKF45",rkf,{1e-4,1e-6,1e-8});
+      wp.write("wp.dat");
+      \endcode
+  */
+  template<class M>
+  class WorkPrecision
+  {
+  public:
+    typedef typename M::size_type size_type;
+    typedef typename M::time_type time_type;
+    typedef typename M::number_type number_type;
+
+    //! the model passed to the integrators
+    typedef InstrumentedModel<M> model_type;
+
+    //! errors are computed with the exact solution of the model at time T
+    WorkPrecision (const M& model_, time_type T_)
+      : counting(model_), T(T_), reference(model_.size()), current(model_.size()), repetitions(1)
+    {
+      model_.exact_solution(T,reference);
+    }
+
+    //! errors are computed with a given reference solution at time T
+    WorkPrecision (const M& model_, time_type T_, const Vector<number_type>& reference_)
+      : counting(model_), T(T_), reference(reference_), current(model_.size()), repetitions(1)
+    {
+      if (reference.size()!=model_.size())
+        HDNUM_ERROR("WorkPrecision: reference solution has wrong size");
+    }
+
+    //! the instrumented model the integrators have to be constructed with
+    const model_type& model () const
+    {
+      return counting;
+    }
+
+    //! run each case r times and record the fastest run
+    void set_repetitions (size_type r)
+    {
+      repetitions = std::max(r,size_type(1));
+    }
+
+    /** @brief integrate from the initial state to T and record the run
+
+        The step size of the solver is used as is, the last step is
+        shortened to end exactly at T.
+    */
+    template<class S>
+    void run (const std::string& name, S& solver, double parameter)
+    {
+      WorkPrecisionPoint p;
+      p.method = name;
+      p.parameter = parameter;
+      p.seconds = std::numeric_limits<double>::max();
+      time_type dt = solver.get_dt();
+      for (size_type r=0; r<repetitions; r++)
+        {
+          time_type t0;
+          counting.initialize(t0,current);
+          solver.set_state(t0,current);
+          solver.set_dt(dt);
+          counting.reset_statistics();
+          size_type rejected0 = solver.get_statistics().rejected;
+          std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+          p.steps = integrate(solver);
+          std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+          p.seconds = std::min(p.seconds,elapsed.count());
+          p.rejected = solver.get_statistics().rejected-rejected0;
+          p.fevals = counting.get_statistics().fevals;
+          p.jacobians = counting.get_statistics().jacobians;
+        }
+      current = solver.get_state();
+      current -= reference;
+      p.error = current.two_norm();
+      points.push_back(p);
+    }
+
+    //! runs with each of the given time steps
+    template<class S>
+    void sweep_dt (const std::string& name, S& solver, const std::vector<double>& dts)
+    {
+      for (size_type i=0; i<dts.size(); i++)
+        {
+          solver.set_dt(dts[i]);
+          run(name,solver,dts[i]);
+        }
+    }
+
+    //! runs with each of the given tolerances, starting with time step dt0
+    template<class S>
+    void sweep_tol (const std::string& name, S& solver, const std::vector<double>& tols, double dt0=1e-3)
+    {
+      for (size_type i=0; i<tols.size(); i++)
+        {
+          solver.set_TOL(tols[i]);
+          solver.set_dt(dt0);
+          run(name,solver,tols[i]);
+        }
+    }
+
+    //! all recorded runs
+    const std::vector<WorkPrecisionPoint>& get_points () const
+    {
+      return points;
+    }
+
+    /** @brief write the data for gnuplot
+
+        One block per method, separated by two blank lines, so method
+        i is plotted with e.g.
+        plot "wp.dat" index i using 3:4 with linespoints
+    */
+    template<typename Stream>
+    void writeGnuplot (Stream& os) const
+    {
+      os << "# method parameter error time f_evaluations f_x_evaluations steps rejected" << std::endl;
+      for (size_type i=0; i<points.size(); i++)
+        {
+          const WorkPrecisionPoint& p = points[i];
+          if (i==0 || p.method!=points[i-1].method)
+            os << (i>0 ? "\n\n" : "") << "# " << p.method << std::endl;
+          os << "\"" << p.method << "\"" << std::scientific << std::setprecision(6)
+             << " " << p.parameter << " " << p.error << " " << p.seconds
+             << " " << p.fevals << " " << p.jacobians << " " << p.steps << " " << p.rejected << std::endl;
+        }
+    }
+
+    //! one line per run
+    template<typename Stream>
+    void writeCSV (Stream& os) const
+    {
+      os << "method,parameter,error,time,f_evaluations,f_x_evaluations,steps,rejected" << std::endl;
+      for (size_type i=0; i<points.size(); i++)
+        {
+          const WorkPrecisionPoint& p = points[i];
+          os << "\"" << p.method << "\"" << std::scientific << std::setprecision(6)
+             << "," << p.parameter << "," << p.error << "," << p.seconds
+             << "," << p.fevals << "," << p.jacobians << "," << p.steps << "," << p.rejected << std::endl;
+        }
+    }
+
+    //! write to a file, as CSV if the name ends with .csv
+    void write (const std::string& filename) const
+    {
+      std::ofstream os(filename.c_str());
+      if (!os) HDNUM_ERROR("WorkPrecision: could not open " << filename);
+      if (filename.size()>4 && filename.substr(filename.size()-4)==".csv")
+        writeCSV(os);
+      else
+        writeGnuplot(os);
+    }
+
+  private:
+    // advance to T and return the number of steps; steps beyond T are
+    // repeated with a shorter time step, e.g. extrapolation takes two
+    // steps of size dt at once
+    template<class S>
+    size_type integrate (S& solver)
+    {
+      const time_type eps = 1e-12*std::max(time_type(1.0),T);
+      size_type steps = 0;
+      while (solver.get_time()<T-eps)
+        {
+          time_type t0 = solver.get_time();
+          current = solver.get_state();
+          if (t0+solver.get_dt()>T) solver.set_dt(T-t0);
+          time_type dt = solver.get_dt();
+          solver.step();
+          steps++;
+          if (solver.get_time()>T+eps)
+            {
+              time_type factor = (solver.get_time()-t0)/dt;
+              solver.set_state(t0,current);
+              solver.set_dt((T-t0)/factor);
+              solver.step();
+              steps++;
+            }
+        }
+      return steps;
+    }
+
+    model_type counting;
+    time_type T;
+    Vector<number_type> reference, current;
+    size_type repetitions;
+    std::vector<WorkPrecisionPoint> points;
+  };
+
+} // namespace hdnum
+
+#endif